@@ -1,16 +1,33 @@
 #version 420 core
 
 in vec2 pass_textureCoords;
-flat in int texID;
+flat in int texArray;
+flat in float texLayer;
 in float time;
 
-uniform sampler2D textures[32];
+uniform sampler2DArray textures[8]; //TEXTURE_REGISTRY_ARRAY_MAX
 
 out vec4 FragColor;
 
+//Indexing a sampler array needs a dynamically uniform index, and texArray is per instance, so it varies inside one multi draw.
+//Every case indexes with a constant instead. Arrays have a single level, so the explicit lod needs no derivatives in the divergent branches
+vec4 sampleRegistry(vec3 coords){
+
+   switch(texArray){
+      case 0: return textureLod(textures[0], coords, 0.0);
+      case 1: return textureLod(textures[1], coords, 0.0);
+      case 2: return textureLod(textures[2], coords, 0.0);
+      case 3: return textureLod(textures[3], coords, 0.0);
+      case 4: return textureLod(textures[4], coords, 0.0);
+      case 5: return textureLod(textures[5], coords, 0.0);
+      case 6: return textureLod(textures[6], coords, 0.0);
+      default: return textureLod(textures[7], coords, 0.0);
+   }
+}
+
 void main(){
 
-   vec4 texColor = texture(textures[texID],pass_textureCoords);
+   vec4 texColor = sampleRegistry(vec3(pass_textureCoords, texLayer));
    vec4 colorColor = vec4(abs(sin(time)), abs(cos(time)), cos(time), 1.0f);
 
    FragColor = vec4(mix(texColor.xyz,colorColor.xyz, 0.5f),1.0f);
@@ -3,8 +3,11 @@
 layout(location = 0) in vec3 positions;
 layout(location = 1) in vec2 textureCoords;
 
-layout(location = 2) in mat4 transformationMatrix;
-layout(location = 6) in float textureID;
+//Compact per instance transform, the matrix is rebuilt here
+layout(location = 2) in vec3 instancePosition;
+layout(location = 3) in vec2 instanceRotation; //Pitch and yaw as fractions of pi
+layout(location = 4) in vec3 instanceScale;
+layout(location = 5) in uint textureID; //Texture registry handle, array index in the high byte and layer in the low byte
 
 layout(std140) uniform Matrices {
 
@@ -23,18 +26,30 @@ layout(std140) uniform Util {
 
 
 out vec2 pass_textureCoords;
-flat out int texID;
+flat out int texArray;
+flat out float texLayer;
 out float time;
 
 out vec3 outvect;
 
 void main(){
 
-    int intTex = int(textureID);
-    gl_Position =  matrices.projectionMatrix * matrices.viewMatrix * transformationMatrix * vec4(positions.x, positions.y, positions.z, 1.0);
+    //Same order as createTransformationMatrix, translate * rotate x * rotate y * scale
+    vec2 angles = instanceRotation * 3.14159265;
+    float cosPitch = cos(angles.x);
+    float sinPitch = sin(angles.x);
+    float cosYaw = cos(angles.y);
+    float sinYaw = sin(angles.y);
+
+    mat3 pitchMatrix = mat3(1.0, 0.0, 0.0, 0.0, cosPitch, sinPitch, 0.0, -sinPitch, cosPitch);
+    mat3 yawMatrix = mat3(cosYaw, 0.0, -sinYaw, 0.0, 1.0, 0.0, sinYaw, 0.0, cosYaw);
+
+    vec3 worldPosition = pitchMatrix * yawMatrix * (positions * instanceScale) + instancePosition;
+    gl_Position =  matrices.projectionMatrix * matrices.viewMatrix * vec4(worldPosition, 1.0);
 
     pass_textureCoords = textureCoords; //Setting the pass
-    texID = intTex;
+    texArray = int(textureID >> 8u);
+    texLayer = float(textureID & 0xFFu);
     time = util.elapsedTime;
 
 
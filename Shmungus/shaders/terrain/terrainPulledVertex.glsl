@@ -0,0 +1,58 @@
+#version 430 core
+
+//No vertex attributes, every vertex fetches its triangle's record from the chunk's buffers by gl_VertexID / 3.
+//They are the same buffers the instanced path reads as attributes, 2 bytes per triangle in each, so one uint holds two triangles
+layout(std430, binding = 0) readonly buffer TerrainPositions { uint positions[]; };
+layout(std430, binding = 1) readonly buffer TerrainIDs { uint IDs[]; };
+layout(std430, binding = 2) readonly buffer TerrainExtents { uint extents[]; };
+
+uniform vec3[192] cornerOffsets; //3 corners per orientation, the base triangle already transformed on the CPU
+layout(location = 0) uniform vec3 chunkOrigin; //World position of the chunk's block 0, 0, 0, see TERRAIN_CHUNK_ORIGIN_LOCATION
+
+out vec3 vertexColor; //Temporary for debugging
+
+layout(std140) uniform Matrices {
+
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+    mat4 ortho;
+
+} matrices;
+
+const vec3 staticPositions[3] = vec3[3](vec3(0, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0));
+
+//Triangle's 2 bytes out of a word shared with its neighbor
+uint readTriangleHalf(uint word, uint triangle){
+    return (word >> ((triangle & 1u) * 16u)) & 0xFFFFu;
+}
+
+vec3 decodeScale(uint orientID, uint extent){
+
+    if(orientID >= 24){ return vec3(1); } //Diagonals and slopes are never merged
+
+    uint face = (orientID % 12) / 2; //Front, right, back, left, top, bottom
+    vec2 size = vec2(extent & 0xFFu, extent >> 8) + 1;
+
+    if(face == 0 || face == 2){ return vec3(size.x, size.y, 1); } //Front and back span x and y
+    if(face == 1 || face == 3){ return vec3(1, size.y, size.x); } //Right and left span z and y
+    return vec3(size.x, 1, size.y); //Top and bottom span x and z
+}
+
+void main(){
+
+    uint triangle = uint(gl_VertexID) / 3u;
+    uint corner = uint(gl_VertexID) % 3u;
+
+    uint position = readTriangleHalf(positions[triangle >> 1], triangle); //4 bits x and 4 bits z, then 8 bits y
+    uint ID = readTriangleHalf(IDs[triangle >> 1], triangle);
+    uint extent = readTriangleHalf(extents[triangle >> 1], triangle);
+
+    uint orientID = ID & 0x3Fu; //Get least significant 6 bits
+
+    vertexColor = staticPositions[corner];
+
+    vec3 decodedPosition = vec3((position >> 4) & 0x0Fu, position >> 8, position & 0x0Fu);
+    vec3 cornerPosition = cornerOffsets[orientID * 3u + corner] * decodeScale(orientID, extent);
+
+    gl_Position = matrices.projectionMatrix * matrices.viewMatrix * vec4(cornerPosition + decodedPosition + chunkOrigin, 1.0);
+}
@@ -1,11 +1,13 @@
-#version 420 core
+#version 430 core
 
 layout(location = 0) in vec3 staticPositions;
 layout(location = 1) in uvec2 positions;   
 layout(location = 2) in uint ID;
+layout(location = 3) in uvec2 extents; //Merged quad size minus one along the face's two axes
 
 
 uniform mat4[64] transformArray;
+layout(location = 0) uniform vec3 chunkOrigin; //World position of the chunk's block 0, 0, 0, see TERRAIN_CHUNK_ORIGIN_LOCATION
 
 out vec3 vertexColor; //Temporary for debugging
 
@@ -35,6 +37,18 @@ ivec3 decodePositions(){
     return ivec3(x,y,z);
 }
 
+vec3 decodeScale(uint orientID){
+
+    if(orientID >= 24){ return vec3(1); } //Diagonals and slopes are never merged
+
+    uint face = (orientID % 12) / 2; //Front, right, back, left, top, bottom
+    vec2 size = vec2(extents) + 1;
+
+    if(face == 0 || face == 2){ return vec3(size.x, size.y, 1); } //Front and back span x and y
+    if(face == 1 || face == 3){ return vec3(1, size.y, size.x); } //Right and left span z and y
+    return vec3(size.x, 1, size.y); //Top and bottom span x and z
+}
+
 
 
 void main(){
@@ -57,7 +71,9 @@ void main(){
     
 	mat4 triangleTransformation = transformArray[orientID]; //Get transformation matrix
 
-    vec4 translatedPositions = (triangleTransformation * vec4(pass_staticPositions, 1.0) + vec4(decodedPosition,1)); //transform then translate triangle
+    //The transformed triangle lies in its block's unit cell, scaling it stretches the cell over the merged quad
+    vec3 transformedPositions = (triangleTransformation * vec4(pass_staticPositions, 1.0)).xyz * decodeScale(orientID);
+    vec4 translatedPositions = vec4(transformedPositions + decodedPosition + chunkOrigin, 1.0); //transform, scale, then translate triangle
 
 
 
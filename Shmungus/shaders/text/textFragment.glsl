@@ -6,7 +6,7 @@ in VertexData{
     vec2 pass_texCoords;
     flat uint pass_textureID;
     flat uint pass_Color;
-    bool pass_skip;
+    flat uint pass_skip; //Shader inputs and outputs cannot be bools, strict drivers such as Mesa reject them
 }vertexData;
 
 uniform sampler2DArray font;
@@ -23,7 +23,7 @@ vec3 decodeColor(uint encodedColor) {
 
 void main() {
 
-    if(vertexData.pass_skip){
+    if(vertexData.pass_skip != 0u){
     	discard;
 	}
     vec3 decodedColor = decodeColor(vertexData.pass_Color);
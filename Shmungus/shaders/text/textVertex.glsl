@@ -12,7 +12,7 @@ out VertexData{
     vec2 pass_texCoords;
     flat uint pass_textureID;
     flat uint pass_Color;
-    bool pass_skip;
+    flat uint pass_skip; //Shader inputs and outputs cannot be bools, strict drivers such as Mesa reject them
 }vertexData;
 
 layout(std140) uniform Matrices {
@@ -28,12 +28,12 @@ void main(){
 
     if((color & uint(0x80)) == uint(0x80)){ //Checks the skip bit
 		gl_Position = vec4(0.0f,0.0f,0.0f,0.0f);
-        vertexData.pass_skip=true;
+        vertexData.pass_skip = 1u;
 	}
 
     else{
         
-        vertexData.pass_skip = false;
+        vertexData.pass_skip = 0u;
 
         vertexData.pass_texCoords=texCoords;
         vertexData.pass_texCoords.y = 1.0f - vertexData.pass_texCoords.y;
@@ -2,6 +2,7 @@
 
 #include "DisplayManager.h"
 #include "Engine.h"
+#include "GLStateTracker.h"
 
 void initDisplay() {
 
@@ -31,7 +32,7 @@ void setGLFWViewport(GLFWwindow* window, int width, int height) { //Default view
 	glViewport(0, 0, width, height);
 
 	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-	glEnable(GL_DEPTH_TEST);
+	se_glState.setCapability(Shmingo::DEPTH_TEST_CAPABILITY, true);
 	glClear(GL_COLOR_BUFFER_BIT);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
@@ -43,9 +44,9 @@ void setGLFWViewport(GLFWwindow* window, int width, int height, float clearRed,
 
 	glClearColor(clearRed, clearGreen, clearBlue, clearAlpha);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_DEPTH_TEST);
+	se_glState.setCapability(Shmingo::BLEND_CAPABILITY, true);
+	se_glState.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	se_glState.setCapability(Shmingo::DEPTH_TEST_CAPABILITY, true);
 	glClear(GL_COLOR_BUFFER_BIT);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
@@ -0,0 +1,190 @@
+#include <sepch.h>
+#include "HeadlessContext.h"
+
+#if defined(se_HEADLESS_EGL)
+#define EGL_NO_X11 //Surfaceless needs no windowing system headers
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(se_HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+Shmingo::HeadlessContext::~HeadlessContext() {
+	destroy();
+}
+
+bool Shmingo::HeadlessContext::create(int width, int height) {
+
+	this->width = width;
+	this->height = height;
+
+	if (!createContext()) {
+		se_error("Failed to create headless GL context");
+		return false;
+	}
+
+	createFramebuffer();
+	return true;
+}
+
+#if defined(se_HEADLESS_EGL)
+
+bool Shmingo::HeadlessContext::createContext() {
+
+	//Mesa's surfaceless platform needs neither X nor a GPU device node, fall back to the default display for drivers without it
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	if (getPlatformDisplay != nullptr) {
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (eglDisplay == EGL_NO_DISPLAY) {
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major = 0, minor = 0;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+		return false;
+	}
+	display = eglDisplay;
+
+	//The surfaceless platform usually offers no configs at all, the context is then created without one (EGL_KHR_no_config_context)
+	const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	EGLint configAmount = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configAmount) || configAmount == 0) {
+		config = EGL_NO_CONFIG_KHR;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	//Same version the window asks for, software drivers like llvmpipe stop at 4.5 which still covers everything the renderer uses
+	EGLContext eglContext = EGL_NO_CONTEXT;
+	for (EGLint minorVersion = 6; minorVersion >= 5 && eglContext == EGL_NO_CONTEXT; minorVersion--) {
+
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, minorVersion,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+
+		eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+	}
+	if (eglContext == EGL_NO_CONTEXT) {
+		return false;
+	}
+	context = eglContext;
+
+	//Needs EGL_KHR_surfaceless_context, everything is drawn into the framebuffer object
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+		return false;
+	}
+
+	return gladLoadGLLoader((GLADloadproc)eglGetProcAddress) != 0;
+}
+
+void Shmingo::HeadlessContext::destroy() {
+
+	if (context == nullptr) {
+		return;
+	}
+
+	eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+	eglTerminate((EGLDisplay)display);
+
+	context = nullptr;
+	display = nullptr;
+}
+
+#elif defined(se_HEADLESS_OSMESA)
+
+bool Shmingo::HeadlessContext::createContext() {
+
+	//Software rendering, OSMesa tops out at 4.5 core which covers everything the renderer uses
+	const int contextAttributes[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, 4,
+		OSMESA_CONTEXT_MINOR_VERSION, 5,
+		0
+	};
+
+	OSMesaContext osmesaContext = OSMesaCreateContextAttribs(contextAttributes, nullptr);
+	if (osmesaContext == nullptr) {
+		return false;
+	}
+	context = osmesaContext;
+
+	osmesaBuffer.resize((size_t)width * height * 4);
+	if (!OSMesaMakeCurrent(osmesaContext, osmesaBuffer.data(), GL_UNSIGNED_BYTE, width, height)) {
+		return false;
+	}
+
+	return gladLoadGLLoader((GLADloadproc)OSMesaGetProcAddress) != 0;
+}
+
+void Shmingo::HeadlessContext::destroy() {
+
+	if (context == nullptr) {
+		return;
+	}
+
+	OSMesaDestroyContext((OSMesaContext)context);
+	context = nullptr;
+}
+
+#else
+
+bool Shmingo::HeadlessContext::createContext() {
+	se_error("Headless mode needs a build with se_HEADLESS_EGL or se_HEADLESS_OSMESA defined");
+	return false;
+}
+
+void Shmingo::HeadlessContext::destroy() {}
+
+#endif
+
+void Shmingo::HeadlessContext::createFramebuffer() {
+
+	glGenFramebuffers(1, &framebufferID);
+	glGenRenderbuffers(1, &colorRenderbufferID);
+	glGenRenderbuffers(1, &depthRenderbufferID);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	//Nothing else in the engine binds framebuffers, so this one stays the draw and read target for the whole run
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferID);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		se_error("Headless framebuffer is incomplete");
+	}
+}
+
+void Shmingo::HeadlessContext::readPixels(std::vector<uint8_t>& pixels) {
+
+	size_t rowSize = (size_t)width * 4;
+	pixels.resize(rowSize * height);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	//GL returns the bottom row first
+	std::vector<uint8_t> row(rowSize);
+	for (int y = 0; y < height / 2; y++) {
+		uint8_t* top = &pixels[(size_t)y * rowSize];
+		uint8_t* bottom = &pixels[(size_t)(height - 1 - y) * rowSize];
+		std::memcpy(row.data(), top, rowSize);
+		std::memcpy(top, bottom, rowSize);
+		std::memcpy(bottom, row.data(), rowSize);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <sepch.h>
+
+#include <ShmingoCore.h>
+
+//GL context without a window or a display connection, for running the engine on machines without a monitor.
+//Built on EGL's surfaceless platform when se_HEADLESS_EGL is defined, or on OSMesa's software renderer when se_HEADLESS_OSMESA is defined.
+//Frames are drawn into a framebuffer object of a fixed size, which stays bound as the draw target for the whole run
+
+namespace Shmingo {
+
+	class HeadlessContext {
+
+	public:
+
+		HeadlessContext() {};
+		~HeadlessContext();
+
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+		/// <summary>
+		/// Creates the context, makes it current on the calling thread, loads GL functions and creates the framebuffer
+		/// </summary>
+		/// <returns>False if no headless backend was built in or the context could not be created</returns>
+		bool create(int width, int height);
+
+		void destroy();
+
+		/// <summary>
+		/// Copies the framebuffer's color into pixels, tightly packed RGBA rows, top row first
+		/// </summary>
+		void readPixels(std::vector<uint8_t>& pixels);
+
+		inline GLuint getFramebufferID() { return framebufferID; };
+
+	private:
+
+		int width = 0;
+		int height = 0;
+
+		GLuint framebufferID = 0;
+		GLuint colorRenderbufferID = 0;
+		GLuint depthRenderbufferID = 0;
+
+		void* display = nullptr; //EGLDisplay
+		void* context = nullptr; //EGLContext or OSMesaContext
+		std::vector<uint8_t> osmesaBuffer; //OSMesa needs a buffer to make a context current, nothing is drawn into it
+
+		bool createContext();
+		void createFramebuffer();
+	};
+}
@@ -1,20 +1,59 @@
 #include <sepch.h>
 #include "Window.h"
 #include "DisplayManager.h"
+#include "TextureTools.h"
 
-Shmingo::Window::Window(int width, int height) : width(width), height(height) {
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
 
-	initDisplay(); //Initializes display (Hopefully this is only done once, and I wont have to move this to main
+Shmingo::Window::Window(int width, int height) : Window(width, height, false) {}
 
-	this->window = createGLFWwindow(width, height);
+Shmingo::Window::Window(int width, int height, bool headless) : width(width), height(height), headless(headless), creationTime(std::chrono::steady_clock::now()) {
+
+	if (headless) {
+		headlessValid = headlessContext.create(width, height); //Never touches GLFW, there may be no display to connect to
+		return;
+	}
 
-	const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	initDisplay(); //Initializes display (Hopefully this is only done once, and I wont have to move this to main
 
+	this->window = createGLFWwindow(width, height);
 }
 
 void Shmingo::Window::cleanUp() {
+
+	if (headless) {
+		headlessContext.destroy();
+		return;
+	}
+
 	windowCleanUp(window);
 }
+
+double Shmingo::Window::getTime() {
+
+	if (headless) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - creationTime).count();
+	}
+
+	return glfwGetTime();
+}
+
+void Shmingo::Window::pollEvents() {
+	if (!headless) {
+		glfwPollEvents();
+	}
+}
+
+void Shmingo::Window::setFrameDumpDirectory(const std::string& directory) {
+
+	frameDumpDirectory = directory;
+
+	if (!directory.empty()) {
+		std::filesystem::create_directories(directory);
+	}
+}
 //Defaukt wrapper for setViewport, white background
 void Shmingo::Window::setViewport() {
 	setGLFWViewport(window, width, height);
@@ -26,7 +65,7 @@ void Shmingo::Window::setViewport(float red, float green, float blue, float alph
 }
 
 //Wrappers for GLFW/Opengl functions to do with GLFWwindow
-int Shmingo::Window::shouldDisplayClose() { return glfwWindowShouldClose(window); }
+int Shmingo::Window::shouldDisplayClose() { return headless ? 0 : glfwWindowShouldClose(window); }
 
 void Shmingo::Window::setDimensions(int newWidth, int newHeight){
 
@@ -35,7 +74,22 @@ void Shmingo::Window::setDimensions(int newWidth, int newHeight){
 
 }
 void Shmingo::Window::swapBuffers() {
-	glfwSwapBuffers(window); 
+
+	if (!headless) {
+		glfwSwapBuffers(window);
+		return;
+	}
+
+	if (frameDumpDirectory.empty()) {
+		glFlush(); //Nothing presents a headless frame, make sure it is actually submitted
+		return;
+	}
+
+	headlessContext.readPixels(dumpPixels);
+
+	std::ostringstream path;
+	path << frameDumpDirectory << "/frame_" << std::setw(5) << std::setfill('0') << dumpedFrames++ << ".png";
+	Shmingo::writePNG(path.str(), (GLuint)width, (GLuint)height, dumpPixels.data());
 }
 
 
@@ -44,3 +98,7 @@ void Shmingo::Window::swapBuffers() {
 Shmingo::Window* Shmingo::createWindow(int width, int height){
 	return new Shmingo::Window(width, height);
 }
+
+Shmingo::Window* Shmingo::createHeadlessWindow(int width, int height){
+	return new Shmingo::Window(width, height, true);
+}
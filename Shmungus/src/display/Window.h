@@ -1,7 +1,10 @@
 #pragma once
 #include <ShmingoCore.h>
 
-//This is a custom wrapper containing a GLFW window pointer, and any data associated with it
+#include "HeadlessContext.h"
+
+//This is a custom wrapper containing a GLFW window pointer, and any data associated with it.
+//A headless window has no GLFW window, it draws into an offscreen framebuffer of a fixed virtual resolution instead
 
 namespace Shmingo {
 
@@ -13,8 +16,16 @@ namespace Shmingo {
 
 		Window(int width, int height);
 
+		/// <summary>
+		/// Creates a window, or a headless context rendering into a width by height framebuffer
+		/// </summary>
+		Window(int width, int height, bool headless);
+
 		void cleanUp();
 
+		//False if creating the window or the headless context failed
+		inline bool isValid() { return headless ? headlessValid : window != nullptr; };
+
 		void setViewport();
 		void setViewport(float red, float green, float blue, float alpha);
 
@@ -23,6 +34,19 @@ namespace Shmingo {
 
 		inline GLFWwindow* getGLFWwindow() { return window; }
 
+		inline bool isHeadless() { return headless; };
+
+		//Seconds since the window was created
+		double getTime();
+
+		//Processes window events, does nothing when headless
+		void pollEvents();
+
+		/// <summary>
+		/// Headless only, writes every presented frame to directory/frame_00000.png and onwards. An empty directory turns dumping off
+		/// </summary>
+		void setFrameDumpDirectory(const std::string& directory);
+
 		inline int getWidth() { return width; };
 		inline int getHeight() { return height; };
 
@@ -32,7 +56,16 @@ namespace Shmingo {
 
 		int width;
 		int height;
-		GLFWwindow* window;
+		GLFWwindow* window = nullptr;
+
+		bool headless = false;
+		bool headlessValid = false;
+		HeadlessContext headlessContext;
+		std::chrono::steady_clock::time_point creationTime;
+
+		std::string frameDumpDirectory;
+		GLuint dumpedFrames = 0;
+		std::vector<uint8_t> dumpPixels;
 
 		void swapBuffers();
 
@@ -40,4 +73,5 @@ namespace Shmingo {
 
 	//This is so we can create our own type of window instead of a GLFWwindow, macro defined in engine
 	Window* createWindow(int width, int height);
+	Window* createHeadlessWindow(int width, int height);
 }
\ No newline at end of file
@@ -10,4 +10,5 @@
 #include "LayerStack.h"
 #include "MasterRenderer.h"
 #include "Event.h"
+#include "JobSystem.h"
 #include "MasterRenderer.h"
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <sepch.h>
+#include "JobSystem.h"
+
+JobSystem JobSystem::instance;
+
+void JobSystem::init(GLuint workerAmount) {
+
+	if (workerAmount == 0xFFFFFFFF) {
+		GLuint hardwareThreads = std::thread::hardware_concurrency();
+		workerAmount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	for (GLuint i = 0; i < workerAmount + 1; i++) {
+		queues.emplace_back(std::make_unique<WorkQueue>());
+	}
+
+	running = true;
+
+	for (GLuint i = 1; i < workerAmount + 1; i++) {
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+void JobSystem::shutdown() {
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	sleepCondition.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	workers.clear();
+	queues.clear();
+}
+
+void JobSystem::parallelFor(GLuint count, GLuint grainSize, const RangeJob& job) {
+
+	if (count == 0) {
+		return;
+	}
+
+	grainSize = std::max(grainSize, 1u);
+
+	//No pool or only one range, not worth waking anyone up
+	if (queues.size() <= 1 || count <= grainSize) {
+		for (GLuint begin = 0; begin < count; begin += grainSize) {
+			job(begin, std::min(begin + grainSize, count), 0);
+		}
+		return;
+	}
+
+	GLuint rangeAmount = (count + grainSize - 1) / grainSize;
+	std::atomic<GLuint> remaining = rangeAmount;
+
+	//Deal ranges out round robin so every thread starts with local work, stealing evens out the rest
+	for (GLuint i = 0; i < rangeAmount; i++) {
+
+		GLuint begin = i * grainSize;
+		WorkQueue& queue = *queues[i % queues.size()];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.emplace_back(Job(&job, begin, std::min(begin + grainSize, count), &remaining));
+	}
+
+	queuedJobs += rangeAmount;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex); //Workers check queuedJobs under this lock, so none of them can miss the wake up
+	}
+	sleepCondition.notify_all();
+
+	//The submitting thread works too until every range has finished
+	while (remaining.load(std::memory_order_acquire) != 0) {
+		if (!tryRunJob(0)) {
+			std::this_thread::yield(); //Remaining ranges are running on other threads
+		}
+	}
+}
+
+void JobSystem::workerLoop(GLuint index) {
+
+	threadIndex = index;
+
+	while (running) {
+
+		if (tryRunJob(index)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this] { return queuedJobs.load() > 0 || !running; });
+	}
+}
+
+bool JobSystem::tryRunJob(GLuint index) {
+
+	Job job;
+	bool found = popJob(index, false, job);
+
+	for (GLuint i = 1; i < queues.size() && !found; i++) {
+		found = popJob((index + i) % queues.size(), true, job);
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	(*job.function)(job.begin, job.end, index);
+	job.remaining->fetch_sub(1, std::memory_order_release);
+
+	return true;
+}
+
+bool JobSystem::popJob(GLuint queueIndex, bool steal, Job& out) {
+
+	WorkQueue& queue = *queues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.jobs.empty()) {
+		return false;
+	}
+
+	if (steal) {
+		out = queue.jobs.front();
+		queue.jobs.pop_front();
+	}
+	else {
+		out = queue.jobs.back();
+		queue.jobs.pop_back();
+	}
+
+	queuedJobs--;
+	return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+//Work stealing thread pool. Thread index 0 is the thread submitting jobs, the main thread or the world's simulation thread while it runs a frame,
+//which takes part in every parallelFor instead of idling. Only one of them submits at a time
+
+class JobSystem {
+
+public:
+
+	//Range job, receives [begin, end) and the index of the thread running it
+	typedef std::function<void(GLuint begin, GLuint end, GLuint threadIndex)> RangeJob;
+
+	inline static JobSystem& get() { return instance; };
+
+	/// <summary>
+	/// Starts the worker threads
+	/// </summary>
+	/// <param name="workerAmount">Amount of worker threads, on top of the main thread. Defaults to one less than the hardware thread count</param>
+	void init(GLuint workerAmount = 0xFFFFFFFF);
+
+	//Joins all worker threads
+	void shutdown();
+
+	/// <summary>
+	/// Splits [0, count) into ranges of grainSize and runs job on every range, blocks until all ranges are done.
+	/// Ranges are fixed by count and grainSize alone, so any per range output is the same no matter which thread ran it.
+	/// Must be called from thread index 0, see the class comment
+	/// </summary>
+	/// <param name="count">Amount of items</param>
+	/// <param name="grainSize">Items per range</param>
+	/// <param name="job">Function run on every range</param>
+	void parallelFor(GLuint count, GLuint grainSize, const RangeJob& job);
+
+	//Amount of threads including the main thread
+	inline GLuint getThreadAmount() { return (GLuint)queues.size(); };
+
+	//Index of the calling thread, 0 for the main and simulation threads
+	inline static GLuint getThreadIndex() { return threadIndex; };
+	inline static bool isMainThread() { return threadIndex == 0; };
+
+private:
+
+	JobSystem() {};
+
+	static JobSystem instance;
+
+	struct Job {
+
+		const RangeJob* function;
+		GLuint begin;
+		GLuint end;
+		std::atomic<GLuint>* remaining; //Counter of the parallelFor this job belongs to
+	};
+
+	//Each thread pushes and pops at the back of its own queue, thieves take from the front
+	struct WorkQueue {
+
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue>> queues; //One per thread, index matches thread index
+	std::vector<std::thread> workers;
+
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::atomic<GLuint> queuedJobs = 0;
+	std::atomic<bool> running = false;
+
+	inline static thread_local GLuint threadIndex = 0;
+
+	void workerLoop(GLuint index);
+
+	//Pops from own queue first, then tries to steal from every other queue. Returns false if there was no work anywhere
+	bool tryRunJob(GLuint index);
+	bool popJob(GLuint queueIndex, bool steal, Job& out);
+};
@@ -17,6 +17,8 @@
 #define se_application Shmingo::ShmingoApp::get()
 #define se_masterRenderer MasterRenderer::get()
 #define se_uniformBuffer UniformBuffer::get()
+#define se_jobSystem JobSystem::get()
+#define se_glState GLStateTracker::get()
 
 //Other macros
 #define se_currentWorld se_application.getCurrentWorld()
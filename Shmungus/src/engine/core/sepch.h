@@ -2,6 +2,9 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <fstream>
@@ -9,6 +12,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <span>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -16,10 +20,12 @@
 #include <thread>
 #include <unordered_map>
 #include <utility>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include <glad/glad.h>
-#include <glfw/glfw3.h>
+#include <GLFW/glfw3.h> //Upper case like the directory, Linux file systems are case sensitive
 #include <glm/glm.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -1,6 +1,7 @@
 #include <sepch.h>
 #include <ShmingoApp.h>
 #include <MiscTools.h>
+#include "GLStateTracker.h"
 
 
 double lastFrameTime = 0.0f;
@@ -25,33 +26,60 @@ Shmingo::ShmingoApp::~ShmingoApp() {
 
 
 void Shmingo::ShmingoApp::run() {
+	run(RunSettings());
+}
 
-	init();
+void Shmingo::ShmingoApp::run(const RunSettings& settings) {
 
+	if (!init(settings)) {
+		return;
+	}
+
+	double startTime = window->getTime();
 
 	while (!shouldApplicationClose) {
 		update();
 	}
 
+	if (frameLimit > 0) { //Fixed length runs are benchmarks, report how long they took
+		double runTime = (window->getTime() - startTime) * 1000.0;
+		se_log("Ran " << framesRun << " frames in " << runTime << " ms, " << runTime / framesRun << " ms per frame");
+	}
+
 	se_layerStack.cleanUp();
+	se_jobSystem.shutdown();
+	se_masterRenderer.cleanUp();
+	window->cleanUp();
 }
 
 
 
-void Shmingo::ShmingoApp::init() {
-	ShmingoApp::window = Shmingo::createWindow(1920, 1080); //Can change default aspect ratio when options is implemented
+bool Shmingo::ShmingoApp::init(const RunSettings& settings) {
 
-	glfwMakeContextCurrent(window->getGLFWwindow()); //Makes context current
+	frameLimit = settings.frameAmount;
 
-	gladLoadGL();
+	if (settings.headless) {
+		ShmingoApp::window = Shmingo::createHeadlessWindow(settings.width, settings.height); //Loads GL functions itself
+		window->setFrameDumpDirectory(settings.frameDumpDirectory);
+	}
+	else {
+		ShmingoApp::window = Shmingo::createWindow(settings.width, settings.height); //Can change default aspect ratio when options is implemented
+	}
 
-	if (!gladLoadGL()) {
-		std::cerr << "Failed to initialize OpenGL context\n";
-		// Handle initialization failure
+	if (!window->isValid()) {
+		se_error("Failed to create " << (settings.headless ? "headless context" : "window") << ", exiting");
+		return false;
 	}
 
-	//Set up monitor aspect ratio as a global variable
-	const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	if (!settings.headless) {
+
+		glfwMakeContextCurrent(window->getGLFWwindow()); //Makes context current
+
+		if (!gladLoadGL()) {
+			std::cerr << "Failed to initialize OpenGL context\n";
+			return false;
+		}
+	}
 
 	declareApplicationInfoKey(Shmingo::PRIMARY_MONITOR_WIDTH, "monitorWidth");
 	declareApplicationInfoKey(Shmingo::PRIMARY_MONITOR_HEIGHT, "monitorHeight");
@@ -63,17 +91,57 @@ void Shmingo::ShmingoApp::init() {
 	declareApplicationInfoKey(Shmingo::PLAYER_VELOCITY_X, "playerVelocityX");
 	declareApplicationInfoKey(Shmingo::PLAYER_VELOCITY_Y, "playerVelocityY");
 	declareApplicationInfoKey(Shmingo::PLAYER_VELOCITY_Z, "playerVelocityZ");
+	declareApplicationInfoKey(Shmingo::INSTANCE_UPLOAD_BYTES, "instanceUploadBytes");
+	declareApplicationInfoKey(Shmingo::INSTANCE_UPLOAD_CALLS, "instanceUploadCalls");
+	declareApplicationInfoKey(Shmingo::GL_CALLS_ISSUED, "glCallsIssued");
+	declareApplicationInfoKey(Shmingo::GL_CALLS_ELIDED, "glCallsElided");
+	declareApplicationInfoKey(Shmingo::VISIBLE_ENTITY_COUNT, "visibleEntityCount");
+	declareApplicationInfoKey(Shmingo::GPU_FRAME_TIME, "gpuFrameTime");
+	declareApplicationInfoKey(Shmingo::GPU_UPLOAD_TIME, "gpuUploadTime");
+	declareApplicationInfoKey(Shmingo::GPU_ENTITY_TIME, "gpuEntityTime");
+	declareApplicationInfoKey(Shmingo::GPU_TERRAIN_TIME, "gpuTerrainTime");
+	declareApplicationInfoKey(Shmingo::GPU_TEXT_TIME, "gpuTextTime");
+	declareApplicationInfoKey(Shmingo::GPU_MENU_TIME, "gpuMenuTime");
+	declareApplicationInfoKey(Shmingo::CHUNK_BUILD_QUEUE, "chunkBuildQueue");
+	declareApplicationInfoKey(Shmingo::CHUNK_BUILD_LATENCY, "chunkBuildLatency");
+	declareApplicationInfoKey(Shmingo::CHUNK_STREAM_COUNT, "chunkStreamCount");
+
+	//There is no monitor when headless, the virtual resolution stands in for it
+	int monitorWidth = settings.width;
+	int monitorHeight = settings.height;
+
+	if (!settings.headless) {
+		const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		monitorWidth = mode->width;
+		monitorHeight = mode->height;
+	}
 
-	setApplicationInfo(Shmingo::PRIMARY_MONITOR_WIDTH, std::to_string(mode->width));
-	setApplicationInfo(Shmingo::PRIMARY_MONITOR_HEIGHT, std::to_string(mode->height));
+	setApplicationInfo(Shmingo::PRIMARY_MONITOR_WIDTH, std::to_string(monitorWidth));
+	setApplicationInfo(Shmingo::PRIMARY_MONITOR_HEIGHT, std::to_string(monitorHeight));
 	setApplicationInfo(Shmingo::ENTITY_COUNT, "0");
-
-	glEnable(GL_CULL_FACE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_SRC_ALPHA);
+	setApplicationInfo(Shmingo::INSTANCE_UPLOAD_BYTES, "0");
+	setApplicationInfo(Shmingo::INSTANCE_UPLOAD_CALLS, "0");
+	setApplicationInfo(Shmingo::GL_CALLS_ISSUED, "0");
+	setApplicationInfo(Shmingo::GL_CALLS_ELIDED, "0");
+	setApplicationInfo(Shmingo::VISIBLE_ENTITY_COUNT, "0");
+	setApplicationInfo(Shmingo::GPU_FRAME_TIME, "0/0");
+	setApplicationInfo(Shmingo::GPU_UPLOAD_TIME, "0/0");
+	setApplicationInfo(Shmingo::GPU_ENTITY_TIME, "0/0");
+	setApplicationInfo(Shmingo::GPU_TERRAIN_TIME, "0/0");
+	setApplicationInfo(Shmingo::GPU_TEXT_TIME, "0/0");
+	setApplicationInfo(Shmingo::GPU_MENU_TIME, "0/0");
+	setApplicationInfo(Shmingo::CHUNK_BUILD_QUEUE, "0/0");
+	setApplicationInfo(Shmingo::CHUNK_BUILD_LATENCY, "0/0");
+	setApplicationInfo(Shmingo::CHUNK_STREAM_COUNT, "0/0/0");
+
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, true);
+	se_glState.setCapability(Shmingo::BLEND_CAPABILITY, true);
+	se_glState.setBlendFunc(GL_SRC_ALPHA, GL_SRC_ALPHA);
 
 	initGlobalVariables(); //Initialize global variables after GLAD is loaded
 
+	se_jobSystem.init(); //Worker threads for parallel entity updates, must be up before any world is initialized
+
 	se_layerStack.init();
 
 	Shmingo::initModels();
@@ -90,6 +158,10 @@ void Shmingo::ShmingoApp::init() {
 
 	se_layerStack.emplaceLayer(new SandboxLayer);
 
+	if (settings.headless) {
+		return true; //No input and no swap chain
+	}
+
 	glfwSwapInterval(0); //Disable v sync
 
 	Shmingo::setGLFWkeyCallback();
@@ -97,12 +169,13 @@ void Shmingo::ShmingoApp::init() {
 	Shmingo::setGLFWWindowCallbacks();
 	Shmingo::setGLFWCursorPosCallback();
 
+	return true;
 }
 
 void Shmingo::ShmingoApp::update() {
 	window->setViewport(0.1f, 0.3f, 1.0f, 1.0f); //Contains clear color and other settings
 
-	double time = glfwGetTime(); //TODO Make platform specific later on - similar to gl functions
+	double time = window->getTime();
 	deltaTime = time - lastFrameTime;
 
 	lastFrameTime = time;
@@ -121,11 +194,12 @@ void Shmingo::ShmingoApp::update() {
 
 
 	window->swapBuffers();
-	glfwPollEvents();
+	window->pollEvents();
 
 	totalFrames++;
+	framesRun++;
 
-	if (window->shouldDisplayClose()) {
+	if (window->shouldDisplayClose() || (frameLimit > 0 && framesRun >= frameLimit)) {
 		setShoulApplicationClose();
 	}
 
@@ -11,6 +11,16 @@
 
 namespace Shmingo {
 
+	//How the application runs, filled from the command line by main
+	struct RunSettings {
+
+		bool headless = false; //Renders offscreen without a window or display, see HeadlessContext
+		int width = 1920; //Window size, or the virtual resolution when headless
+		int height = 1080;
+		GLuint frameAmount = 0; //Frames to run before exiting, 0 runs until the window is closed
+		std::string frameDumpDirectory; //Headless only, every frame is written there as a PNG when not empty
+	};
+
 	class ShmingoApp {
 
 	public:
@@ -91,6 +101,11 @@ namespace Shmingo {
 		std::vector<Shmingo::EntityType> entityTypes;
 		void run();
 
+		/// <summary>
+		/// Runs the application with the given settings, returns once the window is closed or settings.frameAmount frames have run
+		/// </summary>
+		void run(const RunSettings& settings);
+
 		//Global getters
 		inline int getMinimumUniformBlockOffset() { return minimumUniformBlockOffset; }
 
@@ -98,7 +113,7 @@ namespace Shmingo {
 
 		ShmingoApp(); //Privated constructor
 
-		void init();
+		bool init(const RunSettings& settings); //False if no window or context could be created
 		void update();
 
 		Shmingo::Window* window; //Window object
@@ -119,6 +134,9 @@ namespace Shmingo {
 
 		bool shouldApplicationClose = false;
 
+		GLuint frameLimit = 0; //0 for no limit
+		GLuint framesRun = 0;
+
 		vec2 lastFrameWindowDimensions = vec2(0, 0);
 
 		void updateTextResizingVariables();
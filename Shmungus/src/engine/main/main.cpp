@@ -4,8 +4,43 @@
 
 Shmingo::ShmingoApp Shmingo::ShmingoApp::instance; //Declaration of singleton ShmingoApp
 
-int main() {
+//Command line: --headless, --frames N, --resolution WIDTHxHEIGHT, --dump-frames DIRECTORY
+static Shmingo::RunSettings parseRunSettings(int argc, char** argv) {
 
-	se_application.run();
+	Shmingo::RunSettings settings;
 
-}
\ No newline at end of file
+	for (int i = 1; i < argc; i++) {
+
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--headless") {
+			settings.headless = true;
+		}
+		else if (argument == "--frames" && hasValue) {
+			settings.frameAmount = (GLuint)std::stoul(argv[++i]);
+		}
+		else if (argument == "--resolution" && hasValue) {
+			std::string resolution = argv[++i];
+			size_t separator = resolution.find('x');
+			if (separator != std::string::npos) {
+				settings.width = std::stoi(resolution.substr(0, separator));
+				settings.height = std::stoi(resolution.substr(separator + 1));
+			}
+		}
+		else if (argument == "--dump-frames" && hasValue) {
+			settings.frameDumpDirectory = argv[++i];
+		}
+		else {
+			se_log("Unknown argument " << argument);
+		}
+	}
+
+	return settings;
+}
+
+int main(int argc, char** argv) {
+
+	se_application.run(parseRunSettings(argc, argv));
+
+}
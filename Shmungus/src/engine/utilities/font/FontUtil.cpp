@@ -2,6 +2,7 @@
 #include "FontUtil.h"
 
 #include "ShmingoApp.h"
+#include "GLStateTracker.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -41,8 +42,7 @@ void Shmingo::loadFont(std::string name) {
     se_application.setFontTextureArrayID(name, 0);
 
     glGenTextures(1, se_application.getFontTextureArrayIDPtr(name));
-    glActiveTexture(GL_TEXTURE31);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, se_application.getFontTextureArrayID(name));
+    se_glState.bindTexture(31, GL_TEXTURE_2D_ARRAY, se_application.getFontTextureArrayID(name));
     glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, 256, 256, 128, 0, GL_RED, GL_UNSIGNED_BYTE, 0);
 
 
@@ -88,19 +88,18 @@ void Shmingo::loadFont(std::string name) {
         };
         se_application.declareCharacterFontInfo(name, c, character);
     }
-    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    se_glState.bindTexture(31, GL_TEXTURE_2D_ARRAY, 0);
 
     // Destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
 }
 
-void Shmingo::bindFontTextureToShader(std::shared_ptr<ShaderProgram> shader, std::string fontName) {
+void Shmingo::bindFontTextureToShader(ShaderProgram& shader, const std::string& fontName) {
 
-    glActiveTexture(GL_TEXTURE31);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, se_application.getFontTextureArrayID(fontName));
+    se_glState.bindTexture(31, GL_TEXTURE_2D_ARRAY, se_application.getFontTextureArrayID(fontName));
 
-    GLint location = glGetUniformLocation(shader->getProgramID(), "font"); // Get uniform location
+    GLint location = glGetUniformLocation(shader.getProgramID(), "font"); // Get uniform location
     glUniform1i(location, 31); // Set uniform value to 0
 
 }
@@ -16,6 +16,6 @@ namespace Shmingo {
 	void loadFont(std::string name);
 
 
-    void bindFontTextureToShader(std::shared_ptr<ShaderProgram> shader, std::string fontName);
+    void bindFontTextureToShader(ShaderProgram& shader, const std::string& fontName);
 
 }
\ No newline at end of file
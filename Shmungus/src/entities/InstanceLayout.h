@@ -0,0 +1,103 @@
+#pragma once
+
+#include <sepch.h>
+#include <tuple>
+#include <glm/gtc/type_precision.hpp>
+
+#include "DataStructures.h"
+
+/*
+Compile time description of the per instance data of an entity type.
+Each entity class declares its layout once, for example
+	using InstanceLayout = ::InstanceLayout<Mat4Attr<"transformationMatrix">, FloatAttr<"textureID">>;
+Offsets, sizes and attribute numbers are computed by the compiler, and the runtime view returned by getInfo() is what archetypes and EntityVertexArray read.
+*/
+
+//String literal usable as a template argument
+template<size_t N>
+struct AttributeName {
+
+	char value[N];
+
+	constexpr AttributeName(const char (&string)[N]) {
+		for (size_t i = 0; i < N; i++) {
+			value[i] = string[i];
+		}
+	}
+};
+
+/// <summary>
+/// Describes one per instance attribute
+/// </summary>
+/// <typeparam name="T">CPU side type of the attribute</typeparam>
+/// <typeparam name="ComponentType">GL type of one component</typeparam>
+/// <typeparam name="ComponentAmount">Components per attribute slot, at most 4</typeparam>
+/// <typeparam name="SlotAmount">Attribute slots taken up, a mat4 takes 4</typeparam>
+/// <typeparam name="Normalized">Whether integer components are normalized to [0, 1] or [-1, 1]</typeparam>
+/// <typeparam name="Integer">Whether the shader reads the attribute as an integer type</typeparam>
+template<AttributeName Name, typename T, GLenum ComponentType, GLuint ComponentAmount, GLuint SlotAmount = 1, bool Normalized = false, bool Integer = false>
+struct InstanceAttribute {
+
+	using Type = T;
+
+	static constexpr const char* name = Name.value;
+	static constexpr GLuint size = sizeof(T); //Size in bytes
+	static constexpr GLuint slotAmount = SlotAmount;
+
+	static constexpr Shmingo::EntitySpecificInstanceDataInfo getInfo(GLuint localOffset, GLuint attributeNumber) {
+		return Shmingo::EntitySpecificInstanceDataInfo(name, size, localOffset, attributeNumber, SlotAmount, ComponentAmount, ComponentType, Normalized, Integer);
+	}
+};
+
+template<AttributeName Name> using FloatAttr = InstanceAttribute<Name, float, GL_FLOAT, 1>;
+template<AttributeName Name> using Vec2Attr = InstanceAttribute<Name, vec2, GL_FLOAT, 2>;
+template<AttributeName Name> using Vec3Attr = InstanceAttribute<Name, vec3, GL_FLOAT, 3>;
+template<AttributeName Name> using Vec4Attr = InstanceAttribute<Name, vec4, GL_FLOAT, 4>;
+template<AttributeName Name> using Mat4Attr = InstanceAttribute<Name, mat4, GL_FLOAT, 4, 4>;
+
+//Compact attributes, read as floats in the shader
+template<AttributeName Name> using Snorm16Vec2Attr = InstanceAttribute<Name, glm::i16vec2, GL_SHORT, 2, 1, true>; //[-32767, 32767] arrives as [-1, 1]
+template<AttributeName Name> using HalfVec3Attr = InstanceAttribute<Name, glm::u16vec3, GL_HALF_FLOAT, 3>; //Bit patterns from glm::packHalf1x16
+
+template<AttributeName Name> using Uint16Attr = InstanceAttribute<Name, uint16_t, GL_UNSIGNED_SHORT, 1, 1, false, true>; //Read as uint in the shader
+
+
+namespace Shmingo {
+
+	//Lays attributes out back to back in declaration order, attribute numbers are local to the first per instance slot
+	template<typename... Attributes>
+	constexpr std::array<Shmingo::EntitySpecificInstanceDataInfo, sizeof...(Attributes)> createInstanceAttributeInfo() {
+
+		std::array<Shmingo::EntitySpecificInstanceDataInfo, sizeof...(Attributes)> out{};
+
+		GLuint index = 0;
+		GLuint offset = 0;
+		GLuint attributeNumber = 0;
+
+		((out[index++] = Attributes::getInfo(offset, attributeNumber), offset += Attributes::size, attributeNumber += Attributes::slotAmount), ...);
+
+		return out;
+	}
+}
+
+template<typename... Attributes>
+class InstanceLayout {
+
+public:
+
+	static constexpr GLuint attributeAmount = sizeof...(Attributes);
+	static constexpr GLuint stride = (Attributes::size + ... + 0); //Size in bytes of one instance with every attribute interleaved
+	static constexpr GLuint slotAmount = (Attributes::slotAmount + ... + 0); //Total attribute slots used
+
+	static constexpr std::array<Shmingo::EntitySpecificInstanceDataInfo, attributeAmount> attributes = Shmingo::createInstanceAttributeInfo<Attributes...>();
+
+	template<GLuint I> using Attribute = std::tuple_element_t<I, std::tuple<Attributes...>>;
+	template<GLuint I> using AttributeType = typename Attribute<I>::Type;
+
+	template<GLuint I> static constexpr GLuint offset = attributes[I].localOffset;
+	template<GLuint I> static constexpr GLuint attributeNumber = attributes[I].attributeNumber;
+
+	static constexpr Shmingo::InstanceLayoutInfo getInfo() {
+		return Shmingo::InstanceLayoutInfo(std::span<const Shmingo::EntitySpecificInstanceDataInfo>(attributes), stride, slotAmount);
+	}
+};
@@ -3,11 +3,14 @@
 #include <ShmingoCore.h>
 
 #include "DataStructures.h"
+#include "InstanceLayout.h"
 
 namespace Shmingo {
-	void declareTypeCorrespondence();
+	void declareTypeCorrespondence(); //Also declares every entity type's instance layout
 }
 
+class EntityArchetype;
+
 class InstancedEntity{
 
 public:
@@ -17,84 +20,76 @@ public:
 	InstancedEntity(vec3 position, vec2 rotation, vec3 scale);
 
 
-	virtual void update() = 0; //Update function for the entity, called every frame
+	virtual void update() = 0; //Update function for the entity, called every frame. May run on a worker thread, so only touch this entity and use the world's defer functions to spawn or delete
 
+	Shmingo::EntityHandle getHandle(); //Handle of this entity in the current world
 
 
 
 
-	//----------------------------------------Engine-related code----------------------------------------//
 
-	typedef std::vector<Shmingo::EntitySpecificInstanceDataInfo> perInstanceInstanceInfo;
+	//----------------------------------------Engine-related code----------------------------------------//
 
 	/// <summary>
-	/// Returns pointer to beginning offset of the vertex data array corresponding to the desired attribute
+	/// Returns pointer to this entity's data for the desired attribute inside the archetype's column
 	/// </summary>
 	/// <param name="attributeNumber">
-	/// attribute number
-	/// </param>
-	/// <param name="instancedAttributeInfo">
-	/// Static instanced attribute array
+	/// Index of the attribute in the entity's instance layout
 	/// </param>
 	/// <returns></returns>
-	float* getInstanceData(GLuint attributeNumber);
+	uint8_t* getInstanceDataPointer(GLuint attributeNumber);
 
 	inline GLuint getOffsetInVao() { return offsetInVao; };
-	inline void setOffsetInVao(GLuint offset) { offsetInVao = offset; }; //Used when adding entity vertex data to a VAO
-	inline void decrementOffsetInVao() { offsetInVao--; }; //Used when deleting entity vertex data from a VAO	
-	inline void incrementOffsetInVao() { offsetInVao++; }; //Used when adding entity vertex data to a VAO, probably not used
 
-	virtual Shmingo::TransformComponent getTransformComponent() = 0; //Used for getters?
-	virtual Shmingo::EntityType getEntityType() = 0;
+	/// <summary>
+	/// Binds the entity to its row in an archetype, called by the archetype whenever the entity is created or moved
+	/// </summary>
+	/// <param name="owner">Archetype storing this entity's columns</param>
+	/// <param name="row">Row of the entity, equal to its instance offset in the VAO</param>
+	inline void attachToArchetype(EntityArchetype* owner, GLuint row) { archetype = owner; offsetInVao = row; };
+
+	//Writes initial per instance data, called once the entity is attached to its archetype
+	virtual void initializeInstanceData() {};
 
-	virtual perInstanceInstanceInfo getInstancedInstanceAttributeInfo() = 0;
+	Shmingo::TransformComponent& getTransformComponent(); //Transform stored in the archetype's transform column
+	virtual Shmingo::EntityType getEntityType() = 0;
 
 	virtual vec3 getPosition() = 0;
 
 
 protected:
 
-	static constexpr GLuint instancedAttributeAmount = 0;
-
 	/// <summary>
-	/// To be used in constructor of derived classes to declare the per instance instance wide data for this entity
+	/// Typed setter for the per instance data, checked against the entity's layout at compile time and writes straight into the archetype's column
 	/// </summary>
-	/// <param name="localAttributeNumber">
-	/// The LOCAL attribute number, offset at the first INSTANCED attribute number, not real attribute number. 
-	/// If a VAO has 5 attributes, 3 normal, 2 instanced per vertex attributes and 2 instanced per instance vertex attributes, the local attribute number for the first instanced attribute is 0, not 5.
-	/// </param>
-	/// <param name="vertexData">
+	/// <typeparam name="Layout">The entity class's InstanceLayout</typeparam>
+	/// <typeparam name="I">Index of the attribute in the layout</typeparam>
+	/// <param name="data">
 	/// Data to be passed to the VAO, such as position, rotation, etc.
 	/// </param>
-	void setInstanceData(GLuint localAttributeNumber, float data);
-	void setInstanceData(GLuint localAttributeNumber, vec2 data);
-	void setInstanceData(GLuint localAttributeNumber, vec3 data);
-	void setInstanceData(GLuint localAttributeNumber, vec4 data);
-	void setInstanceData(GLuint localAttributeNumber, mat4 data);
-
+	template<typename Layout, GLuint I>
+	inline void setInstanceData(const typename Layout::template AttributeType<I>& data) {
+		std::memcpy(getInstanceDataPointer(I), &data, sizeof(data));
+	}
 
 	/// <summary>
-	/// Getters for the per instance instance data
+	/// Typed getter for the per instance data
 	/// </summary>
-	/// <param name="attributeNumber"></param>
-	/// <returns></returns>
-	float getInstanceDataFloat(GLuint attributeNumber);
-	vec2 getInstanceDataVec2(GLuint attributeNumber);
-	vec3 getInstanceDataVec3(GLuint attributeNumber);
-	vec4 getInstanceDataVec4(GLuint attributeNumber);
-	mat4 getInstanceDataMat4(GLuint attributeNumber);
+	template<typename Layout, GLuint I>
+	inline typename Layout::template AttributeType<I> getInstanceData() {
+		typename Layout::template AttributeType<I> out;
+		std::memcpy(&out, getInstanceDataPointer(I), sizeof(out));
+		return out;
+	}
 
 
-	/// <summary>
-	/// pass in the static attribute list to be used in the constructor (Should be the same for every derived class as double as you dont change the static member's name)
-	/// </summary>
-	/// <param name="vertexDataInfo">
-	/// Class's static vertex attribute information list
-	/// </param>
-	void instantiateInstanceData();
+	//Marks one attribute of this entity's instance data as changed, the renderer uploads it before drawing
+	void markInstanceDataDirty(GLuint localAttributeNumber);
 
-	std::unique_ptr<float[]> perInstanceInstanceData; //Interleaved vertex data for this entity - will be converted by the getVertexData function to one attribute in a getter if data can be directly read as is
+	//Marks this entity's bounds as changed, call whenever its position or scale changes so the world's spatial index follows it
+	void markMoved();
 
+	EntityArchetype* archetype = nullptr; //Owner of this entity's columns
 
 	GLuint offsetInVao = 0; //Offset of per instance vertex data (normalized to number of entities, not byte size)
 };
@@ -121,15 +116,6 @@ GLuint getModelVertexCount(Shmingo::EntityType type);
 /// <returns></returns>
 std::vector<Shmingo::EntitySpecificVertexDataInfo> createPerInstanceVertexDataList(Shmingo::EntityType type, GLuint attributeAmount, ...);
 
-/// <summary>
-/// Sets the instance attribute information for an entity type
-/// </summary>
-/// <param name="type">Type to set information for</param>
-/// <param name="attributeAmount">Amount of attributes</param>
-/// <param name="">Interleaved strings and unsigned ints corresponding to attribute name and amount of floats</param>
-/// <returns></returns>
-std::vector<Shmingo::EntitySpecificInstanceDataInfo> createPerInstanceInstanceDataList(Shmingo::EntityType type, GLuint attributeAmount, ...);
-
 
 
 //Default entity used outside of instanced rendering, such as the batch renderer methods
@@ -145,39 +131,28 @@ public:
 
 	void update() override;
 
+	void initializeInstanceData() override;
 
 
 
-	void setTransformationMatrix(mat4 newMatrix);
 
+	//Each setter only rewrites its own attribute, the shader builds the transformation matrix
 	void setPosition(vec3 newPosition);
 	void setRotation(vec2 newRotation);
 	void setScale(vec3 newScale);
 
-	void setTextureID(float newTextureID);
-
-	//Not using an instanced data getter for these two because our position and rotation data automatically put in a transformation matrix, they are stored separately
-	vec3 getPosition() override {return position;};
-	vec2 getRotation() {return rotation;};
-	float getTextureID();
+	//Packed texture registry handle, see Shmingo::TextureHandle
+	void setTextureID(GLuint newTextureID);
 
-	Shmingo::TransformComponent getTransformComponent() override;
+	//Not using an instanced data getter for these because the GPU copies of rotation and scale are quantized, full precision values are kept in the transform
+	vec3 getPosition() override {return getTransformComponent().position;};
+	vec2 getRotation() {return getTransformComponent().rotation;};
+	vec3 getScale() {return getTransformComponent().scale;};
+	GLuint getTextureID();
 
 	DefaultEntity(vec3 position, vec2 rotation, vec3 scale);
 
-	static perInstanceInstanceInfo getInstancedUniformInfo() { return instancedAttributeInfo; };
-
-	virtual perInstanceInstanceInfo getInstancedInstanceAttributeInfo() override {return instancedAttributeInfo;};
-
-
-protected:
-
-	void updateTransformationMatrix();
-
-	static perInstanceInstanceInfo instancedAttributeInfo;
-
-	//Used locally and for getters because we can't get directly from transform matrix
-	vec3 position;
-	vec2 rotation;
-	vec3 scale;
+	//Per instance data, attribute order must match the entity shader's per instance inputs.
+	//Compact transform, 24 bytes per instance instead of a 68 byte matrix and float: rotation is pitch and yaw as snorm16, scale is half floats
+	using InstanceLayout = ::InstanceLayout<Vec3Attr<"position">, Snorm16Vec2Attr<"rotation">, HalfVec3Attr<"scale">, Uint16Attr<"textureID">>;
 };
\ No newline at end of file
@@ -1,3 +1,3 @@
 #include <sepch.h>
 
-#include "Entity.h"
\ No newline at end of file
+#include "entity.h"
\ No newline at end of file
@@ -14,6 +14,14 @@ void InfoLayer::onAttach() {
 	se_layerStack.addListener<InfoLayer, KeyPressEvent>(Shmingo::INFO_LAYER, this, &InfoLayer::keybordCallback);
 
 	infoSpace.submitDynamicTextBox(DynamicTextBox("Entity Count: ~§§uentityCount", vec2(0.5, 0), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Instance Uploads: ~§§uinstanceUploadBytes bytes, ~§§uinstanceUploadCalls calls", vec2(0.5, 0.04f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("GL State Calls: ~§§uglCallsIssued issued, ~§§uglCallsElided elided", vec2(0.5, 0.08f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Visible Entities: ~§§uvisibleEntityCount", vec2(0.5, 0.12f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("GPU ms avg/max: Frame ~§§ugpuFrameTime, Uploads ~§§ugpuUploadTime", vec2(0.5, 0.16f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Entities ~§§ugpuEntityTime, Terrain ~§§ugpuTerrainTime", vec2(0.5, 0.20f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Text ~§§ugpuTextTime, Menus ~§§ugpuMenuTime", vec2(0.5, 0.24f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Chunk Builds queued/building: ~§§uchunkBuildQueue, ms avg/max: ~§§uchunkBuildLatency", vec2(0.5, 0.28f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
+	infoSpace.submitDynamicTextBox(DynamicTextBox("Chunks loaded/meshed/pending: ~§§uchunkStreamCount", vec2(0.5, 0.32f), vec2(0.5f, 0.1f), 6, 1, 10, Shmingo::RIGHT));
 	infoSpace.submitDynamicTextBox(DynamicTextBox("Player Position: ~§§uplayerX, ~§§uplayerY, ~§§uplayerZ", vec2(0, 0.04f), vec2(1.0f, 0.1f), 6, 1, 10, Shmingo::LEFT));
 	infoSpace.submitDynamicTextBox(DynamicTextBox("FPS: ~§§ufps", vec2(0, 0), vec2(0.2f, 0), 6, 1, 10, Shmingo::LEFT));
 	infoSpace.submitDynamicTextBox(DynamicTextBox("Player Velocity: ~§§IplayerVelocityX, ~§§IplayerVelocityY, ~§§IplayerVelocityZ", vec2(0, 0.08f), vec2(1.0f, 0.1f), 6, 1, 10, Shmingo::LEFT));
@@ -10,8 +10,11 @@
 #include "Renderer.h"
 #include "TextBox.h"
 #include "TextVertexArray.h"
-#include "ChunkVertexArray.h"
 #include "ShmingoApp.h"
+#include "Benchmarks.h"
+#include "TerrainGenerator.h"
+
+const float PLAYER_SPAWN_EYE_HEIGHT = 2.0f; //Blocks above the surface of the spawn column
 
 
 
@@ -23,13 +26,12 @@ std::shared_ptr<Player> player;
 
 std::shared_ptr<Model> cubeModel;
 
-std::shared_ptr<ChunkVertexArray> chunkVertexArray;
-
 SandboxLayer::~SandboxLayer() {
 
 }
 
-int thingyIndex = 0;
+std::vector<Shmingo::EntityHandle> thingyHandles; //Handles of the debug entities spawned with L, in spawn order
+vec3 spawnPosition = vec3(0.0f, 0.0f, 0.0f); //Debug entities line up in front of this so they are in view from the spawn
 
 void SandboxLayer::onAttach() {
 	world.init();
@@ -46,43 +48,21 @@ void SandboxLayer::onAttach() {
 
 	//Creating other objects
 
-	player.reset(new Player(Shmingo::createCubeModel(vec3(0.0f,0.0f,0.0f),funnyTexture)));
+	//Terrain is solid from y = 0 up to its surface, spawning at the origin would put the camera inside it
+	spawnPosition = vec3(0.0f, (float)Shmingo::getTerrainHeight(0, 0, CHUNK_STREAM_SEED) + PLAYER_SPAWN_EYE_HEIGHT, 0.0f);
+
+	player.reset(new Player(Shmingo::createCubeModel(vec3(0.0f,0.0f,0.0f),funnyTexture), spawnPosition));
 
 	se_uniformBuffer.setAsActive();
 	se_uniformBuffer.setProjectionMatrix(Shmingo::createProjectionMatrix(45.0f, se_application.getWindow()->getWidth(), se_application.getWindow()->getHeight(), 0.1f, 10000.0f));
 	se_uniformBuffer.setOrthoMatrix(Shmingo::createOrthoMatrix(se_application.getWindow()->getWidth(), se_application.getWindow()->getHeight()));
 
-
-
-
-	//Debug stuff
-	chunkVertexArray.reset(new ChunkVertexArray());
-	chunkVertexArray->init();
-
-
-	size_t trianglesToDraw = 12;
-	/*
-	for (size_t i = 0; i < trianglesToDraw; i++) {
-		chunkVertexArray->submitTriangleDebug(i, uvec3(0, 0, 0), 0, i + 12);
-	}
-
-	for (size_t i = 0; i < 12; i++) {
-		chunkVertexArray->submitTriangleDebug(i + trianglesToDraw, uvec3(2, 2, 0), 0, i);
-	}
-	*/
-	chunkVertexArray->submitTriangleDebug(0, uvec3(0, 0, 0), 0, 32);
-	chunkVertexArray->submitTriangleDebug(1, uvec3(0, 0, 0), 0, 19);
-	chunkVertexArray->submitTriangleDebug(2, uvec3(0, 0, 0), 0, 3);
-	chunkVertexArray->submitTriangleDebug(3, uvec3(0, 0, 0), 0, 33);
-
-
-
 }
 
 void SandboxLayer::onUpdate() {
 
 	player->update();
-	se_masterRenderer.submitTerrainVertexArray(chunkVertexArray, se_TERRAIN_SHADER);
+	world.setTerrainCenter(player->getPosition());
 	world.update();
 
 	std::string thing = se_application.getApplicationInfo("entityCount");
@@ -101,17 +81,70 @@ void SandboxLayer::KeyboardCallback(KeyPressEvent* e){
 	}
 
 	else if (e->getKey() == se_KEY_L) {
-		world.createEntity(Shmingo::DefaultEntity, vec3(3 * (float)(thingyIndex % 6), 3 * (float)(thingyIndex / 6), -4.0f), vec2(0.0f,0.0f), vec3(1.2f,1.2f,1.2f));
-		thingyIndex++;
+		GLuint thingyIndex = (GLuint)thingyHandles.size();
+		thingyHandles.emplace_back(world.createEntity(Shmingo::DefaultEntity, spawnPosition + vec3(3 * (float)(thingyIndex % 6), 3 * (float)(thingyIndex / 6), -4.0f), vec2(0.0f,0.0f), vec3(1.2f,1.2f,1.2f)));
 	}
 
 	else if (e->getKey() == se_KEY_K) {
-		if (thingyIndex > 0) {
-			world.deleteEntity(Shmingo::DefaultEntity, thingyIndex - 1);
-			thingyIndex--;
+		if (!thingyHandles.empty()) {
+			world.deleteEntity(thingyHandles.back());
+			thingyHandles.pop_back();
+		}
+	}
+
+	else if (e->getKey() == se_KEY_B) {
+		Shmingo::benchmarkEntitySpawn(world, 100000);
+	}
+
+	else if (e->getKey() == se_KEY_N) {
+		Shmingo::benchmarkEntitySpawn(world, 1000000); //Crowd scale, a single type well past the initial buffer capacity
+	}
+
+	else if (e->getKey() == se_KEY_V) {
+		world.waitForSimulation(); //Benchmarks use the job system and the instance ring, neither can be shared with a frame in flight
+		for (GLuint amount : { 10000, 100000, 1000000 }) {
+			Shmingo::benchmarkInstanceStorage(amount);
+		}
+	}
+
+	else if (e->getKey() == se_KEY_O) {
+		world.waitForSimulation();
+		for (GLuint amount : { 10000, 100000, 1000000 }) {
+			Shmingo::benchmarkSpatialIndex(amount);
 		}
 	}
 
+	else if (e->getKey() == se_KEY_M) {
+		Shmingo::benchmarkChunkMeshing(1000);
+	}
+
+	else if (e->getKey() == se_KEY_J) {
+		Shmingo::benchmarkChunkBuilder(400);
+	}
+
+	else if (e->getKey() == se_KEY_U) {
+		Shmingo::benchmarkChunkStreaming(600, 4.0f); //240 blocks a second, far past the player's top speed, a chunk boundary every 4 frames
+	}
+
+	else if (e->getKey() == se_KEY_G) {
+		Shmingo::benchmarkTerrainDraw(200);
+	}
+
+	else if (e->getKey() == se_KEY_P) {
+		se_masterRenderer.setTerrainVertexPulling(!se_masterRenderer.isTerrainVertexPullingEnabled());
+		se_log("Terrain vertex pulling " << (se_masterRenderer.isTerrainVertexPullingEnabled() ? "enabled" : "disabled"));
+	}
+
+	else if (e->getKey() == se_KEY_C) {
+		se_masterRenderer.setEntityCulling(!se_masterRenderer.isEntityCullingEnabled());
+		se_log("Entity culling " << (se_masterRenderer.isEntityCullingEnabled() ? "enabled" : "disabled"));
+	}
+
+	else if (e->getKey() == se_KEY_T) {
+		world.setThreadedSimulation(!world.isSimulationThreaded());
+		se_log("Threaded simulation " << (world.isSimulationThreaded() ? "enabled" : "disabled"));
+	}
+
 	e->setHandled();
 }
 
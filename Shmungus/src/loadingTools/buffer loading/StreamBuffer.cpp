@@ -0,0 +1,161 @@
+#include <sepch.h>
+#include "StreamBuffer.h"
+
+void StreamBuffer::init(GLsizeiptr size, bool allowPersistentMapping) {
+
+	regionSize = (size + STREAM_BUFFER_ALIGNMENT - 1) & ~(STREAM_BUFFER_ALIGNMENT - 1);
+	GLsizeiptr totalSize = regionSize * STREAM_BUFFER_REGION_AMOUNT;
+
+	glGenBuffers(1, &bufferID);
+	glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+
+	//glBufferStorage is only loaded on GL 4.4 and up, glad is generated without extensions so ARB_buffer_storage is never used
+	if (allowPersistentMapping && glBufferStorage != nullptr) {
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_COPY_READ_BUFFER, totalSize, nullptr, flags);
+		mappedData = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, totalSize, flags);
+
+		if (mappedData == nullptr) {
+			se_log("Persistent mapping of stream buffer failed, falling back to glBufferSubData");
+
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDeleteBuffers(1, &bufferID); //Storage is immutable, the fallback needs a fresh buffer
+			glGenBuffers(1, &bufferID);
+			glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+		}
+	}
+
+	if (mappedData == nullptr) {
+		glBufferData(GL_COPY_READ_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void StreamBuffer::cleanUp() {
+
+	for (GLsync& fence : regionFences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	if (bufferID != 0) {
+
+		if (mappedData != nullptr) {
+			glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+
+		glDeleteBuffers(1, &bufferID);
+	}
+
+	bufferID = 0;
+	mappedData = nullptr;
+	regionSize = 0;
+	currentRegion = 0;
+	regionWriteOffset = 0;
+	inFrame = false;
+}
+
+void StreamBuffer::beginFrame() {
+
+	currentRegion = (currentRegion + 1) % STREAM_BUFFER_REGION_AMOUNT;
+	regionWriteOffset = 0;
+
+	waitForRegion(currentRegion);
+	inFrame = true;
+}
+
+void StreamBuffer::endFrame() {
+
+	inFrame = false;
+
+	if (bufferID == 0 || regionWriteOffset == 0) {
+		return; //Nothing read from this region, no fence needed
+	}
+
+	regionFences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLintptr StreamBuffer::write(const void* data, GLsizeiptr size) {
+
+	GLintptr offset = reserve(size);
+
+	if (offset >= 0) {
+		writeAt(offset, data, size);
+	}
+
+	return offset;
+}
+
+GLintptr StreamBuffer::reserve(GLsizeiptr size) {
+
+	GLsizeiptr alignedSize = (size + STREAM_BUFFER_ALIGNMENT - 1) & ~(STREAM_BUFFER_ALIGNMENT - 1);
+
+	if (!inFrame || bufferID == 0 || regionWriteOffset + alignedSize > regionSize) {
+		return -1;
+	}
+
+	GLintptr offset = currentRegion * regionSize + regionWriteOffset;
+	regionWriteOffset += alignedSize;
+
+	return offset;
+}
+
+void StreamBuffer::writeAt(GLintptr offset, const void* data, GLsizeiptr size) {
+
+	if (mappedData != nullptr) {
+		std::memcpy(mappedData + offset, data, size); //Coherent mapping, visible to commands issued after this without a flush
+	}
+	else {
+		glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+		glBufferSubData(GL_COPY_READ_BUFFER, offset, size, data);
+	}
+}
+
+void StreamBuffer::copyToBuffer(GLuint destinationBufferID, GLintptr destinationOffset, const void* data, GLsizeiptr size) {
+
+	GLintptr sourceOffset = write(data, size);
+
+	if (sourceOffset < 0) {
+		//Region is full or this is outside of a frame, bulk uploads like mass spawns go straight to the destination
+		glBindBuffer(GL_COPY_WRITE_BUFFER, destinationBufferID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, destinationOffset, size, data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destinationBufferID);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamBuffer::waitForRegion(GLuint region) {
+
+	GLsync fence = regionFences[region];
+	if (fence == nullptr) {
+		return;
+	}
+
+	//Polling first tells apart a free region from an actual stall
+	GLenum result = glClientWaitSync(fence, 0, 0);
+
+	if (result == GL_TIMEOUT_EXPIRED) {
+		stallAmount++;
+
+		do {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); //1 ms
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fence);
+	regionFences[region] = nullptr;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+const GLuint STREAM_BUFFER_REGION_AMOUNT = 3; //Regions in flight, the CPU writes one while the GPU may still be reading the other two
+const GLsizeiptr STREAM_BUFFER_ALIGNMENT = 16;
+
+/*
+Ring of staging memory for data that changes every frame. The buffer is split in STREAM_BUFFER_REGION_AMOUNT regions, one per frame,
+and every region is guarded by a fence so the CPU never writes memory the GPU has not finished reading. Nothing here ever stalls on the driver
+unless the CPU gets more than STREAM_BUFFER_REGION_AMOUNT frames ahead.
+
+On GL 4.4 and up the buffer is mapped once, persistently and coherently, and writes are plain memcpys.
+Without it writes go through glBufferSubData into the fenced region, which the driver can still do without waiting on the GPU.
+Data is copied from here into its destination buffer with glCopyBufferSubData, so destinations can stay static GPU memory.
+*/
+class StreamBuffer {
+
+public:
+
+	StreamBuffer() {};
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	/// <summary>
+	/// Creates and maps the ring, needs a current GL context
+	/// </summary>
+	/// <param name="size">Bytes that can be written per frame</param>
+	/// <param name="allowPersistentMapping">Pass false to force the glBufferSubData path even if buffer storage is supported</param>
+	void init(GLsizeiptr size, bool allowPersistentMapping = true);
+
+	//Unmaps and deletes the ring and any fences still pending. Needs the context init ran with, the stream buffer usually lives in a static that outlives it
+	void cleanUp();
+
+	//Moves on to the next region, waiting for the GPU only if it is still reading that region from STREAM_BUFFER_REGION_AMOUNT frames ago
+	void beginFrame();
+
+	//Fences the current region after every command that reads from it this frame has been issued
+	void endFrame();
+
+	/// <summary>
+	/// Copies data into the current region
+	/// </summary>
+	/// <returns>Offset of the data in the buffer, or -1 if the region has no room left this frame or no frame is running</returns>
+	GLintptr write(const void* data, GLsizeiptr size);
+
+	/// <summary>
+	/// Claims room in the current region without writing to it, for data that is filled in piece by piece with writeAt
+	/// </summary>
+	/// <returns>Offset of the room in the buffer, or -1 if the region has no room left this frame or no frame is running</returns>
+	GLintptr reserve(GLsizeiptr size);
+
+	//Writes data at an offset inside room claimed with reserve this frame
+	void writeAt(GLintptr offset, const void* data, GLsizeiptr size);
+
+	/// <summary>
+	/// Writes data into the ring and queues a GPU copy of it into another buffer, falls back to glBufferSubData on the destination when the region is full
+	/// </summary>
+	/// <param name="destinationBufferID">Buffer to copy into</param>
+	/// <param name="destinationOffset">Offset in bytes in the destination</param>
+	void copyToBuffer(GLuint destinationBufferID, GLintptr destinationOffset, const void* data, GLsizeiptr size);
+
+	inline GLuint getBufferID() { return bufferID; };
+	inline bool isPersistentlyMapped() { return mappedData != nullptr; };
+	inline GLsizeiptr getRegionSize() { return regionSize; };
+
+	//Times beginFrame had to wait on the GPU since init, nonzero means the ring is too shallow for the frame latency
+	inline GLuint getStallAmount() { return stallAmount; };
+
+private:
+
+	GLuint bufferID = 0;
+	uint8_t* mappedData = nullptr; //Persistent mapping of the whole ring, nullptr on the fallback path
+
+	GLsizeiptr regionSize = 0;
+	GLuint currentRegion = 0;
+	GLsizeiptr regionWriteOffset = 0; //Bytes written to the current region this frame
+	bool inFrame = false; //Writes outside beginFrame / endFrame would not be covered by the region's fence
+
+	GLsync regionFences[STREAM_BUFFER_REGION_AMOUNT] = {};
+	GLuint stallAmount = 0;
+
+	void waitForRegion(GLuint region);
+};
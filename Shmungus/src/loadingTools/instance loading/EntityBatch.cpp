@@ -0,0 +1,285 @@
+#include <sepch.h>
+#include "EntityBatch.h"
+
+#include "EntityVertexArray.h"
+#include "MasterRenderer.h"
+#include "GLStateTracker.h"
+#include "FramePacket.h"
+
+EntityBatch::EntityBatch(ShaderProgram* shader, Shmingo::InstanceLayoutInfo layout, Shmingo::InstanceStorage storage) : shader(shader),
+	instanceLayout(layout), instanceStorage(storage) {
+
+	GLuint instanceBufferAmount = storage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? 1 : (GLuint)layout.attributes.size();
+	instanceVboIDs.resize(instanceBufferAmount, 0);
+	visibleVboIDs.resize(instanceBufferAmount, 0);
+
+	glGenVertexArrays(1, &vaoID);
+	glGenVertexArrays(1, &visibleVaoID);
+	glGenBuffers(1, &indirectVboID);
+
+	for (GLuint vao : { vaoID, visibleVaoID }) {
+
+		se_glState.bindVertexArray(vao);
+
+		//Enables are stored in the VAO, so they are set once here instead of around every draw
+		for (GLuint i = 0; i < 2 + layout.slotAmount; i++) {
+			se_glState.enableVertexAttribArray(i);
+		}
+	}
+
+	se_glState.bindVertexArray(0);
+}
+
+EntityBatch::~EntityBatch() {
+
+	for (GLuint& vboID : instanceVboIDs) {
+		glDeleteBuffers(1, &vboID);
+	}
+
+	glDeleteBuffers((GLsizei)visibleVboIDs.size(), visibleVboIDs.data());
+	glDeleteBuffers(1, &indirectVboID);
+
+	glDeleteVertexArrays(1, &vaoID);
+	glDeleteVertexArrays(1, &visibleVaoID);
+	se_glState.vertexArrayDeleted(vaoID);
+	se_glState.vertexArrayDeleted(visibleVaoID);
+}
+
+bool EntityBatch::isCompatible(ShaderProgram* shader, const Shmingo::InstanceLayoutInfo& layout, Shmingo::InstanceStorage storage) {
+
+	//Layouts come from one static array per InstanceLayout class, the same class means the same attributes at the same locations
+	return this->shader == shader && instanceStorage == storage &&
+		instanceLayout.attributes.data() == layout.attributes.data() && instanceLayout.attributes.size() == layout.attributes.size();
+}
+
+void EntityBatch::addMember(EntityVertexArray* vertexArray, GLuint capacity) {
+	members.emplace_back(vertexArray);
+	layoutInstanceRanges(vertexArray, capacity);
+}
+
+void EntityBatch::removeMember(EntityVertexArray* vertexArray) {
+	members.erase(std::remove(members.begin(), members.end(), vertexArray), members.end());
+	submitted.erase(std::remove(submitted.begin(), submitted.end(), vertexArray), submitted.end());
+
+	layoutInstanceRanges(nullptr, 0); //Compacts the remaining ranges and gives the removed range's memory back
+}
+
+void EntityBatch::resizeMember(EntityVertexArray* vertexArray, GLuint capacity) {
+	layoutInstanceRanges(vertexArray, capacity);
+}
+
+void EntityBatch::layoutInstanceRanges(EntityVertexArray* resized, GLuint resizedCapacity) {
+
+	std::vector<GLuint> newBaseInstances;
+	GLuint totalCapacity = 0;
+
+	for (EntityVertexArray* member : members) {
+		newBaseInstances.emplace_back(totalCapacity);
+		totalCapacity += member == resized ? resizedCapacity : member->getGpuInstanceCapacity();
+	}
+
+	//Both sets of buffers share the layout, each keeps what its members last uploaded to it
+	auto moveRanges = [&](std::vector<GLuint>& vboIDs, bool visible) {
+
+		for (GLuint i = 0; i < vboIDs.size(); i++) {
+
+			GLuint dataSize = getInstanceBufferStride(i);
+			GLuint newVboID = 0;
+
+			glGenBuffers(1, &newVboID);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, newVboID);
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)totalCapacity * dataSize, nullptr, GL_DYNAMIC_DRAW);
+
+			//Carry every member's instances over on the GPU, no CPU round trip
+			if (vboIDs[i] != 0) {
+
+				glBindBuffer(GL_COPY_READ_BUFFER, vboIDs[i]);
+
+				for (GLuint j = 0; j < members.size(); j++) {
+
+					GLuint capacity = members[j] == resized ? resizedCapacity : members[j]->getGpuInstanceCapacity();
+					GLuint keptInstances = std::min(visible ? members[j]->getGpuVisibleAmount() : members[j]->getGpuInstanceAmount(), capacity);
+
+					if (keptInstances > 0) {
+						glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)members[j]->getBaseInstance() * dataSize,
+							(GLintptr)newBaseInstances[j] * dataSize, (GLsizeiptr)keptInstances * dataSize);
+					}
+				}
+
+				glDeleteBuffers(1, &vboIDs[i]);
+			}
+
+			vboIDs[i] = newVboID;
+		}
+	};
+
+	moveRanges(instanceVboIDs, false);
+	moveRanges(visibleVboIDs, true);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	for (GLuint i = 0; i < members.size(); i++) {
+		members[i]->setBaseInstance(newBaseInstances[i]);
+	}
+	instanceCapacity = totalCapacity;
+
+	//Repoint the VAOs at the new buffers
+	se_glState.bindVertexArray(vaoID);
+	for (GLuint i = 0; i < instanceVboIDs.size(); i++) {
+		setInstanceAttributePointers(i, instanceVboIDs[i], 0);
+	}
+
+	se_glState.bindVertexArray(visibleVaoID);
+	for (GLuint i = 0; i < visibleVboIDs.size(); i++) {
+		setInstanceAttributePointers(i, visibleVboIDs[i], 0);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	se_glState.bindVertexArray(0);
+}
+
+bool EntityBatch::submit(EntityVertexArray* vertexArray) {
+	submitted.emplace_back(vertexArray);
+	return submitted.size() == 1;
+}
+
+bool EntityBatch::isDrawingVisible() {
+	return !submitted.empty() && submitted[0]->getFrameDraw().culled; //Culling is a per frame setting, every member of a frame is recorded the same way
+}
+
+void EntityBatch::draw() {
+
+	indirectCommands.clear();
+
+	bool drawingVisible = isDrawingVisible();
+
+	for (EntityVertexArray* member : submitted) {
+
+		//Without culling every instance is drawn at full detail straight from the member's range
+		if (!drawingVisible) {
+			const Shmingo::MeshRange& mesh = member->getMeshRange();
+			indirectCommands.emplace_back(Shmingo::DrawElementsIndirectCommand(mesh.indexCount, member->getFrameDraw().instanceAmount, mesh.firstIndex, mesh.baseVertex,
+				member->getBaseInstance()));
+			continue;
+		}
+
+		//Culled members draw the visible instances at the front of their range, one command per level of detail since each level is its own mesh
+		GLuint baseInstance = member->getBaseInstance();
+
+		for (GLuint level = 0; level < member->getLodAmount(); level++) {
+
+			GLuint instanceCount = member->getFrameDraw().lodInstanceAmounts[level];
+			if (instanceCount == 0) {
+				continue;
+			}
+
+			const Shmingo::MeshRange& mesh = member->getLodMeshRange(level);
+			indirectCommands.emplace_back(Shmingo::DrawElementsIndirectCommand(mesh.indexCount, instanceCount, mesh.firstIndex, mesh.baseVertex, baseInstance));
+
+			baseInstance += instanceCount;
+		}
+	}
+
+	if (indirectCommands.empty()) {
+		return;
+	}
+
+	GLsizeiptr commandsSize = (GLsizeiptr)(indirectCommands.size() * sizeof(Shmingo::DrawElementsIndirectCommand));
+
+	//Commands go through the per frame ring like instance data, the batch's own buffer is only a fallback for when the ring is full
+	StreamBuffer& streamBuffer = se_masterRenderer.getInstanceStreamBuffer();
+	GLintptr commandsOffset = streamBuffer.write(indirectCommands.data(), commandsSize);
+
+	if (commandsOffset >= 0) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, streamBuffer.getBufferID());
+	}
+	else {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectVboID);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commandsSize, indirectCommands.data(), GL_STREAM_DRAW);
+		commandsOffset = 0;
+	}
+
+	if (drawingVisible) {
+		bindMeshVao(visibleVaoID, visibleMeshGeneration);
+	}
+	else {
+		bindVao();
+	}
+
+	//Every member samples the registry's arrays, instances carry their own texture handle
+	se_masterRenderer.getTextureRegistry().bind();
+
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commandsOffset, (GLsizei)indirectCommands.size(), 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void EntityBatch::bindVao() {
+	bindMeshVao(vaoID, meshGeneration);
+}
+
+void EntityBatch::bindMeshVao(GLuint vao, GLuint& generation) {
+
+	se_glState.bindVertexArray(vao);
+
+	EntityMeshPool& meshPool = se_masterRenderer.getEntityMeshPool();
+
+	if (generation != meshPool.getGeneration() && meshPool.getPositionsVboID() != 0) {
+		setMeshAttributePointers();
+		generation = meshPool.getGeneration();
+	}
+}
+
+GLuint EntityBatch::getInstanceBufferStride(GLuint bufferIndex) {
+	return instanceStorage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? instanceLayout.stride : instanceLayout.attributes[bufferIndex].size;
+}
+
+void EntityBatch::setMeshAttributePointers() {
+
+	EntityMeshPool& meshPool = se_masterRenderer.getEntityMeshPool();
+
+	glBindBuffer(GL_ARRAY_BUFFER, meshPool.getPositionsVboID());
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+
+	glBindBuffer(GL_ARRAY_BUFFER, meshPool.getTexCoordsVboID());
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshPool.getIndicesVboID()); //Captured by the bound VAO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void EntityBatch::setInstanceAttributePointers(GLuint bufferIndex, GLuint vboID, GLintptr baseOffset) {
+
+	GLuint stride = getInstanceBufferStride(bufferIndex);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vboID); //Attrib pointers capture the buffer bound here
+
+	for (GLuint i = 0; i < instanceLayout.attributes.size(); i++) {
+
+		if (instanceStorage != Shmingo::INTERLEAVED_INSTANCE_BUFFER && i != bufferIndex) {
+			continue;
+		}
+
+		const Shmingo::EntitySpecificInstanceDataInfo& currentAttributeInfo = instanceLayout.attributes[i];
+
+		GLuint firstAttribNumber = 2 + currentAttributeInfo.attributeNumber;
+		GLuint slotSize = currentAttributeInfo.size / currentAttributeInfo.slotAmount; //A mat4 is split into 4 vec4 slots
+		GLuint attributeOffset = instanceStorage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? currentAttributeInfo.localOffset : 0; //Position of the attribute inside a record
+
+		for (GLuint j = 0; j < currentAttributeInfo.slotAmount; j++) {
+
+			GLuint currentAttribNumber = firstAttribNumber + j;
+			void* offset = (void*)(size_t)(baseOffset + attributeOffset + slotSize * j);
+
+			if (currentAttributeInfo.integer) {
+				glVertexAttribIPointer(currentAttribNumber, currentAttributeInfo.componentAmount, currentAttributeInfo.componentType, stride, offset);
+			}
+			else {
+				glVertexAttribPointer(currentAttribNumber, currentAttributeInfo.componentAmount, currentAttributeInfo.componentType,
+					currentAttributeInfo.normalized ? GL_TRUE : GL_FALSE, stride, offset);
+			}
+			glVertexAttribDivisor(currentAttribNumber, 1); //Sets vertex attribute divisor to once per instance, offset by each command's baseInstance
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+class EntityVertexArray;
+class ShaderProgram;
+
+namespace Shmingo {
+
+	struct InstanceFlushStats;
+
+	//Record layout glMultiDrawElementsIndirect reads from the indirect buffer
+	struct DrawElementsIndirectCommand {
+
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+}
+
+/*
+Every entity vertex array that draws with the same shader, instance layout and instance storage.
+Meshes come from the renderer's mesh pool and instances from instance buffers shared by all members, each member owns a contiguous range of instances.
+Instance attributes have a divisor, so baseInstance in a draw command picks the member's range and the whole batch draws with one glMultiDrawElementsIndirect.
+Textures come from the renderer's texture registry, which every member shares.
+With culling, only the instances that passed the cull are drawn, from a second set of buffers laid out like the first one through a second VAO.
+Each member keeps its visible instances packed to the front of its range there, grouped by level of detail with one draw command per level,
+and only sends the ones that changed since they stay there across frames.
+Instance amounts, levels and uploads are read from the members' frame draws, the batch never looks at the simulation side of a vertex array.
+*/
+class EntityBatch {
+
+public:
+
+	EntityBatch(ShaderProgram* shader, Shmingo::InstanceLayoutInfo layout, Shmingo::InstanceStorage storage);
+	~EntityBatch();
+
+	EntityBatch(const EntityBatch&) = delete;
+	EntityBatch& operator=(const EntityBatch&) = delete;
+
+	//Whether entities with this draw state can be drawn by this batch
+	bool isCompatible(ShaderProgram* shader, const Shmingo::InstanceLayoutInfo& layout, Shmingo::InstanceStorage storage);
+
+
+	//Instance ranges -----------------------------------------------------------
+	/// <summary>
+	/// Gives a vertex array a range of capacity instances in the shared instance buffers
+	/// </summary>
+	void addMember(EntityVertexArray* vertexArray, GLuint capacity);
+
+	//Drops a vertex array and packs the remaining ranges together
+	void removeMember(EntityVertexArray* vertexArray);
+
+	/// <summary>
+	/// Changes the capacity of a member's range. Every range is laid out again and live and visible instances are copied over on the GPU
+	/// </summary>
+	void resizeMember(EntityVertexArray* vertexArray, GLuint capacity);
+
+
+	//Drawing -------------------------------------------------------------------
+	/// <summary>
+	/// Queues a member for this frame's draw
+	/// </summary>
+	/// <returns>True if it is the first member queued this frame, meaning the batch itself still has to be put in the draw list</returns>
+	bool submit(EntityVertexArray* vertexArray);
+
+	inline const std::vector<EntityVertexArray*>& getSubmitted() { return submitted; };
+
+	//Whether this frame's members were recorded culled, and draw their visible instances from the visible buffers
+	bool isDrawingVisible();
+
+	inline void clearSubmitted() { submitted.clear(); };
+
+	//Draws every submitted member with one multi draw. The shader must be started
+	void draw();
+
+	//Binds the VAO, re-pointing it at the mesh pool first if the pool moved to new buffers
+	void bindVao();
+
+
+	//Getters ------------------------------------------------------------------
+	inline GLuint getVaoID() { return vaoID; };
+	inline ShaderProgram* getShader() { return shader; };
+	inline GLuint getInstanceBufferID(GLuint bufferIndex) { return instanceVboIDs[bufferIndex]; };
+	inline GLuint getVisibleBufferID(GLuint bufferIndex) { return visibleVboIDs[bufferIndex]; };
+	inline GLuint getInstanceCapacity() { return instanceCapacity; };
+	inline GLuint getMemberAmount() { return (GLuint)members.size(); };
+
+private:
+
+	ShaderProgram* shader;
+	Shmingo::InstanceLayoutInfo instanceLayout;
+	Shmingo::InstanceStorage instanceStorage;
+
+	GLuint vaoID = 0;
+	GLuint indirectVboID = 0; //Only used when the renderer's stream buffer has no room left for the frame's commands
+	GLuint meshGeneration = 0xFFFFFFFF; //Mesh pool generation the VAO points at
+
+	GLuint visibleVaoID = 0; //Reads instances from the visible buffers
+	GLuint visibleMeshGeneration = 0xFFFFFFFF;
+
+	std::vector<GLuint> instanceVboIDs; //One per attribute, or a single one for interleaved storage
+	std::vector<GLuint> visibleVboIDs; //Same layout, each member's visible instances at the front of its range
+	GLuint instanceCapacity = 0; //Sum of every member's capacity
+
+	std::vector<EntityVertexArray*> members; //In instance buffer order
+	std::vector<EntityVertexArray*> submitted;
+
+	std::vector<Shmingo::DrawElementsIndirectCommand> indirectCommands;
+
+	/// <summary>
+	/// Packs the members' ranges back to back into new instance and visible buffers, keeping every member's live and visible instances
+	/// </summary>
+	/// <param name="resized">Member whose capacity changes, or nullptr</param>
+	/// <param name="resizedCapacity">Its new capacity</param>
+	void layoutInstanceRanges(EntityVertexArray* resized, GLuint resizedCapacity);
+
+	GLuint getInstanceBufferStride(GLuint bufferIndex);
+
+	//Binds a VAO, pointing it at the mesh pool first if the pool changed since generation
+	void bindMeshVao(GLuint vao, GLuint& generation);
+
+	//Points the mesh attributes and the index buffer at the mesh pool, VAO must be bound
+	void setMeshAttributePointers();
+
+	/// <summary>
+	/// Points the bound VAO's attributes for every per instance attribute stored in a buffer at a VBO
+	/// </summary>
+	/// <param name="bufferIndex">Instance buffer the attributes belong to</param>
+	/// <param name="vboID">Buffer holding the instances</param>
+	/// <param name="baseOffset">Byte offset of the first instance in the buffer</param>
+	void setInstanceAttributePointers(GLuint bufferIndex, GLuint vboID, GLintptr baseOffset);
+};
@@ -0,0 +1,95 @@
+#include <sepch.h>
+#include "EntityMeshPool.h"
+
+Shmingo::MeshRange EntityMeshPool::registerModel(const std::shared_ptr<Model>& model) {
+
+	auto it = meshRanges.find(model.get());
+	if (it != meshRanges.end()) {
+		return it->second;
+	}
+
+	GLuint modelVertexCount = model->getVertexCount();
+	GLuint modelIndexCount = model->getIndexCount();
+
+	reserve(vertexAmount + modelVertexCount, indexAmount + modelIndexCount);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, positionsVboID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexAmount * 3 * sizeof(float), (GLsizeiptr)modelVertexCount * 3 * sizeof(float), model->getPositionData());
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, texCoordsVboID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexAmount * 2 * sizeof(float), (GLsizeiptr)modelVertexCount * 2 * sizeof(float), model->getTextureCoords());
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, eboID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexAmount * sizeof(int), model->getIndicesByteSize(), model->getIndexData());
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	Shmingo::MeshRange range(indexAmount, modelIndexCount, (GLint)vertexAmount, modelVertexCount);
+
+	vertexAmount += modelVertexCount;
+	indexAmount += modelIndexCount;
+
+	meshRanges.emplace(model.get(), range);
+	models.emplace_back(model);
+
+	return range;
+}
+
+void EntityMeshPool::cleanUp() {
+
+	for (GLuint* bufferID : { &positionsVboID, &texCoordsVboID, &eboID }) {
+		if (*bufferID != 0) {
+			glDeleteBuffers(1, bufferID);
+			*bufferID = 0;
+		}
+	}
+
+	vertexAmount = 0;
+	vertexCapacity = 0;
+	indexAmount = 0;
+	indexCapacity = 0;
+	generation++;
+
+	meshRanges.clear();
+	models.clear();
+}
+
+void EntityMeshPool::reserve(GLuint vertexTarget, GLuint indexTarget) {
+
+	if (vertexTarget <= vertexCapacity && indexTarget <= indexCapacity) {
+		return;
+	}
+
+	GLuint newVertexCapacity = std::max({ vertexTarget, vertexCapacity * 2, ENTITY_MESH_POOL_INITIAL_VERTICES });
+	GLuint newIndexCapacity = std::max({ indexTarget, indexCapacity * 2, ENTITY_MESH_POOL_INITIAL_INDICES });
+
+	growBuffer(positionsVboID, (GLsizeiptr)vertexAmount * 3 * sizeof(float), (GLsizeiptr)newVertexCapacity * 3 * sizeof(float));
+	growBuffer(texCoordsVboID, (GLsizeiptr)vertexAmount * 2 * sizeof(float), (GLsizeiptr)newVertexCapacity * 2 * sizeof(float));
+	growBuffer(eboID, (GLsizeiptr)indexAmount * sizeof(int), (GLsizeiptr)newIndexCapacity * sizeof(int));
+
+	vertexCapacity = newVertexCapacity;
+	indexCapacity = newIndexCapacity;
+
+	generation++;
+}
+
+void EntityMeshPool::growBuffer(GLuint& bufferID, GLsizeiptr usedSize, GLsizeiptr newSize) {
+
+	GLuint newBufferID = 0;
+
+	glGenBuffers(1, &newBufferID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+	if (bufferID != 0) {
+		if (usedSize > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &bufferID);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	bufferID = newBufferID;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+#include "Model.h"
+
+const GLuint ENTITY_MESH_POOL_INITIAL_VERTICES = 16384;
+const GLuint ENTITY_MESH_POOL_INITIAL_INDICES = 49152;
+
+namespace Shmingo {
+
+	//Where a model's vertices and indices live in the mesh pool, in the units glMultiDrawElementsIndirect's commands use
+	struct MeshRange {
+
+		GLuint firstIndex = 0;
+		GLuint indexCount = 0;
+		GLint baseVertex = 0;
+		GLuint vertexCount = 0;
+	};
+}
+
+/*
+Shared vertex and index buffers holding every entity model, so every entity type can be drawn out of the same buffers.
+Models are appended once and stay for the lifetime of the pool. Indices are stored as the model has them, baseVertex moves them onto the model's vertices.
+Growing moves everything to bigger buffers and bumps the generation, VAOs reading from the pool re-point their attributes when it changes.
+*/
+class EntityMeshPool {
+
+public:
+
+	EntityMeshPool() {};
+
+	EntityMeshPool(const EntityMeshPool&) = delete;
+	EntityMeshPool& operator=(const EntityMeshPool&) = delete;
+
+	/// <summary>
+	/// Uploads a model into the pool, a model that is already in the pool is not uploaded again
+	/// </summary>
+	/// <returns>Range of the model in the pool</returns>
+	Shmingo::MeshRange registerModel(const std::shared_ptr<Model>& model);
+
+	//Deletes the buffers and forgets every model. Needs the context the models were registered with, the pool lives in a static that outlives it
+	void cleanUp();
+
+	inline GLuint getPositionsVboID() { return positionsVboID; };
+	inline GLuint getTexCoordsVboID() { return texCoordsVboID; };
+	inline GLuint getIndicesVboID() { return eboID; };
+
+	//Changes every time the buffers are replaced
+	inline GLuint getGeneration() { return generation; };
+
+	inline GLuint getVertexAmount() { return vertexAmount; };
+	inline GLuint getIndexAmount() { return indexAmount; };
+
+private:
+
+	GLuint positionsVboID = 0;
+	GLuint texCoordsVboID = 0;
+	GLuint eboID = 0;
+
+	GLuint vertexAmount = 0;
+	GLuint vertexCapacity = 0;
+	GLuint indexAmount = 0;
+	GLuint indexCapacity = 0;
+
+	GLuint generation = 0;
+
+	std::unordered_map<Model*, Shmingo::MeshRange> meshRanges;
+	std::vector<std::shared_ptr<Model>> models; //Keeps registered models alive so their addresses are never reused by another model
+
+	//Moves the pool into buffers with room for at least the given amounts, doubling so repeated registrations stay cheap
+	void reserve(GLuint vertexTarget, GLuint indexTarget);
+
+	//Replaces a buffer by a bigger one holding the same first usedSize bytes
+	void growBuffer(GLuint& bufferID, GLsizeiptr usedSize, GLsizeiptr newSize);
+};
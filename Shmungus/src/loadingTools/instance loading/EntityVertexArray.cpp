@@ -1,209 +1,301 @@
 #include <sepch.h>
 #include "EntityVertexArray.h"
 #include "MasterRenderer.h"
+#include "GLStateTracker.h"
+#include "FramePacket.h"
+#include "JobSystem.h"
 
 
-EntityVertexArray::EntityVertexArray(Shmingo::EntityType type, std::shared_ptr<Model> model) : instanceModel(model), entityType(type),
-	perInstanceAttributeInfo(se_masterRenderer.getEntitySpecificInstanceAttributeInfoRef(type)){
+EntityVertexArray::EntityVertexArray(Shmingo::EntityType type, std::shared_ptr<Model> model) :
+	EntityVertexArray(type, model, se_masterRenderer.getEntityInstanceStorage(type)) {}
 
-	linkTexture(model->getTexture(), 0); //Links the texture to the VAO
+EntityVertexArray::EntityVertexArray(Shmingo::EntityType type, std::shared_ptr<Model> model, Shmingo::InstanceStorage storage) : entityType(type), instanceModel(model),
+	instanceLayout(se_masterRenderer.getEntityInstanceLayout(type)), instanceStorage(storage){
 
-	GLuint perInstanceAttributeAmount = se_masterRenderer.getEntitySpecificMajorInstanceAttribAmount(type); //Set total number of uniforms to be bound and unbound in the render method
-	attribAmount = 2 + perInstanceAttributeAmount; //Set total number of attributes to be bound and unbound in the render method
+	//Models shared between types are only simplified once. Nothing here touches GL, so vertex arrays can be created by the simulation thread
+	lodModels = se_masterRenderer.getModelLodChain(model);
+	for (GLuint level = 0; level < lodModels.size(); level++) {
+		lodDistances.emplace_back(level == 0 ? 0.0f : getCullingRadius() * ENTITY_LOD_DISTANCE * (float)(1 << (level - 1)));
+	}
+
+	dirtyInstances = std::make_unique<Shmingo::AtomicBitset[]>(getInstanceBufferAmount());
+	for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
+		dirtyInstances[i].resize(instanceCapacity);
+	}
+}
 
-	GLuint modelVertexCount = model->getVertexCount();
+EntityVertexArray::~EntityVertexArray() {
+	if (batch) {
+		batch->removeMember(this);
+	}
+}
 
-	glGenVertexArrays(1, &vaoID); //Creates VAO using member variable
+void EntityVertexArray::reserveInstances(GLuint capacity) {
+
+	if (capacity <= instanceCapacity) {
+		return;
+	}
 
-	glGenBuffers(1, &vertexPositionsVboID); //Generates a vertex buffer for positions
-	glGenBuffers(1, &texCoordsVboID); //Generates a vertex buffer for texCoords
-	glGenBuffers(1, &eboID); //Generates a vertex buffer for indices
+	reallocateInstanceBuffers(capacity);
+}
 
-	glBindVertexArray(vaoID); //Bind VAO
+void EntityVertexArray::growInstanceCapacity(GLuint amount) {
 
-	glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsVboID);
-	glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(float) * modelVertexCount, model->getPositionData(), GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+	if (amount > instanceCapacity) {
+		reallocateInstanceBuffers(std::max(amount, instanceCapacity * 2));
+	}
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, texCoordsVboID);
-	glBufferData(GL_ARRAY_BUFFER, 2 * sizeof(float) * modelVertexCount, model->getTextureCoords(), GL_STATIC_DRAW);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+void EntityVertexArray::setCapacityHint(GLuint hint) {
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, model->getIndexCount() * sizeof(int), model->getIndexData(), GL_STATIC_DRAW);
+	capacityHint = std::max(hint, ENTITY_INSTANCE_INITIAL_CAPACITY);
+	reserveInstances(capacityHint);
+}
 
-	//Set attributes for per instance data
-	for (GLuint i = 0; i < perInstanceAttributeAmount; i++) {
-		perInstanceVboIDs.emplace_back(0); //Adds 0 to vbo ids
+void EntityVertexArray::shrinkIfIdle() {
 
-		Shmingo::EntitySpecificInstanceDataInfo currentAttributeInfo = perInstanceAttributeInfo[i];
+	GLuint targetCapacity = std::max(instanceAmount * 2, capacityHint); //Leaves room to grow again without reallocating right away
 
-		GLuint currentAttribNumber = 2 + currentAttributeInfo.attributeNumber;
+	if (instanceAmount * ENTITY_INSTANCE_SHRINK_RATIO > instanceCapacity || targetCapacity >= instanceCapacity) {
+		idleFrames = 0;
+		return;
+	}
 
-		GLuint adjustedAttribSize = currentAttributeInfo.size;
-		if (currentAttributeInfo.size > 4) { //Done in case we have a size greater than 4, in which case we need to adjust the size to 4 to correctly set the stride
-			adjustedAttribSize = 4;
-		}
+	if (++idleFrames < ENTITY_INSTANCE_SHRINK_DELAY) {
+		return;
+	}
 
-		perInstanceVboIDs[i] = 0;
-		glGenBuffers(1, &perInstanceVboIDs[i]); //Generates a vertex buffer for instanced attributes
-		glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[i]); //Bind vertex buffer
-		glBufferData(GL_ARRAY_BUFFER, 1000 * sizeof(float) * currentAttributeInfo.size, nullptr, GL_DYNAMIC_DRAW); //Sets buffer data arguments for vertex buffer, allocates space for 1000 entities, will have to change
+	reallocateInstanceBuffers(targetCapacity);
+	idleFrames = 0;
+}
 
-		glVertexAttribPointer(currentAttribNumber, adjustedAttribSize, GL_FLOAT, GL_FALSE, currentAttributeInfo.size * sizeof(float), (void*)0);
-		glVertexAttribDivisor(currentAttribNumber, 1); //Sets vertex attribute divisor to once per instance
+void EntityVertexArray::reallocateInstanceBuffers(GLuint capacity) {
 
-		if (currentAttributeInfo.size > 4) {
+	for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
+		dirtyInstances[i].resize(capacity);
+	}
 
-			GLuint fullSizeAttribs = currentAttributeInfo.size / 4;
-			GLuint remainderAttribSize = currentAttributeInfo.size % 4;
+	instanceCapacity = capacity;
+}
 
-			for (GLuint j = 1; j < fullSizeAttribs; j++) {
+void EntityVertexArray::uploadInstanceData(GLuint offset, GLuint bufferIndex, const void* data, GLuint instanceCount){
 
+	GLuint dataSize = getInstanceBufferStride(bufferIndex);
 
-				glVertexAttribPointer(currentAttribNumber + j, 4, GL_FLOAT, GL_FALSE, currentAttributeInfo.size * sizeof(float), (void*)((sizeof(float) * (4 * j)))); //Set attrib pointer with correct offset and size 4
-				glVertexAttribDivisor(currentAttribNumber + j, 1); //Sets vertex attribute divisor to once per vertex
-			}
+	//Staged through the renderer's ring so the VBO is only ever written by the GPU, the driver never has to wait on draws still reading it
+	se_masterRenderer.getInstanceStreamBuffer().copyToBuffer(batch->getInstanceBufferID(bufferIndex),
+		((GLintptr)baseInstance + offset) * dataSize, data, (GLsizeiptr)instanceCount * dataSize);
+}
 
-			if (remainderAttribSize != 0) {
-				glVertexAttribPointer(currentAttribNumber + fullSizeAttribs, currentAttributeInfo.size * sizeof(float), GL_FLOAT, GL_FALSE,
-					currentAttributeInfo.size * sizeof(float), (void*)(sizeof(float) * (4 * fullSizeAttribs)));
-				glVertexAttribDivisor(currentAttribNumber + fullSizeAttribs, 1); //Sets vertex attribute divisor to once per vertex
-			}
-		}
-		unbindBuffer();
+void EntityVertexArray::markInstancesDirty(GLuint begin, GLuint end) {
+	for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
+		dirtyInstances[i].setRange(begin, end);
 	}
+}
+
+void EntityVertexArray::resendInstances() {
+	markInstancesDirty(0, instanceAmount);
+	recordedCulled = false; //The visible list is sent whole with the next culled frame
+}
+
+Shmingo::InstanceFlushStats EntityVertexArray::flushInstanceData() {
+
+	Shmingo::FramePacket packet;
+	recordFrame(packet, false);
+	beginFrameDraw(packet, packet.entityDraws.back());
+
+	Shmingo::InstanceFlushStats stats = uploadFrameInstances();
+	frameDraw = nullptr; //The packet dies here
+	framePacket = nullptr;
 
-	glBindVertexArray(0); //Unbind vertex buffer 
+	return stats;
 }
 
-//For shared pointer (unused)
-void EntityVertexArray::submitInstanceData(std::shared_ptr<InstancedEntity> instancedEntity) {
+void EntityVertexArray::recordFrame(Shmingo::FramePacket& packet, bool culled) {
 
-	const GLuint perInstanceInstanceAttribAmt = se_masterRenderer.getEntitySpecificMajorInstanceAttribAmount(entityType);
+	Shmingo::EntityDrawPacket& draw = packet.entityDraws.emplace_back();
+	draw.vertexArray = shared_from_this();
+	draw.instanceAmount = instanceAmount;
+	draw.instanceCapacity = instanceCapacity;
+	draw.culled = culled;
+	draw.firstUpload = (GLuint)packet.instanceUploads.size();
 
-	instancedEntity->setOffsetInVao(instanceAmount);
-	bindVao();
+	if (culled) {
+		draw.visibleAmount = (GLuint)visibleInstances.size();
+		draw.lodInstanceAmounts = lodInstanceAmounts;
 
-	for (GLuint i = 0; i < perInstanceInstanceAttribAmt; i++) {
+		//The batch keeps the visible instances sent for the last culled frame. A list the cull changed is sent whole, an unchanged one only where its instances
+		//are dirty. Dirty instances out of view are dropped, coming into view changes the list and gathers them
+		if (!recordedCulled || visibleInstances != recordedVisibleInstances) {
 
-		float* instancedData = instancedEntity->getInstanceData(i);
+			for (GLuint i = 0; i < getInstanceBufferAmount() && draw.visibleAmount > 0; i++) {
+				recordVisibleRange(packet, i, 0, draw.visibleAmount);
+			}
+			recordedVisibleInstances = visibleInstances;
+		}
+		else {
+			recordDirtyVisibleInstances(packet);
+		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[i]); //Bind vertex buffer
-		glBufferSubData(GL_ARRAY_BUFFER, instancedEntity->getOffsetInVao() * perInstanceAttributeInfo[i].size * sizeof(float),
-			perInstanceAttributeInfo[i].size * sizeof(float), instancedData); //Sets buffer data arguments for vertex buffer	
+		for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
+			dirtyInstances[i].consumeRanges(0, 0, [](GLuint, GLuint) {});
+		}
+	}
+	else {
+		if (recordedCulled) {
+			markInstancesDirty(0, instanceAmount); //The range missed every change made while culled
+		}
+		recordDirtyInstances(packet);
 	}
 
-	instanceAmount += 1;
-	indexCount += instanceModel->getIndexCount();
+	recordedCulled = culled;
+	draw.uploadAmount = (GLuint)packet.instanceUploads.size() - draw.firstUpload;
 }
 
+void EntityVertexArray::recordVisibleRange(Shmingo::FramePacket& packet, GLuint bufferIndex, GLuint begin, GLuint end) {
 
-//For raw pointers
-void EntityVertexArray::submitInstanceData(InstancedEntity* instancedEntity) {
+	GLuint dataSize = getInstanceBufferStride(bufferIndex);
+	size_t dataOffset = packet.allocateInstanceData((size_t)(end - begin) * dataSize);
+	uint8_t* destination = packet.instanceData.data() + dataOffset;
 
-	const GLuint perInstanceInstanceAttribAmt = se_masterRenderer.getEntitySpecificMajorInstanceAttribAmount(entityType);
+	se_jobSystem.parallelFor(end - begin, ENTITY_VISIBLE_GATHER_GRAIN, [&](GLuint rangeBegin, GLuint rangeEnd, GLuint) {
+		for (GLuint k = rangeBegin; k < rangeEnd; k++) {
+			std::memcpy(destination + (size_t)k * dataSize, getMirroredInstance(visibleInstances[begin + k], bufferIndex), dataSize);
+		}
+	});
 
-	instancedEntity->setOffsetInVao(instanceAmount);
+	packet.instanceUploads.emplace_back(Shmingo::InstanceUpload(bufferIndex, begin, end - begin, dataOffset));
+}
 
-	bindVao();
+void EntityVertexArray::recordDirtyVisibleInstances(Shmingo::FramePacket& packet) {
 
+	GLuint visibleAmount = (GLuint)visibleInstances.size();
 
-	for (GLuint i = 0; i < perInstanceInstanceAttribAmt; i++) {
+	for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
 
-		float* instancedData = instancedEntity->getInstanceData(i);
-		GLuint size = perInstanceAttributeInfo[i].size;
+		if (!dirtyInstances[i].any()) {
+			continue;
+		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[i]); //Bind vertex buffer
-		glBufferSubData(GL_ARRAY_BUFFER, instancedEntity->getOffsetInVao() * perInstanceAttributeInfo[i].size * sizeof(float),
-			perInstanceAttributeInfo[i].size * sizeof(float), instancedData); //Sets buffer data arguments for vertex buffer	
-	}
-	glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[0]); //Unbind vertex buffer
+		bool open = false;
+		GLuint runBegin = 0;
+		GLuint runEnd = 0;
 
-	instanceAmount += 1;
-	indexCount += instanceModel->getIndexCount();
-}
+		//Runs are positions in the visible list, that is where the batch keeps them
+		for (GLuint k = 0; k < visibleAmount; k++) {
 
+			if (!dirtyInstances[i].test(visibleInstances[k])) {
+				continue;
+			}
 
+			if (open && k <= runEnd + ENTITY_FLUSH_MERGE_GAP) {
+				runEnd = k + 1;
+				continue;
+			}
 
-void EntityVertexArray::updateInstanceData(InstancedEntity* entity, GLuint attributePositionInArray){
+			if (open) {
+				recordVisibleRange(packet, i, runBegin, runEnd);
+			}
 
-	GLuint dataSize = perInstanceAttributeInfo[attributePositionInArray].size * sizeof(float);
-	GLuint realAttributeNumber = perInstanceAttributeInfo[attributePositionInArray].attributeNumber;
-	GLuint vaoOffset = entity->getOffsetInVao();
+			runBegin = k;
+			runEnd = k + 1;
+			open = true;
+		}
 
-	glBindVertexArray(vaoID); //Bind VAO
-	glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[attributePositionInArray]); //Bind vertex buffer)
-	glBufferSubData(GL_ARRAY_BUFFER, vaoOffset * dataSize, dataSize, entity->getInstanceData(realAttributeNumber)); //Sets buffer data arguments for vertex buffer)
-	glBindBuffer(GL_ARRAY_BUFFER, 0); //Unbind vertex buffer)
-	glBindVertexArray(0); //Unbind VAO
+		if (open) {
+			recordVisibleRange(packet, i, runBegin, runEnd);
+		}
+	}
 }
 
-void EntityVertexArray::removeInstancedData(GLuint offset){
+void EntityVertexArray::recordDirtyInstances(Shmingo::FramePacket& packet) {
 
-	bindVao();
+	for (GLuint i = 0; i < getInstanceBufferAmount(); i++) {
 
-	const GLuint perInstanceInstanceAttribAmt = se_masterRenderer.getEntitySpecificMajorInstanceAttribAmount(entityType); //Get instanced attribute amount
+		GLuint dataSize = getInstanceBufferStride(i);
 
-	//Condition where there is only one entity in the vertex array
-	if (instanceAmount == 1) {
-		for (GLuint i = 0; i < perInstanceInstanceAttribAmt; i++) {
+		//Instances past instanceAmount were removed, their bits are dropped
+		dirtyInstances[i].consumeRanges(instanceAmount, ENTITY_FLUSH_MERGE_GAP, [&](GLuint begin, GLuint end) {
 
-			glDeleteBuffers(1, &perInstanceVboIDs[i]); //Deletes vertex buffers
-		}
+			//The mirror may be split in blocks, a range is copied in as many pieces as it spans blocks
+			while (begin < end) {
+				GLuint contiguousInstances = 0;
+				const void* data = instanceMirror(begin, i, contiguousInstances);
+				GLuint count = std::min(end - begin, contiguousInstances);
 
-		glDeleteVertexArrays(1, &vaoID); //Deletes VAO
+				size_t dataOffset = packet.allocateInstanceData((size_t)count * dataSize);
+				std::memcpy(packet.instanceData.data() + dataOffset, data, (size_t)count * dataSize);
+				packet.instanceUploads.emplace_back(Shmingo::InstanceUpload(i, begin, count, dataOffset));
 
-		return; //Exits function, make sure to delete vertex array class after
+				begin += count;
+			}
+		});
 	}
+}
 
-	//Condition where the entity being removed is the last entity in the vertex array
-	if (offset == instanceAmount - 1) {
+void EntityVertexArray::beginFrameDraw(const Shmingo::FramePacket& packet, const Shmingo::EntityDrawPacket& draw) {
 
-		//No need to do anything
-	}
+	if (!batch) {
 
-	else {
-		//For instance data
-		for (GLuint i = 0; i < perInstanceInstanceAttribAmt; i++) {
+		for (const std::shared_ptr<Model>& level : lodModels) {
+			lodMeshRanges.emplace_back(se_masterRenderer.getEntityMeshPool().registerModel(level));
+		}
+		meshRange = lodMeshRanges[0];
 
-			glBindBuffer(GL_ARRAY_BUFFER, perInstanceVboIDs[i]); //Bind vertex buffer
+		batch = se_masterRenderer.getEntityBatch(entityType, instanceStorage);
+		batch->addMember(this, draw.instanceCapacity);
+		gpuInstanceCapacity = draw.instanceCapacity;
+	}
+	else if (draw.instanceCapacity != gpuInstanceCapacity) {
+		batch->resizeMember(this, draw.instanceCapacity); //Copies the instances uploaded so far over on the GPU
+		gpuInstanceCapacity = draw.instanceCapacity;
+	}
 
-			GLuint dataSize = perInstanceAttributeInfo[i].size * sizeof(float);
+	gpuInstanceAmount = std::min(draw.instanceAmount, gpuInstanceCapacity); //Kept by the next resize, the rows past it no longer belong to live instances
 
-			copyBufferData((instanceAmount-1) * dataSize,
-				offset * dataSize, dataSize); //Copies data from last instance to the instance being removed
-		}
+	if (draw.culled) {
+		gpuVisibleAmount = std::min(draw.visibleAmount, gpuInstanceCapacity);
 	}
-	instanceAmount -= 1; //Decrement instance amount
-	indexCount -= instanceModel->getIndexCount(); //Decrement index count
+
+	framePacket = &packet;
+	frameDraw = &draw;
 }
 
+Shmingo::InstanceFlushStats EntityVertexArray::uploadFrameInstances() {
 
+	Shmingo::InstanceFlushStats stats;
 
-void EntityVertexArray::linkTexture(Texture2D texture, GLuint slot) {
+	for (GLuint i = 0; i < frameDraw->uploadAmount; i++) {
 
-	//Declares the size of the array so we don't have to always loop through 32 slots
-	if ((slot + 1) > maxTextureIndex) {
-		maxTextureIndex = slot + 1;
-	}
+		GLuint bufferIndex = 0;
+		GLuint offset = 0;
+		GLuint instanceCount = 0;
+		const uint8_t* data = getFrameInstanceData(i, bufferIndex, offset, instanceCount);
 
-	//Inserts texture ID into array with index being slot. can be overriden
-	auto it = textureList.begin();
-	textureList.emplace(std::next(it, slot), texture);
-	texture.setVaoLocalSlot(slot);
-	//std::cout << "ID in link: ";
-}
+		GLuint dataSize = getInstanceBufferStride(bufferIndex);
+
+		if (frameDraw->culled) {
+			//Same range of the batch's visible buffers, visible instances are packed to its front in visible list order
+			se_masterRenderer.getInstanceStreamBuffer().copyToBuffer(batch->getVisibleBufferID(bufferIndex),
+				((GLintptr)baseInstance + offset) * dataSize, data, (GLsizeiptr)instanceCount * dataSize);
+		}
+		else {
+			uploadInstanceData(offset, bufferIndex, data, instanceCount);
+		}
 
-void EntityVertexArray::bindTextures() {
-	bindVao();
-	//Loops through all the texture IDs and binds them to their slot according to their index in the array
-	for (int i = 0; i < (int)maxTextureIndex; i++) {
-		textureList.at(i).bind();
+		stats.bytes += instanceCount * dataSize;
+		stats.calls++;
 	}
+
+	return stats;
 }
 
-void EntityVertexArray::copyBufferData(GLuint readOffset, GLuint writeOffset, GLuint size){
+const uint8_t* EntityVertexArray::getFrameInstanceData(GLuint uploadIndex, GLuint& bufferIndex, GLuint& offset, GLuint& instanceCount) {
 
-	glCopyBufferSubData(GL_ARRAY_BUFFER, GL_ARRAY_BUFFER, readOffset, writeOffset, size);
-}
\ No newline at end of file
+	const Shmingo::InstanceUpload& upload = framePacket->instanceUploads[frameDraw->firstUpload + uploadIndex];
+	bufferIndex = upload.bufferIndex;
+	offset = upload.offset;
+	instanceCount = upload.instanceCount;
+
+	return framePacket->instanceData.data() + upload.dataOffset;
+}
@@ -5,16 +5,42 @@
 
 #include "Model.h"
 #include "InstancedEntity.h"
+#include "EntityBatch.h"
+#include "EntityMeshPool.h"
 
-//This class is for when we want to use instancing instead of batching, mostly for entities
-//Templated to entity type for optimizations
+const GLuint ENTITY_INSTANCE_INITIAL_CAPACITY = 1000;
+const GLuint ENTITY_INSTANCE_SHRINK_RATIO = 4; //Buffers are considered oversized once less than 1 / ratio of them is used
+const GLuint ENTITY_INSTANCE_SHRINK_DELAY = 600; //Frames a buffer has to stay oversized before it is shrunk, so spawn waves don't reallocate back and forth
+const GLuint ENTITY_FLUSH_MERGE_GAP = 32; //Dirty runs this close together are uploaded as one, re-sending a few clean instances is cheaper than another call
+const GLuint ENTITY_VISIBLE_GATHER_GRAIN = 4096; //Visible instances copied per job when gathering them into a frame packet
+const GLuint ENTITY_LOD_MAX = 4; //Most levels of detail per entity model, including the full detail one
+const float ENTITY_LOD_DISTANCE = 24.0f; //Distance, in culling radii, at which instances switch to the first simplified level. Each further level starts twice as far
 
-class EntityVertexArray {
+namespace Shmingo {
+	//Amount of instance data uploaded by flushes
+	struct InstanceFlushStats {
+
+		GLuint bytes = 0;
+		GLuint calls = 0;
+	};
+
+	struct FramePacket;
+	struct EntityDrawPacket;
+}
+
+//Per instance data of one entity type. The mesh lives in the renderer's mesh pool and the instances in a range of the shared instance buffers of the type's batch,
+//so entity types with compatible shaders draw together. This class keeps track of which of its instances changed and uploads them into its range.
+//The simulation side (instance amounts, capacity, dirty bits, culling results) is recorded into frame packets, the GPU side only changes while a packet
+//is replayed on the thread owning the GL context, so the two sides can run on different threads
+
+class EntityVertexArray : public std::enable_shared_from_this<EntityVertexArray> {
 
 public:
 
-	//Constructor, sets up all necessary data
+	//Constructor, builds the model's levels of detail. The mesh pool registration and the batch range wait for the first replayed packet. Uses the storage declared for the entity type
 	EntityVertexArray(Shmingo::EntityType entityType, std::shared_ptr<Model> model);
+	EntityVertexArray(Shmingo::EntityType entityType, std::shared_ptr<Model> model, Shmingo::InstanceStorage storage);
+	~EntityVertexArray();
 
 
 
@@ -22,109 +48,204 @@ public:
 
 	//Vertex data functions ---------------------------------------------------
 	/// <summary>
-	/// Submits vertex data for instanced data
-	/// Takes main vertex data from model, and instanced data from entity
-	/// Templated class, so entity instanced data changes based on the templated form of this class
+	/// Uploads per instance data of one instance buffer for a contiguous range of instances
 	/// </summary>
-	/// <typeparam name="E"> Templated entity class, useful for static information</typeparam>
-	/// <param name="entity"> Entity object to upload </param>
-	void submitInstanceData(std::shared_ptr<InstancedEntity> instancedEntity);
-	void submitInstanceData(InstancedEntity* instancedEntity);
+	/// <param name="offset">Index of the first instance to write</param>
+	/// <param name="bufferIndex">Instance buffer to write, see getInstanceBufferIndex. With separate buffers this is the attribute's index in the attrib info array
+	/// (If an entity has attributes mat4, float, pass a 1 to update the float even though a mat4 takes up 4 attributes), interleaved storage only has buffer 0</param>
+	/// <param name="data">Tightly packed data for every instance in the range, getInstanceBufferStride bytes each</param>
+	/// <param name="instanceCount">Amount of instances to write</param>
+	void uploadInstanceData(GLuint offset, GLuint bufferIndex, const void* data, GLuint instanceCount);
+
+	//Sets the amount of drawn instances, data for new instances must be uploaded separately
+	inline void setInstanceAmount(GLuint amount) { instanceAmount = amount; };
 
 	/// <summary>
-	/// Updates the instance data of an entity in the VAO
+	/// Makes sure the instance buffers can hold at least capacity instances, existing instance data is kept
 	/// </summary>
-	/// <param name="entity">Reference to entity</param>
-	/// <param name="attributePositionInArray">Index of the information of an attribute in the attrib info array (If an entity has attributes mat4, float, pass a 1 to 
-	/// update the float even though a mat4 takes up 4 attributes)</param>
-	void updateInstanceData(InstancedEntity* entity, GLuint attributePositionInArray);
+	/// <param name="capacity">Amount of instances</param>
+	void reserveInstances(GLuint capacity);
+
+	//Grows the instance buffers geometrically until amount instances fit, keeps repeated single spawns amortized O(1)
+	void growInstanceCapacity(GLuint amount);
 
 	/// <summary>
-	/// Removes entity data from the VAO and fills its slot with the last entity in the VAO
+	/// Reserves room for an expected amount of instances and keeps at least that much allocated when shrinking
 	/// </summary>
-	/// <param name="offset"></param>
-	void removeInstancedData(GLuint offset);
+	/// <param name="hint">Expected peak amount of instances</param>
+	void setCapacityHint(GLuint hint);
 
+	//Called once per frame, gives memory back once the buffers have been mostly empty for ENTITY_INSTANCE_SHRINK_DELAY frames
+	void shrinkIfIdle();
 
+	/// <summary>
+	/// Returns a pointer to the CPU copy of an instance buffer's data at an instance, and through contiguousInstances how many instances from there on follow it in memory.
+	/// Must match the buffer's layout, a single column for separate buffers and whole records for interleaved storage
+	/// </summary>
+	typedef std::function<const void*(GLuint offset, GLuint bufferIndex, GLuint& contiguousInstances)> InstanceMirror;
 
-	//Getters ------------------------------------------------------------------
-	inline GLuint getVaoID() { return vaoID; };
-	inline GLuint getVertexCount() { return vertexCount; };
-	inline GLuint getIndexCount() { return indexCount; };
-	inline GLuint getInstanceAmount() { return instanceAmount; };
+	//Sets where flushes read dirty instance data from
+	inline void setInstanceMirror(InstanceMirror mirror) { instanceMirror = mirror; };
 
-	inline size_t getAttribAmount() { return attribAmount; };
+	//CPU copy of one instance's data in a buffer
+	inline const void* getMirroredInstance(GLuint offset, GLuint bufferIndex) {
+		GLuint contiguousInstances = 0;
+		return instanceMirror(offset, bufferIndex, contiguousInstances);
+	}
 
+	//Flags an attribute of an instance as changed in the CPU mirror. Thread safe, nothing is sent to the GPU until the next recorded frame or flushInstanceData
+	inline void markInstanceDirty(GLuint offset, GLuint attributePositionInArray) {
+		dirtyInstances[getInstanceBufferIndex(attributePositionInArray)].set(offset);
+	}
 
+	//Flags every attribute of instances [begin, end) as changed. Thread safe
+	void markInstancesDirty(GLuint begin, GLuint end);
 
+	//Simulation side. Forgets what earlier packets carried, the next recorded frame uploads every instance again. For packets dropped without being replayed
+	void resendInstances();
 
-	//Texture related functions ------------------------------------------------
 	/// <summary>
-	/// Links a texture object to a slot
+	/// Uploads every dirty instance from the CPU mirror right away, nearby dirty runs are merged so this usually comes down to a handful of uploads per attribute.
+	/// Records and replays a packet of its own, so only call it from the thread owning the GL context while nothing simulates
 	/// </summary>
-	/// <param name="texture">Texture object to be linked</param>
-	/// <param name="slot">Slot to link texture to</param>
-	void linkTexture(Texture2D texture, GLuint slot);
+	/// <returns>Bytes and upload calls issued</returns>
+	Shmingo::InstanceFlushStats flushInstanceData();
+
+
 
+	//Frame packets ------------------------------------------------------------
 	/// <summary>
-	/// Binds textures : to be called in render method
+	/// Simulation side. Appends this vertex array's draw to a packet, with copies of either its dirty instances or, when culled, its visible instances.
+	/// Culled frames send the whole visible list only when it changed, otherwise just the visible instances that are dirty
 	/// </summary>
-	void bindTextures();
+	/// <param name="culled">Whether the visible list and level of detail amounts from this frame's cull are drawn instead of every instance</param>
+	void recordFrame(Shmingo::FramePacket& packet, bool culled);
 
-	inline Shmingo::EntityType getEntityType() {
-		return entityType;
+	/// <summary>
+	/// Render side. Makes the GPU side match a recorded draw, registering the meshes and joining the batch on the first call and resizing the range when the
+	/// capacity changed, then keeps the draw for uploadFrameInstances and the batch's draw
+	/// </summary>
+	void beginFrameDraw(const Shmingo::FramePacket& packet, const Shmingo::EntityDrawPacket& draw);
+
+	//Render side. Uploads the instances copied into the current frame draw, into the range of the batch's visible buffers for culled draws
+	Shmingo::InstanceFlushStats uploadFrameInstances();
+
+	//Draw being replayed, only valid between beginFrameDraw and the end of the frame
+	inline const Shmingo::EntityDrawPacket& getFrameDraw() { return *frameDraw; };
+
+	//Instance bytes of an upload of the current frame draw. Offset is the first instance written, a position in the visible list for culled draws
+	const uint8_t* getFrameInstanceData(GLuint uploadIndex, GLuint& bufferIndex, GLuint& offset, GLuint& instanceCount);
+
+
+
+	//Getters ------------------------------------------------------------------
+	inline GLuint getVaoID() { return batch->getVaoID(); };
+	inline GLuint getVertexCount() { return meshRange.vertexCount; };
+	inline GLuint getIndexCount() { return meshRange.indexCount; };
+	inline const Shmingo::MeshRange& getMeshRange() { return meshRange; };
+	inline GLuint getInstanceAmount() { return instanceAmount; };
+	inline GLuint getInstanceCapacity() { return instanceCapacity; };
+	inline GLuint getCapacityHint() { return capacityHint; };
+
+	inline EntityBatch& getBatch() { return *batch; };
+
+	//Instances that passed this frame's cull, only these are drawn while culling is enabled
+	inline std::vector<GLuint>& getVisibleInstances() { return visibleInstances; };
+
+	//Radius around an instance's position, at scale 1, that covers the whole model however it is rotated
+	inline float getCullingRadius() { return glm::length(instanceModel->getBoundingCenter()) + instanceModel->getBoundingRadius(); };
+
+	//Levels of detail -----------------------------------------------------------
+	inline GLuint getLodAmount() { return (GLuint)lodDistances.size(); };
+	inline const Shmingo::MeshRange& getLodMeshRange(GLuint level) { return lodMeshRanges[level]; };
+
+	//Distance from the camera, at scale 1, from which a level is used. Level 0 starts at 0
+	inline float getLodDistance(GLuint level) { return lodDistances[level]; };
+
+	//Visible instances drawn at each level this frame. The visible list holds every level's instances back to back, level 0 first
+	inline GLuint* getLodInstanceAmounts() { return lodInstanceAmounts.data(); };
+
+	//First instance of this vertex array's range in the batch's instance buffers
+	inline GLuint getBaseInstance() { return baseInstance; };
+
+	//Size of the range in the batch's instance buffers and how many instances in it hold uploaded data. Render side, may lag behind the simulation by a frame
+	inline GLuint getGpuInstanceCapacity() { return gpuInstanceCapacity; };
+	inline GLuint getGpuInstanceAmount() { return gpuInstanceAmount; };
+
+	//How many instances at the front of the range in the batch's visible buffers hold the last visible instances sent. Render side
+	inline GLuint getGpuVisibleAmount() { return gpuVisibleAmount; };
+
+	//Set by the batch whenever it lays its ranges out again
+	inline void setBaseInstance(GLuint instance) { baseInstance = instance; };
+
+	inline Shmingo::InstanceStorage getInstanceStorage() { return instanceStorage; };
+	inline GLuint getInstanceBufferAmount() { return instanceStorage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? 1 : (GLuint)instanceLayout.attributes.size(); };
+
+	//Buffer an attribute lives in
+	inline GLuint getInstanceBufferIndex(GLuint attributePositionInArray) {
+		return instanceStorage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? 0 : attributePositionInArray;
+	}
+
+	//Bytes per instance in a buffer
+	inline GLuint getInstanceBufferStride(GLuint bufferIndex) {
+		return instanceStorage == Shmingo::INTERLEAVED_INSTANCE_BUFFER ? instanceLayout.stride : instanceLayout.attributes[bufferIndex].size;
 	}
 
 
-	//Debugging functions ----------------------------------------------
-	GLuint* getVaoIDRef() { return &vaoID; };
+
+
+	inline Shmingo::EntityType getEntityType() {
+		return entityType;
+	}
 
 protected:
 
 	Shmingo::EntityType entityType;
 
-	size_t attribAmount = 0;
+	//Render side
+	std::shared_ptr<EntityBatch> batch; //Shared with every other vertex array of the same draw state, kept alive by its members. Null until the first replayed packet
+	Shmingo::MeshRange meshRange; //Full detail level
+	std::vector<Shmingo::MeshRange> lodMeshRanges;
+	GLuint baseInstance = 0;
+	GLuint gpuInstanceCapacity = 0;
+	GLuint gpuInstanceAmount = 0;
+	GLuint gpuVisibleAmount = 0;
 
-	GLuint vaoID = 0; //VAO ID
-	GLuint eboID = 0; //Index Buffer ID
+	const Shmingo::FramePacket* framePacket = nullptr;
+	const Shmingo::EntityDrawPacket* frameDraw = nullptr;
 
-	GLuint vertexPositionsVboID = 0;
-	GLuint texCoordsVboID = 0;
+	//Simulation side
+	std::vector<GLuint> visibleInstances;
+	std::vector<GLuint> recordedVisibleInstances; //Visible list of the last culled frame recorded, what the batch's visible range holds
+	bool recordedCulled = false; //Whether the last recorded frame was culled. Culled frames drop dirty bits the instance range still needs
 
-	std::vector<GLuint> perInstanceVboIDs; //Per instance uniform VBO IDs
-	std::vector<Texture2D> textureList;
+	std::vector<std::shared_ptr<Model>> lodModels; //Registered with the mesh pool on the first replay
+	std::vector<float> lodDistances;
+	std::array<GLuint, ENTITY_LOD_MAX> lodInstanceAmounts = {};
 
-	GLuint vertexCount = 0; //Amount of vertices
 	GLuint instanceAmount = 0;
-	GLuint indexCount = 0; //Amount of indices
-	GLuint maxTextureIndex = 0;
+	GLuint instanceCapacity = ENTITY_INSTANCE_INITIAL_CAPACITY; //Amount of instances the per instance buffers have room for
+	GLuint capacityHint = ENTITY_INSTANCE_INITIAL_CAPACITY; //Capacity never shrinks below this
+	GLuint idleFrames = 0; //Consecutive frames the buffers have been oversized
 
 	std::shared_ptr<Model> instanceModel; //The model that this Vertex Array is based on
-	std::vector<Shmingo::EntitySpecificInstanceDataInfo>& perInstanceAttributeInfo;
+	Shmingo::InstanceLayoutInfo instanceLayout; //Same compile time layout the entity type's archetype stores its columns with
+	Shmingo::InstanceStorage instanceStorage;
+
+	std::unique_ptr<Shmingo::AtomicBitset[]> dirtyInstances; //One bit per instance for each instance buffer, set when the mirror changed since the last flush
+	InstanceMirror instanceMirror;
 
 	//Utility functions --------------------------------------------------------
 
-	inline void bindVao() {
-		glBindVertexArray(vaoID);
-	}
-	inline void bindIndicesVbo(){
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID);
-	}
-	inline void unbindBuffer() {
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-	}
+	//Resizes the dirty bits to a new capacity, the batch moves the range to match once a packet carrying it is replayed
+	void reallocateInstanceBuffers(GLuint capacity);
 
-	/// <summary>
-	/// Copies part of a buffer to another part of the same buffer
-	/// </summary>
-	/// <param name="readOffset">
-	/// Offset where data will be read from
-	/// </param>
-	/// <param name="writeOffset">
-	/// Offset where data will be written to
-	/// </param>
-	/// <param name="size">
-	/// Size of data to be copied in bytes
-	/// </param>
-	void copyBufferData(GLuint readOffset, GLuint writeOffset, GLuint size);
+	//Copies the rows of visible list positions [begin, end) of one buffer into the packet as one upload
+	void recordVisibleRange(Shmingo::FramePacket& packet, GLuint bufferIndex, GLuint begin, GLuint end);
+
+	//Copies the runs of dirty instances in an unchanged visible list into the packet, merged like dirty rows
+	void recordDirtyVisibleInstances(Shmingo::FramePacket& packet);
+
+	//Copies every dirty run into the packet, in as many uploads as the runs span mirror blocks
+	void recordDirtyInstances(Shmingo::FramePacket& packet);
 };
\ No newline at end of file
@@ -3,23 +3,25 @@
 #include "InstancedVertexArray.h"
 #include "MasterRenderer.h"
 #include "TextureTools.h"
+#include "GLStateTracker.h"
 
 
 void InstancedVertexArray::cleanUp(){
 	glDeleteVertexArrays(1, &m_vaoID);
+	se_glState.vertexArrayDeleted(m_vaoID);
 }
 
 void InstancedVertexArray::bindVao(){
-	glBindVertexArray(m_vaoID);
+	se_glState.bindVertexArray(m_vaoID);
 }
 
 TexturedQuadVertexArray::TexturedQuadVertexArray(){
 
 	glGenBuffers(1, &m_vaoID);
-	glBindVertexArray(m_vaoID);
+	se_glState.bindVertexArray(m_vaoID);
 	
 
-	glBindVertexArray(0);
+	se_glState.bindVertexArray(0);
 }
 
 TexturedQuadVertexArrayAtlas::TexturedQuadVertexArrayAtlas(std::shared_ptr<Shmingo::TextureAtlas> textureAtlas) : m_textureAtlas(textureAtlas){
@@ -33,7 +35,7 @@ TexturedQuadVertexArrayAtlas::TexturedQuadVertexArrayAtlas(std::shared_ptr<Shmin
 	glGenBuffers(1, &m_texIDVboID);
 	glGenBuffers(1, &m_eboID);
 
-	glBindVertexArray(m_vaoID);
+	se_glState.bindVertexArray(m_vaoID);
 
 	float positionData[8] = {
 		0,1,
@@ -61,6 +63,10 @@ TexturedQuadVertexArrayAtlas::TexturedQuadVertexArrayAtlas(std::shared_ptr<Shmin
 	glVertexAttribIPointer(3, 1, GL_UNSIGNED_BYTE, 0, (void*)(0)); // texture ID
 	glVertexAttribDivisor(3, 1); //Set vertex attribute divisor to once per instance
 
+	for (GLsizei i = 0; i < getAttribAmt(); i++) {
+		se_glState.enableVertexAttribArray(i);
+	}
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	int indices[6] = { 0, 1, 3, 3, 1, 2 };
@@ -68,7 +74,7 @@ TexturedQuadVertexArrayAtlas::TexturedQuadVertexArrayAtlas(std::shared_ptr<Shmin
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_eboID);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(int), &indices, GL_STATIC_DRAW);
 
-	glBindVertexArray(0);
+	se_glState.bindVertexArray(0);
 }
 
 void TexturedQuadVertexArrayAtlas::init(){
@@ -78,8 +84,6 @@ void TexturedQuadVertexArrayAtlas::init(){
 }
 
 void TexturedQuadVertexArrayAtlas::bindTextures(){
-	glActiveTexture(GL_TEXTURE0);
-
 	GLint textureUniformLocation = glGetUniformLocation(se_masterRenderer.getShader(se_MENU_SHADER)->getProgramID(), "textureAtlas");
 
 	//Texture2D funnyTexture = Shmingo::createTexture2D("funnyimage.png");
@@ -110,7 +114,7 @@ size_t TexturedQuadVertexArrayAtlas::submitQuad(Shmingo::Quad quad, uint8_t text
 	glBufferSubData(GL_ARRAY_BUFFER, m_instanceCount * sizeof(uint8_t), sizeof(uint8_t), &textureID); // Update with correct offset and size
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	se_glState.bindVertexArray(0);
 
 
 	return m_instanceCount++; //Post increment quadCount and return the value before incrementing
@@ -134,7 +138,7 @@ void TexturedQuadVertexArrayAtlas::resubmitQuad(size_t index, Shmingo::Quad quad
 	glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(uint8_t), sizeof(uint8_t), &textureID); // Update with correct offset and size
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	se_glState.bindVertexArray(0);
 }
 
 void TexturedQuadVertexArrayAtlas::changeQuadTexture(size_t index, uint8_t textureID){
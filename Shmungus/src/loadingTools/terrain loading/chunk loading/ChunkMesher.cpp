@@ -0,0 +1,315 @@
+#include <sepch.h>
+#include "ChunkMesher.h"
+
+#include <bit>
+
+typedef std::array<Shmingo::ChunkColumn, CHUNK_WIDTH * CHUNK_WIDTH> FaceMasks; //One face direction's mask for every column, indexed x * CHUNK_WIDTH + z
+
+static const Shmingo::ChunkColumn emptyColumn = {};
+
+//Column next to (x, z) in direction (dx, dz), taken from the neighboring chunk across a border
+static const Shmingo::ChunkColumn& getNeighborColumn(const Chunk& chunk, const Shmingo::ChunkNeighbors& neighbors, int x, int z, int dx, int dz) {
+
+	int nx = x + dx;
+	int nz = z + dz;
+
+	if (nx >= 0 && nx < (int)CHUNK_WIDTH && nz >= 0 && nz < (int)CHUNK_WIDTH) {
+		return chunk.getColumn(nx, nz);
+	}
+
+	const Chunk* neighbor = dx > 0 ? neighbors.positiveX : dx < 0 ? neighbors.negativeX : dz > 0 ? neighbors.positiveZ : neighbors.negativeZ;
+	if (neighbor == nullptr) {
+		return emptyColumn;
+	}
+
+	return neighbor->getColumn((nx + CHUNK_WIDTH) % CHUNK_WIDTH, (nz + CHUNK_WIDTH) % CHUNK_WIDTH);
+}
+
+/// <summary>
+/// Marks which blocks of every column show the given face. Top and bottom compare a column with itself shifted by one block,
+/// sides compare it with the neighboring column, each 64 blocks of height take one word operation
+/// </summary>
+/// <returns>False if no column has a solid block</returns>
+static bool computeFaceMasks(const Chunk& chunk, const Shmingo::ChunkNeighbors& neighbors, Shmingo::ChunkFace face, FaceMasks& masks) {
+
+	static const int directions[Shmingo::CHUNK_FACE_AMOUNT][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 }, { 0, 0 }, { 0, 0 } };
+
+	bool anySolid = false;
+
+	for (int x = 0; x < (int)CHUNK_WIDTH; x++) {
+		for (int z = 0; z < (int)CHUNK_WIDTH; z++) {
+
+			const Shmingo::ChunkColumn& column = chunk.getColumn(x, z);
+			Shmingo::ChunkColumn& mask = masks[x * CHUNK_WIDTH + z];
+
+			if (std::all_of(column.begin(), column.end(), [](uint64_t word) { return word == 0; })) {
+				mask = emptyColumn;
+				continue;
+			}
+			anySolid = true;
+
+			//Fixed length loops over plain words, the compiler turns them into vector instructions
+			if (face == Shmingo::TOP_FACE) {
+				for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+					uint64_t above = (column[word] >> 1) | (word + 1 < CHUNK_COLUMN_WORDS ? column[word + 1] << 63 : 0); //Bit y is the block at y + 1
+					mask[word] = column[word] & ~above;
+				}
+			}
+			else if (face == Shmingo::BOTTOM_FACE) {
+				for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+					uint64_t below = (column[word] << 1) | (word > 0 ? column[word - 1] >> 63 : 1); //The bottom of the world is never seen, it counts as solid
+					mask[word] = column[word] & ~below;
+				}
+			}
+			else {
+				const Shmingo::ChunkColumn& neighbor = getNeighborColumn(chunk, neighbors, x, z, directions[face][0], directions[face][1]);
+				for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+					mask[word] = column[word] & ~neighbor[word];
+				}
+			}
+		}
+	}
+
+	return anySolid;
+}
+
+//Two triangles covering a quad of extentA by extentB faces, extents are stored minus one
+static void emitQuad(Shmingo::ChunkMesh& mesh, GLuint x, GLuint y, GLuint z, Shmingo::ChunkFace face, Shmingo::BlockID material, GLuint extentA, GLuint extentB) {
+
+	uint8_t positionXZ = (uint8_t)((x << 4) | z);
+	uint8_t orientation = (uint8_t)(face * 2);
+
+	mesh.positions.insert(mesh.positions.end(), { positionXZ, (uint8_t)y, positionXZ, (uint8_t)y });
+	mesh.IDs.insert(mesh.IDs.end(), { Shmingo::packTerrainID(material, orientation), Shmingo::packTerrainID(material, orientation + 1) });
+	mesh.extents.insert(mesh.extents.end(), { (uint8_t)(extentA - 1), (uint8_t)(extentB - 1), (uint8_t)(extentA - 1), (uint8_t)(extentB - 1) });
+}
+
+//Bits first to first + amount - 1 of a column
+static Shmingo::ChunkColumn getRangeMask(GLuint first, GLuint amount) {
+
+	Shmingo::ChunkColumn mask = {};
+
+	for (GLuint word = first >> 6; word < CHUNK_COLUMN_WORDS && word * 64 < first + amount; word++) {
+
+		GLuint start = std::max(first, word * 64) - word * 64;
+		GLuint end = std::min(first + amount, word * 64 + 64) - word * 64;
+		mask[word] = (end - start == 64) ? ~0ull : ((1ull << (end - start)) - 1) << start;
+	}
+
+	return mask;
+}
+
+static bool containsRange(const Shmingo::ChunkColumn& column, const Shmingo::ChunkColumn& range) {
+
+	for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+		if ((column[word] & range[word]) != range[word]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void clearRange(Shmingo::ChunkColumn& column, const Shmingo::ChunkColumn& range) {
+	for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+		column[word] &= ~range[word];
+	}
+}
+
+static GLuint findFirstBit(const Shmingo::ChunkColumn& column) {
+
+	for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+		if (column[word] != 0) {
+			return word * 64 + (GLuint)std::countr_zero(column[word]);
+		}
+	}
+	return CHUNK_HEIGHT;
+}
+
+static inline bool testBit(const Shmingo::ChunkColumn& column, GLuint y) {
+	return (column[y >> 6] >> (y & 63)) & 1;
+}
+
+/// <summary>
+/// Greedy merging of side faces. Each quad starts as the longest vertical run of one material in a column, then grows sideways
+/// while the next column has the same run, checked against that column's face mask a word at a time
+/// </summary>
+/// <param name="alongX">Columns of a slice follow x (front and back faces), otherwise they follow z towards -z (right and left faces)</param>
+static void mergeSideFaces(const Chunk& chunk, FaceMasks& masks, Shmingo::ChunkFace face, bool alongX, Shmingo::ChunkMesh& mesh) {
+
+	for (int slice = 0; slice < (int)CHUNK_WIDTH; slice++) {
+
+		//Quads on x and y start at their lowest x, quads on z grow towards -z since the face's cell spans z - 1 to z, so they start at their highest z
+		for (int step = 0; step < (int)CHUNK_WIDTH; step++) {
+
+			int column = alongX ? step : (int)CHUNK_WIDTH - 1 - step;
+			int x = alongX ? column : slice;
+			int z = alongX ? slice : column;
+
+			Shmingo::ChunkColumn& mask = masks[x * CHUNK_WIDTH + z];
+			const Shmingo::BlockID* columnBlocks = chunk.getColumnBlocks(x, z);
+
+			for (GLuint y = findFirstBit(mask); y < CHUNK_HEIGHT; y = findFirstBit(mask)) {
+
+				Shmingo::BlockID material = columnBlocks[y];
+
+				GLuint height = 1;
+				while (y + height < CHUNK_HEIGHT && testBit(mask, y + height) && columnBlocks[y + height] == material) {
+					height++;
+				}
+
+				Shmingo::ChunkColumn range = getRangeMask(y, height);
+				clearRange(mask, range);
+
+				GLuint width = 1;
+				while (step + (int)width < (int)CHUNK_WIDTH) {
+
+					int nextX = alongX ? x + (int)width : x;
+					int nextZ = alongX ? z : z - (int)width;
+
+					Shmingo::ChunkColumn& nextMask = masks[nextX * CHUNK_WIDTH + nextZ];
+					if (!containsRange(nextMask, range)) {
+						break;
+					}
+
+					const Shmingo::BlockID* nextBlocks = chunk.getColumnBlocks(nextX, nextZ);
+					if (!std::all_of(nextBlocks + y, nextBlocks + y + height, [material](Shmingo::BlockID block) { return block == material; })) {
+						break;
+					}
+
+					clearRange(nextMask, range);
+					width++;
+				}
+
+				emitQuad(mesh, x, y, z, face, material, width, height);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Greedy merging of top or bottom faces. The face masks are transposed into one 16 bit row per x and height, bit z set where the face shows,
+/// then each quad starts as the longest run of one material along -z and grows along x while the next row has the same run
+/// </summary>
+static void mergeHorizontalFaces(const Chunk& chunk, const FaceMasks& masks, Shmingo::ChunkFace face, Shmingo::ChunkMesh& mesh) {
+
+	std::array<std::array<uint16_t, CHUNK_WIDTH>, CHUNK_HEIGHT> rows = {};
+	std::array<bool, CHUNK_HEIGHT> usedHeights = {};
+
+	for (GLuint x = 0; x < CHUNK_WIDTH; x++) {
+		for (GLuint z = 0; z < CHUNK_WIDTH; z++) {
+
+			const Shmingo::ChunkColumn& mask = masks[x * CHUNK_WIDTH + z];
+
+			for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+
+				uint64_t bits = mask[word];
+
+				while (bits != 0) {
+					GLuint y = word * 64 + (GLuint)std::countr_zero(bits);
+					bits &= bits - 1; //Clears the lowest set bit
+
+					rows[y][x] |= (uint16_t)(1u << z);
+					usedHeights[y] = true;
+				}
+			}
+		}
+	}
+
+	for (GLuint y = 0; y < CHUNK_HEIGHT; y++) {
+
+		if (!usedHeights[y]) {
+			continue;
+		}
+
+		for (GLuint x = 0; x < CHUNK_WIDTH; x++) {
+
+			uint16_t& row = rows[y][x];
+
+			while (row != 0) {
+
+				//Highest z first, the face's cell spans z - 1 to z so quads grow towards -z
+				GLuint z = (GLuint)std::bit_width(row) - 1;
+				Shmingo::BlockID material = chunk.getBlock(x, y, z);
+
+				GLuint depth = 1;
+				while (depth <= z && (row >> (z - depth) & 1) && chunk.getBlock(x, y, z - depth) == material) {
+					depth++;
+				}
+
+				uint16_t range = (uint16_t)(((1u << depth) - 1) << (z + 1 - depth));
+				row &= ~range;
+
+				GLuint width = 1;
+				while (x + width < CHUNK_WIDTH) {
+
+					uint16_t& nextRow = rows[y][x + width];
+					if ((nextRow & range) != range) {
+						break;
+					}
+
+					bool sameMaterial = true;
+					for (GLuint i = 0; i < depth && sameMaterial; i++) {
+						sameMaterial = chunk.getBlock(x + width, y, z - i) == material;
+					}
+					if (!sameMaterial) {
+						break;
+					}
+
+					nextRow &= ~range;
+					width++;
+				}
+
+				emitQuad(mesh, x, y, z, face, material, width, depth);
+			}
+		}
+	}
+}
+
+void Shmingo::meshChunk(const Chunk& chunk, const ChunkNeighbors& neighbors, ChunkMesh& mesh, bool greedy) {
+
+	mesh.clear();
+
+	if (chunk.getBlockAmount() == 0) {
+		return;
+	}
+
+	FaceMasks masks;
+
+	for (GLuint face = 0; face < CHUNK_FACE_AMOUNT; face++) {
+
+		if (!computeFaceMasks(chunk, neighbors, (ChunkFace)face, masks)) {
+			return;
+		}
+
+		if (greedy) {
+			if (face == TOP_FACE || face == BOTTOM_FACE) {
+				mergeHorizontalFaces(chunk, masks, (ChunkFace)face, mesh);
+			}
+			else {
+				mergeSideFaces(chunk, masks, (ChunkFace)face, face == FRONT_FACE || face == BACK_FACE, mesh);
+			}
+			continue;
+		}
+
+		//One quad per face
+		for (GLuint x = 0; x < CHUNK_WIDTH; x++) {
+			for (GLuint z = 0; z < CHUNK_WIDTH; z++) {
+
+				const ChunkColumn& mask = masks[x * CHUNK_WIDTH + z];
+				const BlockID* columnBlocks = chunk.getColumnBlocks(x, z);
+
+				for (GLuint word = 0; word < CHUNK_COLUMN_WORDS; word++) {
+
+					uint64_t bits = mask[word];
+
+					while (bits != 0) {
+						GLuint y = word * 64 + (GLuint)std::countr_zero(bits);
+						bits &= bits - 1; //Clears the lowest set bit
+
+						emitQuad(mesh, x, y, z, (ChunkFace)face, columnBlocks[y], 1, 1);
+					}
+				}
+			}
+		}
+	}
+}
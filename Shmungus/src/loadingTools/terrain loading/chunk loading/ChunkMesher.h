@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+#include "Chunk.h"
+
+namespace Shmingo {
+
+	//Faces of a block, in the order the terrain shader's transform array lists them. Face f is drawn as orientations 2f and 2f + 1
+	enum ChunkFace {
+		FRONT_FACE, //+z
+		RIGHT_FACE, //+x
+		BACK_FACE, //-z
+		LEFT_FACE, //-x
+		TOP_FACE, //+y
+		BOTTOM_FACE, //-y
+		CHUNK_FACE_AMOUNT
+	};
+
+	//Material in the high 10 bits and orientation in the low 6, the ID format ChunkVertexArray uploads
+	inline uint16_t packTerrainID(BlockID material, uint8_t orientation) {
+		return (uint16_t)(((material & MAX_BLOCK_ID) << 6) | (orientation & 0x3F));
+	}
+
+	//Triangles in the packed format ChunkVertexArray uploads, 2 position bytes, one ID and 2 extent bytes per triangle
+	struct ChunkMesh {
+
+		std::vector<uint8_t> positions; //4 bits x and 4 bits z, then 8 bits y
+		std::vector<uint16_t> IDs;
+		std::vector<uint8_t> extents; //Quad size minus one along the face's two axes: x and y for front/back, z and y for right/left, x and z for top/bottom
+
+		inline GLuint getTriangleAmount() const { return (GLuint)IDs.size(); };
+
+		//Keeps the capacity, so a mesh reused for every chunk stops allocating
+		inline void clear() {
+			positions.clear();
+			IDs.clear();
+			extents.clear();
+		}
+	};
+
+	//Chunks bordering the one being meshed. A missing neighbor counts as air, so faces on that border are kept
+	struct ChunkNeighbors {
+
+		const Chunk* positiveX = nullptr;
+		const Chunk* negativeX = nullptr;
+		const Chunk* positiveZ = nullptr;
+		const Chunk* negativeZ = nullptr;
+	};
+
+	/// <summary>
+	/// Meshes every solid block face that borders air, two triangles per face. Visibility is worked out on whole columns at once:
+	/// a column's solid mask is compared with its shifted self for top and bottom faces and with the neighboring columns for side faces,
+	/// so each 64 blocks of height take a few word operations instead of 6 neighbor lookups per block.
+	/// Neighboring faces of the same material are then merged greedily into larger quads, the shader scales each quad's triangles by its extents
+	/// </summary>
+	/// <param name="mesh">Cleared, then filled with the chunk's triangles</param>
+	/// <param name="greedy">False emits one quad per face, kept to compare against in benchmarks</param>
+	void meshChunk(const Chunk& chunk, const ChunkNeighbors& neighbors, ChunkMesh& mesh, bool greedy = true);
+}
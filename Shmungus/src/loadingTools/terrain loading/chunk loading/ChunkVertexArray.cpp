@@ -16,10 +16,12 @@ ChunkVertexArray::ChunkVertexArray(){
 
 
 	glGenVertexArrays(1, &vaoID);
+	glGenVertexArrays(1, &pulledVaoID);
 
 	glGenBuffers(1, &staticPositionsVboID);
 	glGenBuffers(1, &positionsVboID);
 	glGenBuffers(1, &IDVboID);
+	glGenBuffers(1, &extentsVboID);
 
 	bind();
 
@@ -38,17 +40,20 @@ ChunkVertexArray::ChunkVertexArray(){
 	glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, 2, (void*)0); // transform position
 	glVertexAttribDivisor(2, 1);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-}
+	glBindBuffer(GL_ARRAY_BUFFER, extentsVboID);
+	glBufferData(GL_ARRAY_BUFFER, MAX_CHUNK_POLYGONS * 2, nullptr, GL_DYNAMIC_DRAW);
+	glVertexAttribIPointer(3, 2, GL_UNSIGNED_BYTE, 2 * sizeof(uint8_t), (void*)0); // quad extents
+	glVertexAttribDivisor(3, 1);
 
-void ChunkVertexArray::init(){
-	//TODO set uniforms after declaring a terrain shader in the master renderer
-	setUniforms();
-}
+	for (GLsizei i = 0; i < getAttribAmt(); i++) {
+		se_glState.enableVertexAttribArray(i);
+	}
 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	se_glState.bindVertexArray(0);
+}
 
-size_t ChunkVertexArray::submitTerrain(size_t offset, uint8_t* positionsData, unsigned short* ID, size_t polyAmount){
+size_t ChunkVertexArray::submitTerrain(size_t offset, uint8_t* positionsData, unsigned short* ID, uint8_t* extentsData, size_t polyAmount){
 	bind();
 
 	glBindBuffer(GL_ARRAY_BUFFER, positionsVboID);
@@ -58,8 +63,11 @@ size_t ChunkVertexArray::submitTerrain(size_t offset, uint8_t* positionsData, un
 	glBindBuffer(GL_ARRAY_BUFFER, IDVboID);
 	glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(unsigned short), polyAmount * sizeof(unsigned short), ID);
 
+	glBindBuffer(GL_ARRAY_BUFFER, extentsVboID);
+	glBufferSubData(GL_ARRAY_BUFFER, offset * 2 * sizeof(uint8_t), polyAmount * 2 * sizeof(uint8_t), extentsData);
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	se_glState.bindVertexArray(0);
 
 
 	instanceAmount++;
@@ -67,6 +75,54 @@ size_t ChunkVertexArray::submitTerrain(size_t offset, uint8_t* positionsData, un
 	return polyAmount;
 }
 
+void ChunkVertexArray::submitMesh(const Shmingo::ChunkMesh& mesh){
+
+	size_t polyAmount = mesh.getTriangleAmount();
+
+	if (polyAmount > polygonCapacity) {
+
+		polygonCapacity = std::max((polyAmount + 1) & ~(size_t)1, polygonCapacity * 2); //Even, the pulling shader reads two triangles' bytes per word
+
+		//The VAO refers to the buffer objects, not their storage, so the attribute pointers stay valid
+		glBindBuffer(GL_ARRAY_BUFFER, positionsVboID);
+		glBufferData(GL_ARRAY_BUFFER, polygonCapacity * 2 * sizeof(uint8_t), nullptr, GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, IDVboID);
+		glBufferData(GL_ARRAY_BUFFER, polygonCapacity * sizeof(unsigned short), nullptr, GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, extentsVboID);
+		glBufferData(GL_ARRAY_BUFFER, polygonCapacity * 2 * sizeof(uint8_t), nullptr, GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	if (polyAmount > 0) {
+		submitTerrain(0, (uint8_t*)mesh.positions.data(), (unsigned short*)mesh.IDs.data(), (uint8_t*)mesh.extents.data(), polyAmount);
+	}
+
+	instanceAmount = polyAmount;
+}
+
+void ChunkVertexArray::cleanUp(){
+
+	glDeleteBuffers(1, &staticPositionsVboID);
+	glDeleteBuffers(1, &positionsVboID);
+	glDeleteBuffers(1, &IDVboID);
+	glDeleteBuffers(1, &extentsVboID);
+
+	glDeleteVertexArrays(1, &vaoID);
+	se_glState.vertexArrayDeleted(vaoID);
+	glDeleteVertexArrays(1, &pulledVaoID);
+	se_glState.vertexArrayDeleted(pulledVaoID);
+}
+
+void ChunkVertexArray::bindStorageBuffers(){
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_POSITIONS_STORAGE_BINDING, positionsVboID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_ID_STORAGE_BINDING, IDVboID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_EXTENTS_STORAGE_BINDING, extentsVboID);
+}
+
 void ChunkVertexArray::submitTriangleDebug(size_t offset, uvec3 position, unsigned short materialID, uint8_t orientationID){
 
 	unsigned short ID = (materialID << 6); //Start by shifting material ID left 6 bits
@@ -84,22 +140,20 @@ void ChunkVertexArray::submitTriangleDebug(size_t offset, uvec3 position, unsign
 		positionXZ = (x << 4) | z;
 	}
 	else {
-		se_error("X or Y out of bounds when submitting triangle with position " << position.x, ", " << position.z << ", " << position.y);
+		se_error("X or Y out of bounds when submitting triangle with position " << position.x << ", " << position.z << ", " << position.y);
 		return;
 	}
 
 	uint8_t positionsData[2] = { positionXZ, (uint8_t)position.y };
+	uint8_t extentsData[2] = { 0, 0 }; //A single block face
 
-	submitTerrain(offset, positionsData, &ID, 1);
+	submitTerrain(offset, positionsData, &ID, extentsData, 1);
 }
 
 
 
-void ChunkVertexArray::setUniforms(){
-
-	std::shared_ptr<ShaderProgram> terrainShader = se_masterRenderer.getShader(se_TERRAIN_SHADER);
-
-	mat4* transformationsArray = new mat4[64]; //64 matrices for transforming triangles
+//Transform of the base triangle for every orientation, unused orientations stay zero
+static void createOrientationTransforms(mat4* transformationsArray){
 
 	transformationsArray[0] = Shmingo::createTransformationMatrix(vec3(0, 0, 0), vec3(0, 0, 0), vec3(1, 1, 1)); // Triangle 1
 	transformationsArray[1] = Shmingo::createTransformationMatrix(glm::vec3(1, 1, 0), glm::vec3(0, 0, glm::radians(180.0f)), glm::vec3(1, 1, 1)); // Triangle 2
@@ -150,11 +204,43 @@ void ChunkVertexArray::setUniforms(){
 
 	transformationsArray[32] = Shmingo::createTransformationMatrix(vec3(0, 0, 0), vec3(glm::radians(-45.0f), 0, 0), vec3(1, 1.41421356f, 1)); // Triangle 1
 	transformationsArray[33] = Shmingo::createTransformationMatrix(vec3(1, 1, -1), vec3(glm::radians(-45.0f), 0, glm::radians(180.0f)), vec3(1, 1.41421356f, 1)); // Triangle 1
+}
+
+void ChunkVertexArray::setUniforms(){
+
+	std::shared_ptr<ShaderProgram> terrainShader = se_masterRenderer.getShader(se_TERRAIN_SHADER);
+	std::shared_ptr<ShaderProgram> pulledShader = se_masterRenderer.getShader(se_TERRAIN_PULLED_SHADER);
+
+	mat4* transformationsArray = new mat4[TERRAIN_ORIENTATION_AMOUNT](); //64 matrices for transforming triangles
+	createOrientationTransforms(transformationsArray);
 
 	auto transformsLocation = glGetUniformLocation(terrainShader->getProgramID(), "transformArray");
 	terrainShader->start();
-	glUniformMatrix4fv(transformsLocation, 64, false, reinterpret_cast<float*>(transformationsArray));
+	glUniformMatrix4fv(transformsLocation, TERRAIN_ORIENTATION_AMOUNT, false, reinterpret_cast<float*>(transformationsArray));
 	terrainShader->stop();
 
+	//The pulling shader gets the corners already transformed, 3 vector adds per vertex instead of a matrix multiply
+	std::vector<vec3> cornerOffsets(TERRAIN_ORIENTATION_AMOUNT * 3);
+
+	for (GLuint orientation = 0; orientation < TERRAIN_ORIENTATION_AMOUNT; orientation++) {
+
+		vec3 staticPositions[3] = { vec3(0, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0) };
+
+		//Diagonals move the base triangle's first two corners, as terrainVertex.glsl does per vertex
+		if (orientation >= 24 && orientation <= 31) {
+			staticPositions[0].x += 1;
+			staticPositions[1].z -= 1;
+		}
+
+		for (GLuint corner = 0; corner < 3; corner++) {
+			cornerOffsets[orientation * 3 + corner] = vec3(transformationsArray[orientation] * vec4(staticPositions[corner], 1.0f));
+		}
+	}
+
+	auto cornersLocation = glGetUniformLocation(pulledShader->getProgramID(), "cornerOffsets");
+	pulledShader->start();
+	glUniform3fv(cornersLocation, (GLsizei)cornerOffsets.size(), reinterpret_cast<float*>(cornerOffsets.data()));
+	pulledShader->stop();
+
 	delete[] transformationsArray;
 }
\ No newline at end of file
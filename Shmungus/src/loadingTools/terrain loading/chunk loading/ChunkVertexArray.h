@@ -2,10 +2,21 @@
 
 #include <ShmingoCore.h>
 #include "DataStructures.h"
+#include "GLStateTracker.h"
+#include "ChunkMesher.h"
 
 
 const size_t MAX_CHUNK_POLYGONS = 16 * 16 * 40;
 
+const GLuint TERRAIN_ORIENTATION_AMOUNT = 64; //Orientations the 6 bit orientation ID can name
+
+//Shader storage binding points the vertex pulling terrain shader reads each buffer from
+const GLuint TERRAIN_POSITIONS_STORAGE_BINDING = 0;
+const GLuint TERRAIN_ID_STORAGE_BINDING = 1;
+const GLuint TERRAIN_EXTENTS_STORAGE_BINDING = 2;
+
+const GLint TERRAIN_CHUNK_ORIGIN_LOCATION = 0; //Explicit location of chunkOrigin in both terrain shaders, set every draw without a lookup
+
 class ChunkVertexArray {
 
 public:
@@ -13,35 +24,61 @@ public:
 ChunkVertexArray();
 
 
-void bind(){ glBindVertexArray(vaoID); }
+void bind(){ se_glState.bindVertexArray(vaoID); }
 
 GLuint& getVaoID(){ return vaoID; }
 
-GLsizei getAttribAmt() { return 3; } //3 attributes
+//Vertex pulling draws with no attributes, this VAO has none enabled so nothing is fetched past the buffers
+void bindPulled(){ se_glState.bindVertexArray(pulledVaoID); }
+GLuint getPulledVaoID(){ return pulledVaoID; }
+
+//Binds the triangle buffers as shader storage for the vertex pulling shader
+void bindStorageBuffers();
+
+GLsizei getAttribAmt() { return 4; } //4 attributes
 size_t getInstanceCount() { return instanceAmount; }
 
-void init();
+//Chunk whose mesh this holds, draws offset the mesh's chunk local positions to that chunk's place in the world
+void setChunkPosition(ivec2 position){ chunkPosition = position; }
+ivec2 getChunkPosition(){ return chunkPosition; }
+
+//Stops drawing anything. The buffers and their capacity are kept, so a recycled vertex array takes its next mesh without reallocating
+void clear(){ instanceAmount = 0; }
 
-void setUniforms();
+void cleanUp();
+
+//Loads the orientation tables into both terrain shaders, once after the master renderer creates them
+static void setUniforms();
 
 /// <summary>
 /// Function for submitting terrain data to the GPU
 /// </summary>
 /// <param name="positionsData">Byte compacted positions, format is: 4 bits for x, 4 bits for z, 8 bits for y</param>
 /// <param name="ID">ID data for triangle, first 11 bits are for material ID, last 5 bits are for orientation ID</param>
+/// <param name="extentsData">2 bytes per triangle, size minus one of the merged quad it belongs to, see ChunkMesh::extents</param>
 /// <returns>Poly amount added</returns>
-size_t submitTerrain(size_t offset, uint8_t* positionsData, unsigned short* ID, size_t polyAmount);
+size_t submitTerrain(size_t offset, uint8_t* positionsData, unsigned short* ID, uint8_t* extentsData, size_t polyAmount);
+
+/// <summary>
+/// Replaces everything drawn with a mesher's output, growing the buffers if the mesh does not fit
+/// </summary>
+void submitMesh(const Shmingo::ChunkMesh& mesh);
 
 void submitTriangleDebug(size_t offset, uvec3 position, unsigned short materialID, uint8_t orientationID); //TODO delete this
 
 private:
 
 	GLuint vaoID;
+	GLuint pulledVaoID;
 	GLuint staticPositionsVboID;
 	GLuint positionsVboID;
 	GLuint IDVboID;
+	GLuint extentsVboID;
+
 
+	ivec2 chunkPosition = ivec2(0, 0);
 
 	size_t instanceAmount = 0;
+	size_t polygonCapacity = MAX_CHUNK_POLYGONS; //Triangles the buffers have room for
 
 };
\ No newline at end of file
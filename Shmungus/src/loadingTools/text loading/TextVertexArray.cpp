@@ -37,7 +37,7 @@ TextVertexArray::TextVertexArray(std::string fontName) : fontName(fontName){
 	glGenBuffers(1, &positionsVboID); //Generates a vertex buffer for positions
 	glGenBuffers(1, &charDataVboID); //Generates a vertex buffer for charData (Containing texture ID, color, and scale)
 
-	glBindVertexArray(vaoID); //Bind VAO
+	se_glState.bindVertexArray(vaoID); //Bind VAO
 
 	//Set up vertex attributes
 
@@ -69,8 +69,12 @@ TextVertexArray::TextVertexArray(std::string fontName) : fontName(fontName){
 	glVertexAttribIPointer(5, 1, GL_UNSIGNED_BYTE, 3, (const void*)offsetof(Shmingo::GlyphData, scale));
 	glVertexAttribDivisor(5, 1); //Per instance attribute
 
+	for (GLuint i = 0; i < 6; i++) {
+		se_glState.enableVertexAttribArray(i);
+	}
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0); //Unbind VAO
+	se_glState.bindVertexArray(0); //Unbind VAO
 
 }
 
@@ -458,6 +462,7 @@ void TextVertexArray::cleanUp() {
 	glDeleteBuffers(1, &charDataVboID);
 
 	glDeleteVertexArrays(1, &vaoID);
+	se_glState.vertexArrayDeleted(vaoID);
 
 	delete charDataTempBuffer;
 	delete positionsTempBuffer;
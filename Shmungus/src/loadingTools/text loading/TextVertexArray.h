@@ -6,6 +6,7 @@
 #include <sepch.h>
 
 #include "TextBox.h"
+#include "GLStateTracker.h"
 
 //This class is for when we want to use instancing instead of batching, mostly for entities
 //Templated to entity type for optimizations
@@ -108,7 +109,7 @@ protected:
 	//Utility functions --------------------------------------------------------
 
 	inline void bindVao() {
-		glBindVertexArray(vaoID);
+		se_glState.bindVertexArray(vaoID);
 	}
 
 	inline void unbindBuffer() {
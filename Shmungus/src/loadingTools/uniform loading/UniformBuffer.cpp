@@ -1,6 +1,7 @@
 #include <sepch.h>
 #include "UniformBuffer.h"
 #include <ShmingoApp.h>
+#include "GLStateTracker.h"
 
 //Im hardcoding all the offsets of the uniforms in the buffer object to avoid having to look up values in a hashmap every frame, get over it
 // 
@@ -50,6 +51,7 @@ void UniformBuffer::init() {
 }
 
 void UniformBuffer::setProjectionMatrix(mat4 projectionMatrix){
+	this->projectionMatrix = projectionMatrix;
 	glBindBuffer(GL_UNIFORM_BUFFER,uboID);
 	setUniformMat4(projectionMatrix, OFFSET_PROJECTIONMATRIX);
 }
@@ -61,6 +63,7 @@ void UniformBuffer::setOrthoMatrix(mat4 orthoMatrix) {
 }
 
 void UniformBuffer::setViewMatrix(mat4 viewMatrix){
+	this->viewMatrix = viewMatrix;
 	glBindBuffer(GL_UNIFORM_BUFFER, uboID);
 	setUniformMat4(viewMatrix, OFFSET_VIEWMATRIX);
 }
@@ -149,5 +152,5 @@ void UniformBuffer::bindUniformBlock(Shmingo::UniformBlock block){
 	glBindBuffer(GL_UNIFORM_BUFFER, uboID);
 	Shmingo::UniformBlockInfo currentBlockInfo = blockInfo.at(block);
 
-	glBindBufferRange(GL_UNIFORM_BUFFER, currentBlockInfo.bindingPoint, uboID, currentBlockInfo.offset, currentBlockInfo.size);
+	se_glState.bindUniformBufferRange(currentBlockInfo.bindingPoint, uboID, currentBlockInfo.offset, currentBlockInfo.size);
 }
@@ -25,6 +25,10 @@ public:
 	void setViewMatrix(mat4 viewMatrix);
 	void setElapsedTime(float time);
 
+	//CPU copies of the last uploaded matrices, for culling and anything else that needs the camera without reading the buffer back
+	inline const mat4& getProjectionMatrix() { return projectionMatrix; };
+	inline const mat4& getViewMatrix() { return viewMatrix; };
+
 	inline Shmingo::UniformBlockInfo getBlockInfo(Shmingo::UniformBlock block) { return blockInfo.at(block); };
 
 	static UniformBuffer& get() { return instance; };
@@ -41,6 +45,9 @@ private:
 
 	GLuint uboID = 0;
 
+	mat4 projectionMatrix = mat4(1.0f);
+	mat4 viewMatrix = mat4(1.0f);
+
 	Shmingo::OrderedMap<Shmingo::UniformBlock, Shmingo::UniformBlockInfo> blockInfo; //Map of block indices
 
 	void createUniformBlock(Shmingo::UniformBlock block, GLuint size, const char* name, GLuint bindingPointf);
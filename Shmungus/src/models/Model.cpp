@@ -5,10 +5,12 @@
 Model::Model(float* positions, float* texCoords, Texture2D texture, GLuint vertexCount, int* indices, GLuint indexCount) : positionData(positions),
 	textureCoords(texCoords), texture(texture), vertexCount(vertexCount), indexData(indices), indexCount(indexCount) {
 
+	computeBoundingSphere();
 }
 
 Model::Model(const Model& other) : positionData(new float(*other.positionData)), textureCoords(new float(*other.textureCoords)),
-	indexData(new int(*other.indexData)), texture(other.texture), vertexCount(other.vertexCount), indexCount(other.indexCount){
+	indexData(new int(*other.indexData)), texture(other.texture), vertexCount(other.vertexCount), indexCount(other.indexCount),
+	boundingCenter(other.boundingCenter), boundingRadius(other.boundingRadius){
 
 	//Initializer list to copy all variables and keep dynamically allocated members intact
 }
@@ -51,6 +53,8 @@ Model& Model::operator=(const Model& other){
 	texture = other.texture;
 	indexCount = other.indexCount;
 	vertexCount = other.vertexCount;
+	boundingCenter = other.boundingCenter;
+	boundingRadius = other.boundingRadius;
 	 
 	return *this;
 }
@@ -64,6 +68,31 @@ std::unique_ptr<float[]> Model::createTexIDArray(){
 	return texIDArray;
 }
 
+void Model::computeBoundingSphere() {
+
+	if (vertexCount == 0) {
+		return;
+	}
+
+	//Centered on the bounding box, not minimal but tight enough for culling and one pass over the vertices
+	vec3 minimum = vec3(positionData[0], positionData[1], positionData[2]);
+	vec3 maximum = minimum;
+
+	for (GLuint i = 1; i < vertexCount; i++) {
+		vec3 position = vec3(positionData[3 * i], positionData[3 * i + 1], positionData[3 * i + 2]);
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	boundingCenter = (minimum + maximum) * 0.5f;
+	boundingRadius = 0.0f;
+
+	for (GLuint i = 0; i < vertexCount; i++) {
+		vec3 position = vec3(positionData[3 * i], positionData[3 * i + 1], positionData[3 * i + 2]);
+		boundingRadius = std::max(boundingRadius, glm::length(position - boundingCenter));
+	}
+}
+
 void Model::instantiate(){
 	 
 	this->positionData = new float;
@@ -37,6 +37,10 @@ public:
 
 	inline Texture2D getTexture() { return texture; };
 
+	//Bounding sphere of the vertices in model space
+	inline vec3 getBoundingCenter() { return boundingCenter; };
+	inline float getBoundingRadius() { return boundingRadius; };
+
 	std::unique_ptr<float[]> createTexIDArray();
 
 private:
@@ -51,5 +55,10 @@ private:
 	//Index data
 	GLuint indexCount;
 	int* indexData;
+
+	vec3 boundingCenter = vec3(0.0f);
+	float boundingRadius = 0.0f;
+
+	void computeBoundingSphere();
 };
 
@@ -10,5 +10,6 @@ void Shmingo::initModels() {
 	Texture2D funnyTexture = Shmingo::createTexture2D("funnyimage.png");
 	defaultEntityModel.reset(Shmingo::createModelPointer(std::bind(Shmingo::createCubeModel, vec3(0.0f, 0.0f, 0.0f), funnyTexture)));
 	se_masterRenderer.declareEntityModel(Shmingo::DefaultEntity, defaultEntityModel);
+	se_masterRenderer.declareEntityTexture(Shmingo::DefaultEntity, se_masterRenderer.getTextureRegistry().registerTexture("funnyimage.png"));
 
 }
\ No newline at end of file
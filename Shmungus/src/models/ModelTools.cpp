@@ -1,6 +1,8 @@
 #include <sepch.h>
 #include "ModelTools.h"
 
+#include <queue>
+
 
 Model Shmingo::createCubeModel(vec3 position, Texture2D texture) {
 
@@ -103,3 +105,350 @@ std::unique_ptr<int[]> Shmingo::shiftIndices(int* indices, int amount, int index
 
 	return newIndices; 
 }
+
+
+
+//Mesh simplification -------------------------------------------------------------------------------------------
+
+//Sum of squared distances to a set of planes, as the upper triangle of a symmetric 4x4 matrix. Doubles since sums over many planes lose precision fast
+struct Quadric {
+
+	double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+	double a11 = 0, a12 = 0, a13 = 0;
+	double a22 = 0, a23 = 0;
+	double a33 = 0;
+
+	//Plane dot(normal, p) + d = 0, weighted
+	static Quadric fromPlane(glm::dvec3 normal, double d, double weight) {
+		Quadric q;
+		q.a00 = weight * normal.x * normal.x; q.a01 = weight * normal.x * normal.y; q.a02 = weight * normal.x * normal.z; q.a03 = weight * normal.x * d;
+		q.a11 = weight * normal.y * normal.y; q.a12 = weight * normal.y * normal.z; q.a13 = weight * normal.y * d;
+		q.a22 = weight * normal.z * normal.z; q.a23 = weight * normal.z * d;
+		q.a33 = weight * d * d;
+		return q;
+	}
+
+	Quadric& operator+=(const Quadric& other) {
+		a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+		a11 += other.a11; a12 += other.a12; a13 += other.a13;
+		a22 += other.a22; a23 += other.a23;
+		a33 += other.a33;
+		return *this;
+	}
+
+	double evaluate(glm::dvec3 p) const {
+		return a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z + 2.0 * a03 * p.x
+			+ a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + 2.0 * a13 * p.y
+			+ a22 * p.z * p.z + 2.0 * a23 * p.z
+			+ a33;
+	}
+
+	//Point with the least error, false if the planes don't pin one down (flat or straight regions)
+	bool solve(glm::dvec3& out) const {
+
+		double det = a00 * (a11 * a22 - a12 * a12) - a01 * (a01 * a22 - a12 * a02) + a02 * (a01 * a12 - a11 * a02);
+		if (std::abs(det) < 1e-12) {
+			return false;
+		}
+
+		//Cramer's rule on the upper 3x3 block against -(a03, a13, a23)
+		double bx = -a03, by = -a13, bz = -a23;
+		out.x = (bx * (a11 * a22 - a12 * a12) - a01 * (by * a22 - a12 * bz) + a02 * (by * a12 - a11 * bz)) / det;
+		out.y = (a00 * (by * a22 - a12 * bz) - bx * (a01 * a22 - a12 * a02) + a02 * (a01 * bz - by * a02)) / det;
+		out.z = (a00 * (a11 * bz - by * a12) - a01 * (a01 * bz - by * a02) + bx * (a01 * a12 - a11 * a02)) / det;
+		return true;
+	}
+};
+
+//Edge collapse waiting in the queue, stale once either vertex changed after it was computed
+struct EdgeCollapse {
+
+	double cost;
+	GLuint keep; //Vertex that stays, moved to position
+	GLuint remove;
+	GLuint keepVersion;
+	GLuint removeVersion;
+	glm::dvec3 position;
+	float uvBlend; //Texture coordinate of the kept vertex becomes mix(keep, remove, uvBlend)
+
+	bool operator>(const EdgeCollapse& other) const { return cost > other.cost; };
+};
+
+std::shared_ptr<Model> Shmingo::simplifyModel(Model& model, GLuint targetTriangles) {
+
+	GLuint vertexCount = model.getVertexCount();
+	GLuint triangleCount = model.getIndexCount() / 3;
+
+	std::vector<glm::dvec3> positions(vertexCount);
+	std::vector<vec2> uvs(vertexCount);
+	for (GLuint i = 0; i < vertexCount; i++) {
+		positions[i] = glm::dvec3(model.getPositionData()[3 * i], model.getPositionData()[3 * i + 1], model.getPositionData()[3 * i + 2]);
+		uvs[i] = vec2(model.getTextureCoords()[2 * i], model.getTextureCoords()[2 * i + 1]);
+	}
+
+	std::vector<std::array<GLuint, 3>> triangles(triangleCount);
+	std::vector<bool> triangleRemoved(triangleCount, false);
+	std::vector<std::vector<GLuint>> vertexTriangles(vertexCount);
+
+	for (GLuint t = 0; t < triangleCount; t++) {
+		for (GLuint corner = 0; corner < 3; corner++) {
+			triangles[t][corner] = (GLuint)model.getIndexData()[3 * t + corner];
+			vertexTriangles[triangles[t][corner]].emplace_back(t);
+		}
+	}
+
+	//Area weighted plane of every triangle, summed into each of its vertices
+	std::vector<Quadric> quadrics(vertexCount);
+	for (const std::array<GLuint, 3>& triangle : triangles) {
+
+		glm::dvec3 normal = glm::cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+		double doubleArea = glm::length(normal);
+		if (doubleArea <= 0.0) {
+			continue;
+		}
+
+		normal /= doubleArea;
+		Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, positions[triangle[0]]), doubleArea * 0.5);
+
+		for (GLuint vertex : triangle) {
+			quadrics[vertex] += plane;
+		}
+	}
+
+	//Edges with one triangle are open borders or texture seams (split vertices), edges with more are non manifold. Their vertices never move, so seams can't open up
+	std::unordered_map<uint64_t, GLuint> edgeUses;
+	auto edgeKey = [](GLuint a, GLuint b) { return ((uint64_t)std::min(a, b) << 32) | std::max(a, b); };
+
+	for (const std::array<GLuint, 3>& triangle : triangles) {
+		for (GLuint corner = 0; corner < 3; corner++) {
+			edgeUses[edgeKey(triangle[corner], triangle[(corner + 1) % 3])]++;
+		}
+	}
+
+	std::vector<bool> locked(vertexCount, false);
+	for (const auto& [key, uses] : edgeUses) {
+		if (uses != 2) {
+			locked[(GLuint)(key >> 32)] = true;
+			locked[(GLuint)(key & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	std::vector<GLuint> versions(vertexCount, 0);
+	std::vector<bool> vertexRemoved(vertexCount, false);
+
+	std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, std::greater<EdgeCollapse>> queue;
+
+	auto pushCollapse = [&](GLuint a, GLuint b) {
+
+		if (locked[a] && locked[b]) {
+			return;
+		}
+
+		EdgeCollapse collapse;
+		collapse.keep = locked[b] ? b : a; //A locked vertex always stays where it is
+		collapse.remove = locked[b] ? a : b;
+
+		Quadric combined = quadrics[a];
+		combined += quadrics[b];
+
+		glm::dvec3 keepPosition = positions[collapse.keep];
+		glm::dvec3 removePosition = positions[collapse.remove];
+
+		//Candidate positions, the quadric's optimum only when it exists and nothing is locked
+		collapse.position = keepPosition;
+		collapse.uvBlend = 0.0f;
+		collapse.cost = combined.evaluate(keepPosition);
+
+		if (!locked[collapse.keep]) {
+
+			auto tryPosition = [&](glm::dvec3 position, float blend) {
+				double cost = combined.evaluate(position);
+				if (cost < collapse.cost) {
+					collapse.cost = cost;
+					collapse.position = position;
+					collapse.uvBlend = blend;
+				}
+			};
+
+			tryPosition(removePosition, 1.0f);
+			tryPosition((keepPosition + removePosition) * 0.5, 0.5f);
+
+			glm::dvec3 optimum;
+			if (combined.solve(optimum)) {
+				glm::dvec3 edge = removePosition - keepPosition;
+				double edgeLength2 = glm::dot(edge, edge);
+				float blend = edgeLength2 > 0.0 ? (float)glm::clamp(glm::dot(optimum - keepPosition, edge) / edgeLength2, 0.0, 1.0) : 0.0f;
+				tryPosition(optimum, blend);
+			}
+		}
+
+		collapse.keepVersion = versions[collapse.keep];
+		collapse.removeVersion = versions[collapse.remove];
+		queue.push(collapse);
+	};
+
+	for (const std::array<GLuint, 3>& triangle : triangles) {
+		for (GLuint corner = 0; corner < 3; corner++) {
+			pushCollapse(triangle[corner], triangle[(corner + 1) % 3]);
+		}
+	}
+
+	//Moving a vertex must not turn any of its other triangles over or squash them flat
+	auto flipsTriangles = [&](GLuint vertex, GLuint other, glm::dvec3 position) {
+
+		for (GLuint t : vertexTriangles[vertex]) {
+
+			const std::array<GLuint, 3>& triangle = triangles[t];
+			if (triangleRemoved[t] || triangle[0] == other || triangle[1] == other || triangle[2] == other) {
+				continue; //Collapses away with the edge
+			}
+
+			glm::dvec3 before[3] = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+			glm::dvec3 after[3] = { before[0], before[1], before[2] };
+			for (GLuint corner = 0; corner < 3; corner++) {
+				if (triangle[corner] == vertex) {
+					after[corner] = position;
+				}
+			}
+
+			glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+			glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+			double lengths = glm::length(normalBefore) * glm::length(normalAfter);
+			if (lengths <= 0.0 || glm::dot(normalBefore, normalAfter) < 0.2 * lengths) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	GLuint liveTriangles = triangleCount;
+
+	while (liveTriangles > targetTriangles && !queue.empty()) {
+
+		EdgeCollapse collapse = queue.top();
+		queue.pop();
+
+		GLuint keep = collapse.keep;
+		GLuint remove = collapse.remove;
+
+		if (vertexRemoved[keep] || vertexRemoved[remove] || versions[keep] != collapse.keepVersion || versions[remove] != collapse.removeVersion) {
+			continue;
+		}
+
+		if (flipsTriangles(keep, remove, collapse.position) || flipsTriangles(remove, keep, collapse.position)) {
+			continue;
+		}
+
+		positions[keep] = collapse.position;
+		uvs[keep] = glm::mix(uvs[keep], uvs[remove], collapse.uvBlend);
+		quadrics[keep] += quadrics[remove];
+
+		vertexRemoved[remove] = true;
+		versions[keep]++;
+		versions[remove]++;
+
+		//Triangles on the edge disappear, the rest of the removed vertex's triangles move over to the kept one
+		for (GLuint t : vertexTriangles[remove]) {
+
+			if (triangleRemoved[t]) {
+				continue;
+			}
+
+			std::array<GLuint, 3>& triangle = triangles[t];
+
+			if (triangle[0] == keep || triangle[1] == keep || triangle[2] == keep) {
+				triangleRemoved[t] = true;
+				liveTriangles--;
+				continue;
+			}
+
+			for (GLuint& vertex : triangle) {
+				if (vertex == remove) {
+					vertex = keep;
+				}
+			}
+			vertexTriangles[keep].emplace_back(t);
+		}
+		vertexTriangles[remove].clear();
+
+		std::erase_if(vertexTriangles[keep], [&](GLuint t) { return triangleRemoved[t]; });
+
+		//Every edge around the kept vertex changed cost, the old entries went stale with its version
+		for (GLuint t : vertexTriangles[keep]) {
+			for (GLuint vertex : triangles[t]) {
+				if (vertex != keep) {
+					pushCollapse(keep, vertex);
+				}
+			}
+		}
+	}
+
+	//Compact the surviving vertices and triangles into new arrays
+	std::vector<GLuint> remap(vertexCount, 0xFFFFFFFF);
+	std::vector<int> indices;
+	indices.reserve((size_t)liveTriangles * 3);
+	GLuint newVertexCount = 0;
+
+	for (GLuint t = 0; t < triangleCount; t++) {
+
+		if (triangleRemoved[t]) {
+			continue;
+		}
+
+		for (GLuint vertex : triangles[t]) {
+			if (remap[vertex] == 0xFFFFFFFF) {
+				remap[vertex] = newVertexCount++;
+			}
+			indices.emplace_back((int)remap[vertex]);
+		}
+	}
+
+	float* newPositions = new float[(size_t)newVertexCount * 3];
+	float* newTexCoords = new float[(size_t)newVertexCount * 2];
+	int* newIndices = new int[indices.size()];
+
+	for (GLuint i = 0; i < vertexCount; i++) {
+
+		if (remap[i] == 0xFFFFFFFF) {
+			continue;
+		}
+
+		GLuint target = remap[i];
+		newPositions[3 * target] = (float)positions[i].x;
+		newPositions[3 * target + 1] = (float)positions[i].y;
+		newPositions[3 * target + 2] = (float)positions[i].z;
+		newTexCoords[2 * target] = uvs[i].x;
+		newTexCoords[2 * target + 1] = uvs[i].y;
+	}
+
+	std::copy(indices.begin(), indices.end(), newIndices);
+
+	return std::make_shared<Model>(newPositions, newTexCoords, model.getTexture(), newVertexCount, newIndices, (GLuint)indices.size());
+}
+
+std::vector<std::shared_ptr<Model>> Shmingo::createLodChain(const std::shared_ptr<Model>& model, GLuint levelAmount) {
+
+	std::vector<std::shared_ptr<Model>> chain;
+	chain.emplace_back(model);
+
+	while (chain.size() < levelAmount) {
+
+		GLuint previousTriangles = chain.back()->getIndexCount() / 3;
+		GLuint targetTriangles = previousTriangles / 2;
+
+		if (targetTriangles < LOD_MIN_TRIANGLES) {
+			break;
+		}
+
+		std::shared_ptr<Model> level = simplifyModel(*chain.back(), targetTriangles);
+
+		if ((float)(level->getIndexCount() / 3) > (float)previousTriangles * LOD_MIN_REDUCTION) {
+			break; //Borders, seams and flips blocked most collapses, another level would look the same and cost the same
+		}
+
+		chain.emplace_back(level);
+	}
+
+	return chain;
+}
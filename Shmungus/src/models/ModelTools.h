@@ -6,6 +6,9 @@
 #include "Model.h"
 #include "TextureTools.h"
 
+const GLuint LOD_MIN_TRIANGLES = 12; //Levels are not built below this, such meshes are already cheap enough
+const float LOD_MIN_REDUCTION = 0.75f; //A level has to end up with at most this fraction of the previous level's triangles to be kept
+
 namespace Shmingo {
 	Model createCubeModel(vec3 position, Texture2D texture);
 	Model createQuadModel(vec3 position, Texture2D texture);
@@ -23,4 +26,21 @@ namespace Shmingo {
 
 
 	std::unique_ptr<int[]> shiftIndices(int* indices, int amount, int indexCount);
+
+	/// <summary>
+	/// Simplifies a mesh with quadric error metrics, collapsing the edges whose removal changes the surface the least until at most targetTriangles remain.
+	/// Open borders and texture seams are kept in place, and collapses that would flip a triangle are skipped, so the result may stop above the target
+	/// </summary>
+	/// <param name="model">Mesh to simplify, left untouched</param>
+	/// <param name="targetTriangles">Amount of triangles to aim for</param>
+	/// <returns>New model with its own vertex and index data, same texture</returns>
+	std::shared_ptr<Model> simplifyModel(Model& model, GLuint targetTriangles);
+
+	/// <summary>
+	/// Builds a chain of levels of detail, each simplified to about half the triangles of the previous one.
+	/// Stops early once a level would fall below LOD_MIN_TRIANGLES or the simplifier can't remove enough triangles
+	/// </summary>
+	/// <param name="model">Full detail model, first entry of the chain</param>
+	/// <param name="levelAmount">Most levels to build, including the full detail one</param>
+	std::vector<std::shared_ptr<Model>> createLodChain(const std::shared_ptr<Model>& model, GLuint levelAmount);
 }
\ No newline at end of file
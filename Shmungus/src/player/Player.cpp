@@ -17,8 +17,8 @@ struct MovementTable {
 vec3 targetVelocity = vec3(0.0f, 0.0f, 0.0f);
 MovementTable movementTable = MovementTable(false,false,false,false,false,false);
 
-//Initializes camera with all zeros, THIS IS TEMPORARY! Camera should eventually take in vector pointers so it can be attached to player
-Player::Player(Model model) : Entity(model, vec3(0.0f,0.0f,0.0f), vec3(0.0f,0.0f,0.0f)), camera(Camera(&position, &rotation, &direction)){
+//Initializes camera rotation with all zeros, THIS IS TEMPORARY! Camera should eventually take in vector pointers so it can be attached to player
+Player::Player(Model model, vec3 spawnPosition) : Entity(model, spawnPosition, vec3(0.0f,0.0f,0.0f)), camera(Camera(&position, &rotation, &direction)){
 
 	se_layerStack.addListener<Player, KeyPressEvent>(Shmingo::SANDBOX_LAYER, this, &Player::getKeyDown);
 	se_layerStack.addListener<Player, KeyReleaseEvent>(Shmingo::SANDBOX_LAYER, this, &Player::getKeyUp);
@@ -2,7 +2,7 @@
 
 #include <Engine.h>
 
-#include "Entity.h"
+#include "entity.h"
 #include "Camera.h"
 #include "UniformBuffer.h"
 #include "Matrices.h"
@@ -17,7 +17,7 @@ class Player : public Entity {
 
 public:
 
-	Player(Model model);
+	Player(Model model, vec3 spawnPosition);
 	void update();
 
 private:
@@ -0,0 +1,46 @@
+#include <sepch.h>
+#include "DrawCommand.h"
+
+void Shmingo::radixSortDrawCommands(std::vector<DrawCommand>& commands, std::vector<DrawCommand>& scratch) {
+
+	size_t commandAmount = commands.size();
+	if (commandAmount < 2) {
+		return;
+	}
+
+	scratch.resize(commandAmount);
+
+	DrawCommand* source = commands.data();
+	DrawCommand* destination = scratch.data();
+
+	for (GLuint shift = 0; shift < 64; shift += 8) {
+
+		size_t counts[256] = {};
+		for (size_t i = 0; i < commandAmount; i++) {
+			counts[(source[i].key >> shift) & 0xFF]++;
+		}
+
+		//Every key shares this digit, order would not change
+		if (counts[(source[0].key >> shift) & 0xFF] == commandAmount) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& count : counts) {
+			size_t bucketSize = count;
+			count = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < commandAmount; i++) {
+			destination[counts[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+
+		std::swap(source, destination);
+	}
+
+	//Odd amount of passes ran, result sits in scratch
+	if (source != commands.data()) {
+		std::memcpy(commands.data(), source, commandAmount * sizeof(DrawCommand));
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+class ShaderProgram;
+class EntityBatch;
+class TextVertexArray;
+class InstancedVertexArray;
+class ChunkVertexArray;
+
+/*
+Sort key layout, most significant bits first. Sorting by key draws passes in order, and inside a pass groups draws by shader, then textures, then VAO,
+so each state only changes when it has to. Fields are truncated to their width, a collision only costs a redundant state change, never a wrong draw.
+*/
+const GLuint DRAW_KEY_PASS_BITS = 4;
+const GLuint DRAW_KEY_SHADER_BITS = 12;
+const GLuint DRAW_KEY_TEXTURE_BITS = 12;
+const GLuint DRAW_KEY_VAO_BITS = 16;
+const GLuint DRAW_KEY_DEPTH_BITS = 20;
+
+const GLuint DRAW_KEY_DEPTH_SHIFT = 0;
+const GLuint DRAW_KEY_VAO_SHIFT = DRAW_KEY_DEPTH_SHIFT + DRAW_KEY_DEPTH_BITS;
+const GLuint DRAW_KEY_TEXTURE_SHIFT = DRAW_KEY_VAO_SHIFT + DRAW_KEY_VAO_BITS;
+const GLuint DRAW_KEY_SHADER_SHIFT = DRAW_KEY_TEXTURE_SHIFT + DRAW_KEY_TEXTURE_BITS;
+const GLuint DRAW_KEY_PASS_SHIFT = DRAW_KEY_SHADER_SHIFT + DRAW_KEY_SHADER_BITS;
+
+namespace Shmingo {
+
+	//Passes are drawn in this order
+	enum RenderPass {
+		WORLD_PASS, //Entities and terrain
+		UI_PASS //Text and menus, drawn over the world
+	};
+
+	enum DrawCommandType {
+		ENTITY_BATCH_DRAW, //Every submitted entity vertex array of a batch
+		TEXT_DRAW,
+		INSTANCED_DRAW,
+		TERRAIN_DRAW,
+		TERRAIN_PULLED_DRAW //Terrain fetched by the shader from storage buffers, see MasterRenderer::setTerrainVertexPulling
+	};
+
+	/*
+	One draw for the frame. Plain data so sorting moves 32 bytes and submitting touches no reference counts.
+	Pointers are not owning, whoever submits a vertex array keeps it alive until the renderer's update has run
+	*/
+	struct DrawCommand {
+
+		uint64_t key;
+		DrawCommandType commandType;
+		ShaderProgram* shader;
+
+		union {
+			EntityBatch* entityBatch;
+			TextVertexArray* textVertexArray;
+			InstancedVertexArray* instancedVertexArray;
+			ChunkVertexArray* chunkVertexArray;
+		};
+	};
+
+	/// <summary>
+	/// Packs draw state into a sort key
+	/// </summary>
+	/// <param name="pass">Pass the draw belongs to</param>
+	/// <param name="shaderID">Program ID of the shader</param>
+	/// <param name="textureSetID">ID of the texture set bound for the draw, 0 if none</param>
+	/// <param name="vaoID">VAO drawn</param>
+	/// <param name="depth">View depth in [0, 1], closer draws sort first</param>
+	inline uint64_t createDrawKey(RenderPass pass, GLuint shaderID, GLuint textureSetID, GLuint vaoID, float depth = 0.0f) {
+
+		uint64_t quantizedDepth = (uint64_t)(std::clamp(depth, 0.0f, 1.0f) * (float)((1u << DRAW_KEY_DEPTH_BITS) - 1));
+
+		return ((uint64_t)(pass & ((1u << DRAW_KEY_PASS_BITS) - 1)) << DRAW_KEY_PASS_SHIFT) |
+			((uint64_t)(shaderID & ((1u << DRAW_KEY_SHADER_BITS) - 1)) << DRAW_KEY_SHADER_SHIFT) |
+			((uint64_t)(textureSetID & ((1u << DRAW_KEY_TEXTURE_BITS) - 1)) << DRAW_KEY_TEXTURE_SHIFT) |
+			((uint64_t)(vaoID & ((1u << DRAW_KEY_VAO_BITS) - 1)) << DRAW_KEY_VAO_SHIFT) |
+			(quantizedDepth << DRAW_KEY_DEPTH_SHIFT);
+	}
+
+	/// <summary>
+	/// Stable LSD radix sort by key, 8 bits per pass. Passes where every key has the same digit are skipped,
+	/// so with few distinct shaders and VAOs most of the 8 passes cost one histogram
+	/// </summary>
+	/// <param name="commands">Commands to sort, sorted in place</param>
+	/// <param name="scratch">Reused between frames to avoid allocating</param>
+	void radixSortDrawCommands(std::vector<DrawCommand>& commands, std::vector<DrawCommand>& scratch);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+#include "EntityVertexArray.h"
+
+namespace Shmingo {
+
+	//Run of instances to copy into one of a vertex array's instance buffers, its bytes are in the packet's instance data
+	struct InstanceUpload {
+
+		GLuint bufferIndex;
+		GLuint offset; //First instance written, in the vertex array's range. For visible uploads a position in the visible list
+		GLuint instanceCount;
+		size_t dataOffset; //Byte offset in FramePacket::instanceData
+	};
+
+	//One entity type's part of a frame packet, everything needed to upload and draw its instances without looking at the simulation's copy
+	struct EntityDrawPacket {
+
+		std::shared_ptr<EntityVertexArray> vertexArray; //Keeps the vertex array alive until the packet has been drawn
+		GLuint instanceAmount = 0;
+		GLuint instanceCapacity = 0; //Capacity the simulation had, the range in the instance buffers is resized to it before uploading
+
+		bool culled = false; //Draws the visible instances grouped by level of detail instead of the whole range, uploads only carry the ones that changed
+		GLuint visibleAmount = 0;
+		std::array<GLuint, ENTITY_LOD_MAX> lodInstanceAmounts = {};
+
+		GLuint firstUpload = 0; //Range of the packet's upload list belonging to this entity type
+		GLuint uploadAmount = 0;
+	};
+
+	/*
+	Render commands of one simulated frame. Recorded by the simulation thread and replayed during the next frame on the thread that owns the GL context.
+	Everything is copied in, so the simulation can run the frame after while the packet is being drawn
+	*/
+	struct FramePacket {
+
+		std::vector<EntityDrawPacket> entityDraws;
+		std::vector<InstanceUpload> instanceUploads;
+		std::vector<uint8_t> instanceData; //Instance bytes copied out of the CPU mirrors
+
+		GLuint entityCount = 0;
+		GLuint visibleEntityCount = 0;
+		bool entityCulling = false;
+
+		//Vectors keep their capacity, so a packet stops allocating once it has recorded a frame as large as the current ones
+		inline void clear() {
+			entityDraws.clear();
+			instanceUploads.clear();
+			instanceData.clear();
+			entityCount = 0;
+			visibleEntityCount = 0;
+		}
+
+		//Appends size bytes of instance data, returns their offset
+		inline size_t allocateInstanceData(size_t size) {
+			size_t offset = instanceData.size();
+			instanceData.resize(offset + size);
+			return offset;
+		}
+	};
+}
@@ -0,0 +1,156 @@
+#include <sepch.h>
+#include "GLStateTracker.h"
+
+GLStateTracker GLStateTracker::instance;
+
+static const GLenum capabilityEnums[Shmingo::CAPABILITY_AMOUNT] = { GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST };
+
+void GLStateTracker::useProgram(GLuint programID) {
+	if (changes(currentProgram != programID)) {
+		glUseProgram(programID);
+		currentProgram = programID;
+	}
+}
+
+void GLStateTracker::bindVertexArray(GLuint vaoID) {
+	if (changes(currentVertexArray != vaoID)) {
+		glBindVertexArray(vaoID);
+		currentVertexArray = vaoID;
+	}
+}
+
+void GLStateTracker::bindTexture(GLuint unit, GLenum target, GLuint textureID) {
+
+	if (unit >= GL_STATE_TEXTURE_UNIT_AMOUNT || (target != GL_TEXTURE_2D && target != GL_TEXTURE_2D_ARRAY)) {
+		setActiveTextureUnit(unit);
+		changes(true);
+		glBindTexture(target, textureID);
+		return;
+	}
+
+	GLuint& boundTexture = target == GL_TEXTURE_2D ? textureUnits[unit].texture2D : textureUnits[unit].texture2DArray;
+
+	if (boundTexture == textureID) {
+		changes(false);
+		return;
+	}
+
+	setActiveTextureUnit(unit);
+	changes(true);
+	glBindTexture(target, textureID);
+	boundTexture = textureID;
+}
+
+void GLStateTracker::bindUniformBufferRange(GLuint bindingPoint, GLuint bufferID, GLintptr offset, GLsizeiptr size) {
+
+	if (bindingPoint >= GL_STATE_UNIFORM_BINDING_AMOUNT) {
+		changes(true);
+		glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, bufferID, offset, size);
+		return;
+	}
+
+	UniformRangeState& range = uniformRanges[bindingPoint];
+
+	if (changes(range.bufferID != bufferID || range.offset != offset || range.size != size)) {
+		glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, bufferID, offset, size);
+		range = UniformRangeState(bufferID, offset, size);
+	}
+}
+
+void GLStateTracker::setCapability(Shmingo::GLCapability capability, bool enabled) {
+
+	if (!changes(capabilities[capability] != (int8_t)enabled)) {
+		return;
+	}
+
+	if (enabled) {
+		glEnable(capabilityEnums[capability]);
+	}
+	else {
+		glDisable(capabilityEnums[capability]);
+	}
+	capabilities[capability] = (int8_t)enabled;
+}
+
+void GLStateTracker::setBlendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+	if (changes(blendSourceFactor != sourceFactor || blendDestinationFactor != destinationFactor)) {
+		glBlendFunc(sourceFactor, destinationFactor);
+		blendSourceFactor = sourceFactor;
+		blendDestinationFactor = destinationFactor;
+	}
+}
+
+void GLStateTracker::enableVertexAttribArray(GLuint index) {
+
+	uint32_t bit = index < 32 ? 1u << index : 0;
+	uint32_t& mask = enabledAttribs[currentVertexArray];
+
+	if (changes(bit == 0 || (mask & bit) == 0)) {
+		glEnableVertexAttribArray(index);
+		mask |= bit;
+	}
+}
+
+void GLStateTracker::vertexArrayDeleted(GLuint vaoID) {
+
+	enabledAttribs.erase(vaoID);
+
+	if (currentVertexArray == vaoID) {
+		currentVertexArray = 0; //Deleting the bound VAO reverts the binding to 0
+	}
+}
+
+void GLStateTracker::programDeleted(GLuint programID) {
+	if (currentProgram == programID) {
+		currentProgram = GL_STATE_UNKNOWN; //A deleted program stays in use until something else is bound
+	}
+}
+
+void GLStateTracker::textureDeleted(GLuint textureID) {
+
+	//Deleting a bound texture reverts every binding of it to 0
+	for (TextureUnitState& unit : textureUnits) {
+		if (unit.texture2D == textureID) {
+			unit.texture2D = 0;
+		}
+		if (unit.texture2DArray == textureID) {
+			unit.texture2DArray = 0;
+		}
+	}
+}
+
+void GLStateTracker::invalidate() {
+
+	currentProgram = GL_STATE_UNKNOWN;
+	currentVertexArray = GL_STATE_UNKNOWN;
+	activeTextureUnit = GL_STATE_UNKNOWN;
+
+	for (TextureUnitState& unit : textureUnits) {
+		unit = TextureUnitState(GL_STATE_UNKNOWN, GL_STATE_UNKNOWN);
+	}
+
+	for (UniformRangeState& range : uniformRanges) {
+		range = UniformRangeState(GL_STATE_UNKNOWN, -1, -1);
+	}
+
+	for (int8_t& capability : capabilities) {
+		capability = -1;
+	}
+
+	blendSourceFactor = GL_STATE_UNKNOWN;
+	blendDestinationFactor = GL_STATE_UNKNOWN;
+
+	enabledAttribs.clear();
+}
+
+void GLStateTracker::endFrame() {
+	lastFrameStats = frameStats;
+	frameStats = Shmingo::GLStateStats();
+}
+
+void GLStateTracker::setActiveTextureUnit(GLuint unit) {
+	if (changes(activeTextureUnit != unit)) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeTextureUnit = unit;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+const GLuint GL_STATE_TEXTURE_UNIT_AMOUNT = 32; //Units shadowed, binds to higher units always go through
+const GLuint GL_STATE_UNIFORM_BINDING_AMOUNT = 16; //Uniform buffer binding points shadowed
+const GLuint GL_STATE_UNKNOWN = 0xFFFFFFFF; //Shadow value that never matches, so the first call after init or invalidate is always issued
+
+namespace Shmingo {
+
+	//Calls that went to the driver and calls skipped because the state was already set
+	struct GLStateStats {
+
+		GLuint issued = 0;
+		GLuint elided = 0;
+	};
+
+	enum GLCapability {
+		BLEND_CAPABILITY,
+		CULL_FACE_CAPABILITY,
+		DEPTH_TEST_CAPABILITY,
+		CAPABILITY_AMOUNT
+	};
+}
+
+/*
+Shadows the GL state the renderer changes per draw, and drops calls that would set what is already set.
+Everything that binds a program, VAO, texture or uniform range, or toggles blend, cull or depth, goes through here, otherwise the shadow goes stale.
+Only used from the thread that owns the context.
+*/
+class GLStateTracker {
+
+public:
+
+	inline static GLStateTracker& get() { return instance; };
+
+	void useProgram(GLuint programID);
+	void bindVertexArray(GLuint vaoID);
+
+	/// <summary>
+	/// Binds a texture to a unit, only switching the active unit if it has to
+	/// </summary>
+	/// <param name="unit">Unit index, not GL_TEXTURE0 + index</param>
+	/// <param name="target">GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY, other targets are not shadowed</param>
+	void bindTexture(GLuint unit, GLenum target, GLuint textureID);
+
+	//Binds a range of a buffer to a uniform block binding point
+	void bindUniformBufferRange(GLuint bindingPoint, GLuint bufferID, GLintptr offset, GLsizeiptr size);
+
+	void setCapability(Shmingo::GLCapability capability, bool enabled);
+	void setBlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+	//Enables an attribute of the bound VAO. Enables are VAO state, so this belongs in VAO setup, not in draws
+	void enableVertexAttribArray(GLuint index);
+
+	//Forget about deleted objects, GL reuses their names
+	void vertexArrayDeleted(GLuint vaoID);
+	void programDeleted(GLuint programID);
+	void textureDeleted(GLuint textureID);
+
+	//Marks every shadowed value unknown, for after code that touched GL state directly
+	void invalidate();
+
+	//Stores this frame's counts and starts counting the next frame
+	void endFrame();
+
+	inline const Shmingo::GLStateStats& getFrameStats() { return lastFrameStats; };
+
+	inline GLuint getCurrentProgram() { return currentProgram; };
+	inline GLuint getCurrentVertexArray() { return currentVertexArray; };
+
+private:
+
+	GLStateTracker() { invalidate(); };
+
+	static GLStateTracker instance;
+
+	struct TextureUnitState {
+
+		GLuint texture2D;
+		GLuint texture2DArray;
+	};
+
+	struct UniformRangeState {
+
+		GLuint bufferID;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	GLuint currentProgram = GL_STATE_UNKNOWN;
+	GLuint currentVertexArray = GL_STATE_UNKNOWN;
+	GLuint activeTextureUnit = GL_STATE_UNKNOWN;
+
+	TextureUnitState textureUnits[GL_STATE_TEXTURE_UNIT_AMOUNT];
+	UniformRangeState uniformRanges[GL_STATE_UNIFORM_BINDING_AMOUNT];
+
+	int8_t capabilities[Shmingo::CAPABILITY_AMOUNT]; //-1 unknown, 0 disabled, 1 enabled
+	GLenum blendSourceFactor = GL_STATE_UNKNOWN;
+	GLenum blendDestinationFactor = GL_STATE_UNKNOWN;
+
+	std::unordered_map<GLuint, uint32_t> enabledAttribs; //Bitmask of enabled attributes per VAO
+
+	Shmingo::GLStateStats frameStats;
+	Shmingo::GLStateStats lastFrameStats;
+
+	void setActiveTextureUnit(GLuint unit);
+
+	//Counts the call and returns true if it has to be issued
+	inline bool changes(bool changed) {
+		changed ? frameStats.issued++ : frameStats.elided++;
+		return changed;
+	}
+};
@@ -0,0 +1,172 @@
+#include <sepch.h>
+#include "GpuTimer.h"
+
+void GpuTimer::cleanUp() {
+
+	if (!initialized) {
+		return;
+	}
+
+	for (FrameQueries& frame : frames) {
+		if (!frame.passQueries.empty()) {
+			glDeleteQueries((GLsizei)frame.passQueries.size(), frame.passQueries.data());
+		}
+		glDeleteQueries(1, &frame.startQuery);
+		glDeleteQueries(1, &frame.endQuery);
+	}
+
+	frames = {};
+	initialized = false;
+}
+
+void GpuTimer::init() {
+
+	for (FrameQueries& frame : frames) {
+		glGenQueries(1, &frame.startQuery);
+		glGenQueries(1, &frame.endQuery);
+	}
+
+	initialized = true;
+}
+
+void GpuTimer::beginFrame() {
+
+	if (!initialized) {
+		return;
+	}
+
+	currentFrame = (currentFrame + 1) % GPU_TIMER_FRAME_AMOUNT;
+	FrameQueries& frame = frames[currentFrame];
+
+	//The slot was issued GPU_TIMER_FRAME_AMOUNT frames ago, if it still is not done the frame is dropped and its queries reused
+	if (frame.pending && !readBack(frame)) {
+		droppedFrameAmount++;
+	}
+
+	frame.usedQueryAmount = 0;
+	frame.queryPasses.clear();
+	frame.pending = false;
+
+	glQueryCounter(frame.startQuery, GL_TIMESTAMP);
+	inFrame = true;
+}
+
+void GpuTimer::beginPass(Shmingo::GpuTimerPass pass) {
+
+	if (!inFrame || (passRunning && runningPass == pass)) {
+		return;
+	}
+
+	endPass(); //GL_TIME_ELAPSED queries can not nest
+
+	FrameQueries& frame = frames[currentFrame];
+
+	if (frame.usedQueryAmount == frame.passQueries.size()) {
+		GLuint queryID = 0;
+		glGenQueries(1, &queryID);
+		frame.passQueries.push_back(queryID);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, frame.passQueries[frame.usedQueryAmount]);
+	frame.queryPasses.push_back(pass);
+	frame.usedQueryAmount++;
+
+	passRunning = true;
+	runningPass = pass;
+}
+
+void GpuTimer::endPass() {
+
+	if (!passRunning) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	passRunning = false;
+}
+
+void GpuTimer::endFrame() {
+
+	if (!inFrame) {
+		return;
+	}
+
+	endPass();
+
+	FrameQueries& frame = frames[currentFrame];
+	glQueryCounter(frame.endQuery, GL_TIMESTAMP);
+	frame.pending = true;
+
+	inFrame = false;
+}
+
+bool GpuTimer::readBack(FrameQueries& frame) {
+
+	//The end timestamp lands after everything else in the frame, but availability is checked per query rather than relying on that
+	GLint available = 0;
+	glGetQueryObjectiv(frame.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return false;
+	}
+
+	for (GLuint i = 0; i < frame.usedQueryAmount; i++) {
+		glGetQueryObjectiv(frame.passQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			return false;
+		}
+	}
+
+	std::array<GLuint64, Shmingo::GPU_TIMER_PASS_AMOUNT> passNanoseconds = {};
+
+	for (GLuint i = 0; i < frame.usedQueryAmount; i++) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(frame.passQueries[i], GL_QUERY_RESULT, &elapsed);
+		passNanoseconds[frame.queryPasses[i]] += elapsed;
+	}
+
+	GLuint64 startTime = 0;
+	GLuint64 endTime = 0;
+	glGetQueryObjectui64v(frame.startQuery, GL_QUERY_RESULT, &startTime);
+	glGetQueryObjectui64v(frame.endQuery, GL_QUERY_RESULT, &endTime);
+
+	//Passes that did not run this frame still get a sample, so their average decays instead of freezing at the last value
+	for (GLuint pass = 0; pass < Shmingo::GPU_TIMER_PASS_AMOUNT; pass++) {
+		passHistories[pass].add((float)((double)passNanoseconds[pass] / 1000000.0));
+	}
+	frameHistory.add(endTime > startTime ? (float)((double)(endTime - startTime) / 1000000.0) : 0.0f);
+
+	return true;
+}
+
+Shmingo::GpuTimerStats GpuTimer::getPassStats(Shmingo::GpuTimerPass pass) {
+	return passHistories[pass].getStats();
+}
+
+Shmingo::GpuTimerStats GpuTimer::getFrameStats() {
+	return frameHistory.getStats();
+}
+
+void GpuTimer::History::add(float sample) {
+
+	samples[nextSample] = sample;
+	nextSample = (nextSample + 1) % GPU_TIMER_HISTORY_AMOUNT;
+	sampleAmount = std::min(sampleAmount + 1, GPU_TIMER_HISTORY_AMOUNT);
+}
+
+Shmingo::GpuTimerStats GpuTimer::History::getStats() {
+
+	Shmingo::GpuTimerStats stats;
+
+	if (sampleAmount == 0) {
+		return stats;
+	}
+
+	float total = 0.0f;
+	for (GLuint i = 0; i < sampleAmount; i++) {
+		total += samples[i];
+		stats.maxMs = std::max(stats.maxMs, samples[i]);
+	}
+	stats.averageMs = total / (float)sampleAmount;
+
+	return stats;
+}
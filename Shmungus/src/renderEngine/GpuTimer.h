@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+const GLuint GPU_TIMER_FRAME_AMOUNT = 3; //Frames of queries in flight, results are read back this many frames late so reading never waits on the GPU
+const GLuint GPU_TIMER_HISTORY_AMOUNT = 60; //Frames the averages and maxima are taken over
+
+namespace Shmingo {
+
+	//Parts of the frame that are timed separately
+	enum GpuTimerPass {
+		UPLOAD_TIMER_PASS, //Instance data copies before the draws
+		ENTITY_TIMER_PASS,
+		TERRAIN_TIMER_PASS,
+		TEXT_TIMER_PASS,
+		MENU_TIMER_PASS, //Instanced menu elements
+		GPU_TIMER_PASS_AMOUNT
+	};
+
+	//Rolling GPU time over the last GPU_TIMER_HISTORY_AMOUNT frames that were read back, in milliseconds
+	struct GpuTimerStats {
+
+		float averageMs = 0.0f;
+		float maxMs = 0.0f;
+	};
+}
+
+/*
+Measures how long the GPU spends on each pass of a frame. Every run of draws of the same pass is wrapped in a GL_TIME_ELAPSED query,
+and the whole frame is bracketed by two glQueryCounter timestamps.
+Queries are kept in a ring GPU_TIMER_FRAME_AMOUNT frames deep. A frame's results are only read once its slot comes around again,
+and only if the GPU has made them available, otherwise the frame is dropped from the statistics instead of stalling.
+Only used from the thread that owns the context.
+*/
+class GpuTimer {
+
+public:
+
+	GpuTimer() {};
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	//Needs a current GL context
+	void init();
+
+	//Deletes the queries, needs the context init ran with. Not done on destruction, the timer lives in a static that outlives the context
+	void cleanUp();
+
+	//Reads back the frame that last used this slot if the GPU is done with it, then starts timing a new frame
+	void beginFrame();
+
+	/// <summary>
+	/// Times what is issued from here on as part of pass. Does nothing if pass is already being timed, so consecutive draws of a pass share one query
+	/// </summary>
+	void beginPass(Shmingo::GpuTimerPass pass);
+
+	//Ends the running pass, what is issued afterwards is only counted in the frame total
+	void endPass();
+
+	void endFrame();
+
+	Shmingo::GpuTimerStats getPassStats(Shmingo::GpuTimerPass pass);
+
+	//Time between the frame's first and last timestamp, including GPU work outside any pass
+	Shmingo::GpuTimerStats getFrameStats();
+
+	//Frames whose results were not available when their slot came around again, nonzero means the GPU runs more than GPU_TIMER_FRAME_AMOUNT frames behind
+	inline GLuint getDroppedFrameAmount() { return droppedFrameAmount; };
+
+private:
+
+	struct FrameQueries {
+
+		std::vector<GLuint> passQueries; //Pooled, grows to the most pass switches seen in a frame
+		std::vector<Shmingo::GpuTimerPass> queryPasses; //Pass each used query timed
+		GLuint usedQueryAmount = 0;
+
+		GLuint startQuery = 0;
+		GLuint endQuery = 0;
+		bool pending = false; //Issued and not read back yet
+	};
+
+	//Samples of one measured value, in milliseconds
+	struct History {
+
+		std::array<float, GPU_TIMER_HISTORY_AMOUNT> samples = {};
+		GLuint sampleAmount = 0;
+		GLuint nextSample = 0;
+
+		void add(float sample);
+		Shmingo::GpuTimerStats getStats();
+	};
+
+	std::array<FrameQueries, GPU_TIMER_FRAME_AMOUNT> frames;
+	GLuint currentFrame = 0;
+
+	bool initialized = false;
+	bool inFrame = false;
+	bool passRunning = false;
+	Shmingo::GpuTimerPass runningPass = Shmingo::UPLOAD_TIMER_PASS;
+
+	std::array<History, Shmingo::GPU_TIMER_PASS_AMOUNT> passHistories;
+	History frameHistory;
+
+	GLuint droppedFrameAmount = 0;
+
+	//Adds the frame's results to the histories if all of them are available, returns false without waiting otherwise
+	bool readBack(FrameQueries& frame);
+};
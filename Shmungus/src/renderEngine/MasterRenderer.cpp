@@ -2,6 +2,8 @@
 
 #include "MasterRenderer.h"
 #include "ShmingoApp.h"
+#include "MiscTools.h"
+#include "ModelTools.h"
 
 UniformBuffer UniformBuffer::instance;
 
@@ -16,106 +18,233 @@ UniformBuffer UniformBuffer::instance;
 void MasterRenderer::init() {
 
 	se_uniformBuffer.init();
+	instanceStreamBuffer.init(INSTANCE_STREAM_REGION_SIZE);
+	gpuTimer.init();
 
 	std::shared_ptr<DefaultShader> entityShader = std::make_shared<DefaultShader>("entityVertex.glsl", "entityFragment.glsl");
 	std::shared_ptr<DefaultShader> textShader = std::make_shared<DefaultShader>("text/textVertex.glsl", "text/textFragment.glsl");
 	std::shared_ptr<DefaultShader> menuShader = std::make_shared<DefaultShader>("menu/menuVertex.glsl", "menu/menuFragment.glsl");
 	std::shared_ptr<DefaultShader> terrainShader = std::make_shared<DefaultShader>("terrain/terrainVertex.glsl", "terrain/terrainFragment.glsl");
+	std::shared_ptr<DefaultShader> terrainPulledShader = std::make_shared<DefaultShader>("terrain/terrainPulledVertex.glsl", "terrain/terrainFragment.glsl");
 
 	entityShader->bindUniformBlocks(Shmingo::MATRIX_BLOCK, Shmingo::UTIL_BLOCK);
 	textShader->bindUniformBlocks(Shmingo::MATRIX_BLOCK);
 	menuShader->bindUniformBlocks(Shmingo::MATRIX_BLOCK);
 	terrainShader->bindUniformBlocks(Shmingo::MATRIX_BLOCK);
+	terrainPulledShader->bindUniformBlocks(Shmingo::MATRIX_BLOCK);
 
 	mapShader(se_ENTITY_SHADER, entityShader);
 	mapShader(se_TEXT_SHADER, textShader);
 	mapShader(se_MENU_SHADER, menuShader);
 	mapShader(se_TERRAIN_SHADER, terrainShader);
+	mapShader(se_TERRAIN_PULLED_SHADER, terrainPulledShader);
+
+	ChunkVertexArray::setUniforms(); //Orientation tables never change, every chunk shares them
 
 	mapEntityShader(Shmingo::DefaultEntity, entityShader);
 
-	declareShaderTextureMap(se_ENTITY_SHADER, 32);
+	declareShaderTextureMap(se_ENTITY_SHADER, TEXTURE_REGISTRY_ARRAY_MAX);
 }
 
 
+void MasterRenderer::cleanUp() {
+
+	gpuTimer.cleanUp();
+	textureRegistry.cleanUp();
+	instanceStreamBuffer.cleanUp();
+
+	entityBatches.clear(); //The world's vertex arrays are gone by now, so this drops the last owner of every batch and its VAOs
+	entityMeshPool.cleanUp();
+}
+
 void MasterRenderer::declareShaderTextureMap(ShaderType type, int textureSlotAmount){
 
 	shaderMap.at(type)->loadTextureMap(textureSlotAmount);
 }
 
 
-void MasterRenderer::submitEntityVertexArray(std::shared_ptr<EntityVertexArray> vertexArray){
+void MasterRenderer::submitEntityVertexArray(const std::shared_ptr<EntityVertexArray>& vertexArray){
 
-	EntityRenderPair pair = EntityRenderPair(vertexArray, getEntityShader(vertexArray->getEntityType()));
-	entityRenderQueue.emplace_back(pair);
+	EntityBatch& batch = vertexArray->getBatch();
+
+	//One draw command per batch, the batch collects its vertex arrays and draws them all at once
+	if (!batch.submit(vertexArray.get())) {
+		return;
+	}
+
+	//Every entity draw binds the same texture arrays, so textures never split or reorder entity draws
+	Shmingo::DrawCommand command;
+	command.key = Shmingo::createDrawKey(Shmingo::WORLD_PASS, batch.getShader()->getProgramID(), 0, batch.getVaoID());
+	command.commandType = Shmingo::ENTITY_BATCH_DRAW;
+	command.shader = batch.getShader();
+	command.entityBatch = &batch;
+
+	drawCommands.emplace_back(command);
 }
 
-void MasterRenderer::submitInstancedVertexArray(std::shared_ptr<InstancedVertexArray> vertexArray, ShaderType type){
-	InstancedRenderPair pair = InstancedRenderPair(vertexArray, shaderMap.at(type));
-	instancedRenderQueue.emplace_back(pair);
+void MasterRenderer::submitInstancedVertexArray(const std::shared_ptr<InstancedVertexArray>& vertexArray, ShaderType type){
+
+	ShaderProgram* shader = shaderMap.at(type).get();
+
+	Shmingo::DrawCommand command;
+	command.key = Shmingo::createDrawKey(Shmingo::UI_PASS, shader->getProgramID(), 0, vertexArray->getVaoID());
+	command.commandType = Shmingo::INSTANCED_DRAW;
+	command.shader = shader;
+	command.instancedVertexArray = vertexArray.get();
+
+	drawCommands.emplace_back(command);
 }
 
-void MasterRenderer::submitTerrainVertexArray(std::shared_ptr<ChunkVertexArray> vertexArray, ShaderType type){
-	TerrainRenderPair pair = TerrainRenderPair(vertexArray, shaderMap.at(type));
-	terrainRenderQueue.emplace_back(pair);
+void MasterRenderer::submitTerrainVertexArray(const std::shared_ptr<ChunkVertexArray>& vertexArray, ShaderType type){
+
+	//The engine's terrain shader has a vertex pulling twin, custom terrain shaders always draw instanced
+	bool pulled = terrainVertexPulling && type == se_TERRAIN_SHADER;
+	ShaderProgram* shader = shaderMap.at(pulled ? se_TERRAIN_PULLED_SHADER : type).get();
+
+	Shmingo::DrawCommand command;
+	command.key = Shmingo::createDrawKey(Shmingo::WORLD_PASS, shader->getProgramID(), 0, pulled ? vertexArray->getPulledVaoID() : vertexArray->getVaoID());
+	command.commandType = pulled ? Shmingo::TERRAIN_PULLED_DRAW : Shmingo::TERRAIN_DRAW;
+	command.shader = shader;
+	command.chunkVertexArray = vertexArray.get();
+
+	drawCommands.emplace_back(command);
 }
 
 
-void MasterRenderer::submitTextVertexArray(std::shared_ptr<TextVertexArray> vertexArray, ShaderType type) {
-	TextRenderPair pair = TextRenderPair(vertexArray, shaderMap.at(type));
-	textRenderQueue.emplace_back(pair);
+void MasterRenderer::submitTextVertexArray(const std::shared_ptr<TextVertexArray>& vertexArray, ShaderType type) {
+	submitTextVertexArray(vertexArray, shaderMap.at(type));
 }
 
-void MasterRenderer::submitTextVertexArray(std::shared_ptr<TextVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
-	TextRenderPair pair = TextRenderPair(vertexArray, shader);
-	textRenderQueue.emplace_back(pair);
+void MasterRenderer::submitTextVertexArray(const std::shared_ptr<TextVertexArray>& vertexArray, const std::shared_ptr<ShaderProgram>& shader){
+
+	Shmingo::DrawCommand command;
+	command.key = Shmingo::createDrawKey(Shmingo::UI_PASS, shader->getProgramID(), se_application.getFontTextureArrayID(vertexArray->getFont()), vertexArray->getVaoID());
+	command.commandType = Shmingo::TEXT_DRAW;
+	command.shader = shader.get();
+	command.textVertexArray = vertexArray.get();
+
+	drawCommands.emplace_back(command);
 }
 
 
-void MasterRenderer::renderInstancedBatch(){
-	for (InstancedRenderPair pair : instancedRenderQueue) {
-		//Uses render method from renderer.h
-		Shmingo::renderInstanced(pair.vertexArray, pair.shader);
+void MasterRenderer::flushEntityInstanceData(){
+
+	frameUploadStats = Shmingo::InstanceFlushStats();
+
+	for (const Shmingo::DrawCommand& command : drawCommands) {
+
+		if (command.commandType != Shmingo::ENTITY_BATCH_DRAW) {
+			continue;
+		}
+
+		//Everything the entities changed in the recorded frame goes up in one merged pass per vertex array. Culled frames carry the visible instances
+		//that changed instead, so the stats count what was sent either way
+		for (EntityVertexArray* vertexArray : command.entityBatch->getSubmitted()) {
+			Shmingo::InstanceFlushStats stats = vertexArray->uploadFrameInstances();
+			frameUploadStats.bytes += stats.bytes;
+			frameUploadStats.calls += stats.calls;
+		}
 	}
 }
 
-void MasterRenderer::renderEntityBatch(){
-	for (EntityRenderPair pair : entityRenderQueue) {
-		//Uses render method from renderer.h
-		Shmingo::renderEntity(pair.vertexArray, pair.shader);
+void MasterRenderer::submitDrawCommands(){
+
+	Shmingo::radixSortDrawCommands(drawCommands, drawCommandScratch);
+
+	ShaderProgram* currentShader = nullptr;
+
+	for (const Shmingo::DrawCommand& command : drawCommands) {
+
+		if (command.shader != currentShader) {
+			command.shader->start();
+			currentShader = command.shader;
+		}
+
+		//Uses draw methods from renderer.h
+		switch (command.commandType) {
+
+		case Shmingo::ENTITY_BATCH_DRAW:
+			gpuTimer.beginPass(Shmingo::ENTITY_TIMER_PASS);
+			Shmingo::drawEntityBatch(*command.entityBatch);
+			break;
+
+		case Shmingo::TEXT_DRAW:
+			gpuTimer.beginPass(Shmingo::TEXT_TIMER_PASS);
+			Shmingo::drawText(*command.textVertexArray, *command.shader);
+			break;
+
+		case Shmingo::INSTANCED_DRAW:
+			gpuTimer.beginPass(Shmingo::MENU_TIMER_PASS);
+			Shmingo::drawInstanced(*command.instancedVertexArray);
+			break;
+
+		case Shmingo::TERRAIN_DRAW:
+			gpuTimer.beginPass(Shmingo::TERRAIN_TIMER_PASS);
+			Shmingo::drawTerrain(*command.chunkVertexArray);
+			break;
+
+		case Shmingo::TERRAIN_PULLED_DRAW:
+			gpuTimer.beginPass(Shmingo::TERRAIN_TIMER_PASS);
+			Shmingo::drawTerrainPulled(*command.chunkVertexArray);
+			break;
+		}
 	}
-}
 
-void MasterRenderer::renderTextBatch() {
-	for (TextRenderPair pair : textRenderQueue) {
-		//Uses render method from renderer.h
-		Shmingo::renderText(pair.vertexArray, pair.shader);
+	gpuTimer.endPass();
+
+	if (currentShader != nullptr) {
+		currentShader->stop();
 	}
 }
 
-void MasterRenderer::renderTerrainBatch(){
-	for (TerrainRenderPair pair : terrainRenderQueue) {
-		//Uses render method from renderer.h
-		Shmingo::renderTerrain(pair.vertexArray, pair.shader);
+void MasterRenderer::clearDrawCommands() {
+
+	for (const Shmingo::DrawCommand& command : drawCommands) {
+		if (command.commandType == Shmingo::ENTITY_BATCH_DRAW) {
+			command.entityBatch->clearSubmitted();
+		}
 	}
-}
 
-void MasterRenderer::clearBatches() {
-	entityRenderQueue.clear();
-	textRenderQueue.clear();
-	instancedRenderQueue.clear();
-	terrainRenderQueue.clear();
+	drawCommands.clear();
 }
 
-//Renders the queue then clears it for next frame
+//Renders the draw list then clears it for next frame
 void MasterRenderer::update() {
 
-	renderEntityBatch();
-	renderTextBatch();
-	renderInstancedBatch();
-	renderTerrainBatch();
+	instanceStreamBuffer.beginFrame();
+	gpuTimer.beginFrame();
+
+	gpuTimer.beginPass(Shmingo::UPLOAD_TIMER_PASS);
+	flushEntityInstanceData();
+	gpuTimer.endPass();
+
+	submitDrawCommands();
+
+	gpuTimer.endFrame();
+	instanceStreamBuffer.endFrame();
+
+	clearDrawCommands();
 
-	clearBatches();
+	se_glState.endFrame(); //Counts state changes from the whole frame, including layer and loading code that ran before the draws
+
+	if (Shmingo::isTimeMultipleOf(0.2)) {
+		se_application.setApplicationInfo(Shmingo::INSTANCE_UPLOAD_BYTES, std::to_string(frameUploadStats.bytes));
+		se_application.setApplicationInfo(Shmingo::INSTANCE_UPLOAD_CALLS, std::to_string(frameUploadStats.calls));
+		se_application.setApplicationInfo(Shmingo::GL_CALLS_ISSUED, std::to_string(se_glState.getFrameStats().issued));
+		se_application.setApplicationInfo(Shmingo::GL_CALLS_ELIDED, std::to_string(se_glState.getFrameStats().elided));
+
+		se_application.setApplicationInfo(Shmingo::GPU_FRAME_TIME, formatGpuTime(gpuTimer.getFrameStats()));
+		se_application.setApplicationInfo(Shmingo::GPU_UPLOAD_TIME, formatGpuTime(gpuTimer.getPassStats(Shmingo::UPLOAD_TIMER_PASS)));
+		se_application.setApplicationInfo(Shmingo::GPU_ENTITY_TIME, formatGpuTime(gpuTimer.getPassStats(Shmingo::ENTITY_TIMER_PASS)));
+		se_application.setApplicationInfo(Shmingo::GPU_TERRAIN_TIME, formatGpuTime(gpuTimer.getPassStats(Shmingo::TERRAIN_TIMER_PASS)));
+		se_application.setApplicationInfo(Shmingo::GPU_TEXT_TIME, formatGpuTime(gpuTimer.getPassStats(Shmingo::TEXT_TIMER_PASS)));
+		se_application.setApplicationInfo(Shmingo::GPU_MENU_TIME, formatGpuTime(gpuTimer.getPassStats(Shmingo::MENU_TIMER_PASS)));
+	}
+}
+
+//Average and maximum in milliseconds, as "average/max" with two decimals each
+std::string MasterRenderer::formatGpuTime(const Shmingo::GpuTimerStats& stats) {
+	return std::to_string(stats.averageMs).substr(0, 4) + "/" + std::to_string(stats.maxMs).substr(0, 4);
 }
 
 
@@ -141,54 +270,31 @@ void MasterRenderer::mapInstancedShader(ShaderType type, std::shared_ptr<ShaderP
 }
 
 /// <summary>
-/// Returns a vector of information about each vertex attribute for a specific entity type
-/// </summary>
-/// <param name="type"></param>
-/// <returns></returns>
-
-/// <summary>
-/// Returns a reference to the stored vector of information about each vertex attribute for a specific entity type
+/// Returns the per instance attribute layout of an entity type
 /// </summary>
 /// <param name="type"></param>
 /// <returns></returns>
-
-std::vector<Shmingo::EntitySpecificInstanceDataInfo> MasterRenderer::getEntitySpecificInstanceAttributeInfo(Shmingo::EntityType type) {
-	return entityUniformMap.at(type);
-}
-
-std::vector<Shmingo::EntitySpecificInstanceDataInfo>& MasterRenderer::getEntitySpecificInstanceAttributeInfoRef(Shmingo::EntityType type) {
-	return entityUniformMap.at(type);
+const Shmingo::InstanceLayoutInfo& MasterRenderer::getEntityInstanceLayout(Shmingo::EntityType type) {
+	return entityInstanceLayoutMap.at(type);
 }
 
-/// <summary>
-/// Returns the amount of entity specific attributes for an entity type, major is amount of actual attributes, total is the amount of attributes including excess attribute lists corresponding to the same attribute
-/// </summary>
-/// <param name="type">Entity type</param>
-/// <returns></returns>
-
-//Gets amount of uniforms for a specific entity type
-GLuint MasterRenderer::getEntitySpecificMajorInstanceAttribAmount(Shmingo::EntityType type) {
-		return entitySpecificInstanceAttribAmountMap.at(type).front();
-}
-GLuint MasterRenderer::getEntitySpecificTotalInstanceAttribAmount(Shmingo::EntityType type) {
-		return entitySpecificInstanceAttribAmountMap.at(type).back();
+Shmingo::InstanceStorage MasterRenderer::getEntityInstanceStorage(Shmingo::EntityType type) {
+	return entityInstanceStorageMap.at(type);
 }
 
 /// <summary>
-/// Declares the vertex attributes for a specific entity type
+/// Declares the per instance attribute layout of an entity type
 /// </summary>
 /// <param name="type"></param>
-/// <param name="attributeInfo">
-/// Vector of information about each vertex attribute for the entity type in a vector
+/// <param name="layout">
+/// Runtime view of the entity class's InstanceLayout
 /// </param>
-
-void MasterRenderer::declareEntityInstanceAttributes(Shmingo::EntityType type, std::vector<Shmingo::EntitySpecificInstanceDataInfo> uniformInfo) {
-	entityUniformMap.insert(std::make_pair(type, uniformInfo));
-}
-
-void MasterRenderer::declareEntitySpecificInstanceAttribAmount(Shmingo::EntityType type, GLuint majorAmount, GLuint totalAmount) {
-	std::list<GLuint> list = { majorAmount, totalAmount };
-	entitySpecificInstanceAttribAmountMap.insert(std::make_pair(type, list));
+/// <param name="storage">
+/// Separate buffers suit types where few attributes change at once, interleaved suits types that rewrite most of their record every update
+/// </param>
+void MasterRenderer::declareEntityInstanceLayout(Shmingo::EntityType type, Shmingo::InstanceLayoutInfo layout, Shmingo::InstanceStorage storage) {
+	entityInstanceLayoutMap.insert(std::make_pair(type, layout));
+	entityInstanceStorageMap.insert(std::make_pair(type, storage));
 }
 
 /// <summary>
@@ -204,6 +310,41 @@ std::shared_ptr<Model> MasterRenderer::getEntityModel(Shmingo::EntityType type){
 	return entityModelMap.at(type);
 }
 
+void MasterRenderer::declareEntityTexture(Shmingo::EntityType type, Shmingo::TextureHandle texture) {
+	entityTextureMap.insert_or_assign(type, texture);
+}
+
+Shmingo::TextureHandle MasterRenderer::getEntityTexture(Shmingo::EntityType type) {
+
+	auto it = entityTextureMap.find(type);
+	return it == entityTextureMap.end() ? Shmingo::TextureHandle() : it->second;
+}
+
+const std::vector<std::shared_ptr<Model>>& MasterRenderer::getModelLodChain(const std::shared_ptr<Model>& model) {
+
+	auto it = modelLodChains.find(model.get());
+
+	if (it == modelLodChains.end()) {
+		it = modelLodChains.insert(std::make_pair(model.get(), Shmingo::createLodChain(model, ENTITY_LOD_MAX))).first;
+	}
+
+	return it->second;
+}
+
+std::shared_ptr<EntityBatch> MasterRenderer::getEntityBatch(Shmingo::EntityType type, Shmingo::InstanceStorage storage) {
+
+	ShaderProgram* shader = entityShaderMap.at(type).get();
+	const Shmingo::InstanceLayoutInfo& layout = getEntityInstanceLayout(type);
+
+	for (const std::shared_ptr<EntityBatch>& batch : entityBatches) {
+		if (batch->isCompatible(shader, layout, storage)) {
+			return batch;
+		}
+	}
+
+	return entityBatches.emplace_back(std::make_shared<EntityBatch>(shader, layout, storage));
+}
+
 std::shared_ptr<ShaderProgram> MasterRenderer::getEntityShader(Shmingo::EntityType type){
 	return entityShaderMap.at(type);
 }
@@ -2,12 +2,21 @@
 
 #include <ShmingoCore.h>
 #include <typeindex>
+#include <list>
 
-#include "RenderPair.h"
+#include "DrawCommand.h"
 #include "Renderer.h"
 #include "DefaultShader.h"
 #include "UniformBuffer.h"
 #include "ChunkVertexArray.h"
+#include "StreamBuffer.h"
+#include "EntityMeshPool.h"
+#include "EntityBatch.h"
+#include "GLStateTracker.h"
+#include "GpuTimer.h"
+#include "TextureRegistry.h"
+
+const GLsizeiptr INSTANCE_STREAM_REGION_SIZE = 8 * 1024 * 1024; //Bytes of instance data that can be staged per frame, larger flushes upload directly
 
 
 class MasterRenderer {
@@ -18,41 +27,78 @@ public:
 
 	//Meant for initializing the maps, all shaders and renderers should be added to the map in this function
 	void init();
+	//Frees the renderer's own GL objects. Called before the window and its context are destroyed, the renderer itself is a static that outlives them
+	void cleanUp();
 	//This function is how you render an object using shaders provided by the engine, custom shaders pass in a custom shader object in a shared pointer
 	//Meant for shaders added by modders, which do not have a corresponding ShaderType enum. Pass the object directly into the function
-	void submitTextVertexArray(std::shared_ptr<TextVertexArray> vertexArray, ShaderType type);
-	void submitTextVertexArray(std::shared_ptr<TextVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader);
+	//Submitted vertex arrays are not retained, the caller keeps them alive until update has run this frame
+	void submitTextVertexArray(const std::shared_ptr<TextVertexArray>& vertexArray, ShaderType type);
+	void submitTextVertexArray(const std::shared_ptr<TextVertexArray>& vertexArray, const std::shared_ptr<ShaderProgram>& shader);
 
-	void submitEntityVertexArray(std::shared_ptr<EntityVertexArray> vertexArray);
+	//The vertex array must have begun a frame draw, see EntityVertexArray::beginFrameDraw. Its packet has to outlive update
+	void submitEntityVertexArray(const std::shared_ptr<EntityVertexArray>& vertexArray);
 
-	void submitInstancedVertexArray(std::shared_ptr<InstancedVertexArray> vertexArray, ShaderType type);
+	void submitInstancedVertexArray(const std::shared_ptr<InstancedVertexArray>& vertexArray, ShaderType type);
 
-	void submitTerrainVertexArray(std::shared_ptr<ChunkVertexArray> vertexArray, ShaderType type);
+	void submitTerrainVertexArray(const std::shared_ptr<ChunkVertexArray>& vertexArray, ShaderType type);
 
 
 	void update();
 
-	void renderInstancedBatch();
-	void renderEntityBatch();
-	void renderTextBatch();
-	void renderTerrainBatch();
+	//Uploads the dirty instance data of every submitted entity vertex array, before any draw so copies and draws don't interleave
+	void flushEntityInstanceData();
+
+	//Sorts the draw list by key and issues every draw, the shader is only switched when the key's shader changes
+	void submitDrawCommands();
+
+	void clearDrawCommands();
+
+	//Staging ring every per frame instance upload goes through
+	inline StreamBuffer& getInstanceStreamBuffer() { return instanceStreamBuffer; };
+
+	//Shared vertex and index buffers of every entity model
+	inline EntityMeshPool& getEntityMeshPool() { return entityMeshPool; };
+
+	//Texture arrays every entity draw samples from
+	inline TextureRegistry& getTextureRegistry() { return textureRegistry; };
+
+	//Batch drawing an entity type with the given storage, created on first use. Types with the same shader and instance layout share one
+	std::shared_ptr<EntityBatch> getEntityBatch(Shmingo::EntityType type, Shmingo::InstanceStorage storage);
+
+	//Instance data uploaded while flushing entity vertex arrays this frame
+	inline Shmingo::InstanceFlushStats getFrameUploadStats() { return frameUploadStats; };
 
-	void clearBatches();
+	//GPU time of each pass, read back a few frames late
+	inline GpuTimer& getGpuTimer() { return gpuTimer; };
+
+	//With culling, worlds record only the visible instances of each entity type into their frame packets. Takes effect with the next recorded frame
+	inline void setEntityCulling(bool enabled) { entityCulling = enabled; };
+	inline bool isEntityCullingEnabled() { return entityCulling; };
+
+	//With vertex pulling, terrain submitted with se_TERRAIN_SHADER is drawn as one non instanced draw that fetches its triangles from storage buffers,
+	//otherwise as one 3 vertex instance per triangle. Takes effect with the next submitted terrain
+	inline void setTerrainVertexPulling(bool enabled) { terrainVertexPulling = enabled; };
+	inline bool isTerrainVertexPullingEnabled() { return terrainVertexPulling; };
 
 
 	//----------------------------------Related to entity instance attributes--------------------------------------
-	std::vector<Shmingo::EntitySpecificInstanceDataInfo> getEntitySpecificInstanceAttributeInfo(Shmingo::EntityType type);
-	std::vector<Shmingo::EntitySpecificInstanceDataInfo>& getEntitySpecificInstanceAttributeInfoRef(Shmingo::EntityType type);
-	GLuint getEntitySpecificMajorInstanceAttribAmount(Shmingo::EntityType type);
-	GLuint getEntitySpecificTotalInstanceAttribAmount(Shmingo::EntityType type);
+	const Shmingo::InstanceLayoutInfo& getEntityInstanceLayout(Shmingo::EntityType type);
+	Shmingo::InstanceStorage getEntityInstanceStorage(Shmingo::EntityType type);
 
-	void declareEntityInstanceAttributes(Shmingo::EntityType type, std::vector<Shmingo::EntitySpecificInstanceDataInfo> uniformInfo);
-	void declareEntitySpecificInstanceAttribAmount(Shmingo::EntityType type, GLuint majorAmount, GLuint totalAmount);
+	void declareEntityInstanceLayout(Shmingo::EntityType type, Shmingo::InstanceLayoutInfo layout, Shmingo::InstanceStorage storage = Shmingo::SEPARATE_INSTANCE_BUFFERS);
 
 	//----------------------------------Related to entity models--------------------------------------
 	void declareEntityModel(Shmingo::EntityType type, std::shared_ptr<Model> model);
 	std::shared_ptr<Model> getEntityModel(Shmingo::EntityType type);
 
+	//----------------------------------Related to entity textures--------------------------------------
+	//Texture new instances of the type start with, a handle from the texture registry
+	void declareEntityTexture(Shmingo::EntityType type, Shmingo::TextureHandle texture);
+	Shmingo::TextureHandle getEntityTexture(Shmingo::EntityType type);
+
+	//Levels of detail of a model, simplified the first time they are asked for. The first level is the model itself
+	const std::vector<std::shared_ptr<Model>>& getModelLodChain(const std::shared_ptr<Model>& model);
+
 	std::shared_ptr<ShaderProgram> getEntityShader(Shmingo::EntityType type); //Get an entity type's shader
 	std::shared_ptr<ShaderProgram> getShader(ShaderType type); //Get an entity type's shader
 
@@ -69,14 +115,25 @@ private:
 	//Used to set sampler uniform
 	void declareShaderTextureMap(ShaderType type, int textureSlotAmount);
 
+	static std::string formatGpuTime(const Shmingo::GpuTimerStats& stats);
+
 	MasterRenderer() {};
 
 	static MasterRenderer instance;
 
-	std::vector<EntityRenderPair> entityRenderQueue; 
-	std::vector<TextRenderPair> textRenderQueue; 
-	std::vector<InstancedRenderPair> instancedRenderQueue;
-	std::vector<TerrainRenderPair> terrainRenderQueue;
+	std::vector<Shmingo::DrawCommand> drawCommands; //Every draw of the frame, in submission order until sorted
+	std::vector<Shmingo::DrawCommand> drawCommandScratch; //Radix sort buffer
+
+	Shmingo::InstanceFlushStats frameUploadStats;
+	StreamBuffer instanceStreamBuffer;
+	GpuTimer gpuTimer;
+
+	bool entityCulling = true;
+	bool terrainVertexPulling = true;
+
+	EntityMeshPool entityMeshPool;
+	TextureRegistry textureRegistry;
+	std::vector<std::shared_ptr<EntityBatch>> entityBatches;
 
 	std::map<ShaderType, std::shared_ptr<ShaderProgram>> shaderMap;
 	std::map<ShaderType, std::shared_ptr<ShaderProgram>> instancedShaderMap;
@@ -85,10 +142,12 @@ private:
 	std::unordered_map<Shmingo::EntityType, std::list<GLuint>> entitySpecificVertexAttribAmountMap;
 
 
-	std::unordered_map<Shmingo::EntityType, std::vector<Shmingo::EntitySpecificInstanceDataInfo>> entityUniformMap;
-	std::unordered_map<Shmingo::EntityType, std::list<GLuint>> entitySpecificInstanceAttribAmountMap;
+	std::unordered_map<Shmingo::EntityType, Shmingo::InstanceLayoutInfo> entityInstanceLayoutMap;
+	std::unordered_map<Shmingo::EntityType, Shmingo::InstanceStorage> entityInstanceStorageMap;
 
 
 	std::unordered_map<Shmingo::EntityType, std::shared_ptr<Model>> entityModelMap;
+	std::unordered_map<Shmingo::EntityType, Shmingo::TextureHandle> entityTextureMap;
+	std::unordered_map<Model*, std::vector<std::shared_ptr<Model>>> modelLodChains;
 	std::unordered_map<Shmingo::EntityType, std::shared_ptr<ShaderProgram>> entityShaderMap;
 };
\ No newline at end of file
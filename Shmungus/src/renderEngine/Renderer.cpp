@@ -6,94 +6,107 @@
 #include "TextureTools.h"
 #include "Layer.h"
 #include "ShmingoApp.h"
-
-void enableAttribs(size_t attribAmount) {
-	for (GLuint i = 0; i < attribAmount; i++) {
-		glEnableVertexAttribArray(i);
-	}
-}
-
-void disableAttribs(size_t attribAmount) {
-	for (size_t i = 0; i < attribAmount; i++) {
-		glDisableVertexAttribArray(i);
-	}
-}
-
+#include "GLStateTracker.h"
+#include "MasterRenderer.h"
 
 void Shmingo::renderEntity(std::shared_ptr<EntityVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader) {
 
 	shader->start(); //Start shader
+	drawEntity(*vertexArray);
+	shader->stop(); //Stop shader
+}
 
-	vertexArray->bindTextures(); //Load textures into texture slots
-
-	glBindVertexArray(vertexArray->getVaoID()); //Bind VAO
-	enableAttribs(7); //Enable attribute arrays
+void Shmingo::renderText(std::shared_ptr<TextVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
 
-	glDrawElementsInstanced(GL_TRIANGLES, vertexArray->getIndexCount(), GL_UNSIGNED_INT, 0, vertexArray->getInstanceAmount());
+	shader->start();
+	drawText(*vertexArray, *shader);
+	shader->stop(); //Stop shader
+}
 
-	disableAttribs(vertexArray->getAttribAmount()); //Disable attribute arrays
-	glBindVertexArray(0); //Unbind VAO
+void Shmingo::renderInstanced(std::shared_ptr<InstancedVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
 
+	shader->start();
+	drawInstanced(*vertexArray);
 	shader->stop(); //Stop shader
-
 }
 
-void Shmingo::renderText(std::shared_ptr<TextVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
+void Shmingo::renderTerrain(std::shared_ptr<ChunkVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
 
 	shader->start();
+	drawTerrain(*vertexArray);
+	shader->stop(); //Stop shader
+}
 
-	Shmingo::bindFontTextureToShader(shader, vertexArray->getFont());
 
-	glBindVertexArray(vertexArray->getVaoID()); //Bind VAO
 
-	enableAttribs(6);
-	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 6, (GLsizei)vertexArray->getInstanceAmount());
-	disableAttribs(vertexArray->getAttribAmount()); //Disable attribute arrays
-	glBindVertexArray(0); //Unbind VAO
+void Shmingo::drawEntity(EntityVertexArray& vertexArray) {
 
-	shader->stop(); //Stop shader
+	se_masterRenderer.getTextureRegistry().bind(); //Instances pick their layer with their texture handle
+
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, true);
+	vertexArray.getBatch().bindVao(); //Attribute enables live in the VAO, nothing to enable per draw
+
+	const Shmingo::MeshRange& mesh = vertexArray.getMeshRange();
 
+	glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, (const void*)((size_t)mesh.firstIndex * sizeof(int)),
+		vertexArray.getInstanceAmount(), mesh.baseVertex, vertexArray.getBaseInstance());
 }
 
-void Shmingo::renderInstanced(std::shared_ptr<InstancedVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
+void Shmingo::drawEntityBatch(EntityBatch& batch) {
 
-	shader->start();
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, true);
+	batch.draw();
+}
 
-	vertexArray->bindVao(); //Bind VAO
+void Shmingo::drawText(TextVertexArray& vertexArray, ShaderProgram& shader){
 
-	vertexArray->bindTextures(); //Load textures into texture slots
+	Shmingo::bindFontTextureToShader(shader, vertexArray.getFont());
 
-	enableAttribs(vertexArray->getAttribAmt()); //Enables attributes
-	clearOpenGLError();
-	glDrawElementsInstanced(GL_TRIANGLES, vertexArray->getIndexCount(), GL_UNSIGNED_INT, 0, (GLsizei)vertexArray->getInstanceCount());
-	checkOpenGLError();
-	disableAttribs(vertexArray->getAttribAmt()); //Disables attributes
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, true);
+	se_glState.bindVertexArray(vertexArray.getVaoID()); //Bind VAO
 
-	glBindVertexArray(0); //Unbind VAO
-	shader->stop(); //Stop shader
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 6, (GLsizei)vertexArray.getInstanceAmount());
 }
 
+void Shmingo::drawInstanced(InstancedVertexArray& vertexArray){
 
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, true);
+	vertexArray.bindVao(); //Bind VAO
 
-void Shmingo::renderTerrain(std::shared_ptr<ChunkVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader){
+	vertexArray.bindTextures(); //Load textures into texture slots
 
-	shader->start();
+	clearOpenGLError();
+	glDrawElementsInstanced(GL_TRIANGLES, vertexArray.getIndexCount(), GL_UNSIGNED_INT, 0, (GLsizei)vertexArray.getInstanceCount());
+	checkOpenGLError();
+}
 
-	vertexArray->bind(); //Bind VAO
+void Shmingo::drawTerrain(ChunkVertexArray& vertexArray){
 
-	//vertexArray->bindTextures(); //Load textures into texture slots
+	vertexArray.bind(); //Bind VAO
 
-	enableAttribs(vertexArray->getAttribAmt()); //Enables attributes
-	clearOpenGLError();
+	ivec2 chunkPosition = vertexArray.getChunkPosition();
+	glUniform3f(TERRAIN_CHUNK_ORIGIN_LOCATION, (float)(chunkPosition.x * (int)CHUNK_WIDTH), 0.0f, (float)(chunkPosition.y * (int)CHUNK_WIDTH));
+
+	//vertexArray.bindTextures(); //Load textures into texture slots
 
-	glDisable(GL_CULL_FACE);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 3, vertexArray->getInstanceCount());
-	glEnable(GL_CULL_FACE);
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, false); //Stays off across consecutive terrain draws, the next non terrain draw turns it back on
 
+	clearOpenGLError();
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 3, vertexArray.getInstanceCount());
 	checkOpenGLError();
-	disableAttribs(vertexArray->getAttribAmt()); //Disables attributes
-	glBindVertexArray(0); //Unbind VAO
-	shader->stop(); //Stop shader
 }
 
+void Shmingo::drawTerrainPulled(ChunkVertexArray& vertexArray){
+
+	vertexArray.bindPulled(); //No attributes, the shader reads every triangle's record itself
+	vertexArray.bindStorageBuffers();
 
+	ivec2 chunkPosition = vertexArray.getChunkPosition();
+	glUniform3f(TERRAIN_CHUNK_ORIGIN_LOCATION, (float)(chunkPosition.x * (int)CHUNK_WIDTH), 0.0f, (float)(chunkPosition.y * (int)CHUNK_WIDTH));
+
+	se_glState.setCapability(Shmingo::CULL_FACE_CAPABILITY, false);
+
+	clearOpenGLError();
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertexArray.getInstanceCount() * 3);
+	checkOpenGLError();
+}
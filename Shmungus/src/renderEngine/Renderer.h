@@ -3,7 +3,7 @@
 #include "DefaultShader.h"
 #include "EntityVertexArray.h"
 #include "TextVertexArray.h"
-#include "instancedVertexArray.h"
+#include "InstancedVertexArray.h"
 #include "ChunkVertexArray.h"
 
 namespace Shmingo {
@@ -44,4 +44,13 @@ namespace Shmingo {
 	/// <param name="shader"></param>
 	void renderTerrain(std::shared_ptr<ChunkVertexArray> vertexArray, std::shared_ptr<ShaderProgram> shader);
 
+
+	//Draw functions used by the sorted draw list. The shader must already be started, the render functions above wrap these with start and stop
+	void drawEntity(EntityVertexArray& vertexArray); //Single vertex array, out of its batch's buffers
+	void drawEntityBatch(EntityBatch& batch);
+	void drawText(TextVertexArray& vertexArray, ShaderProgram& shader);
+	void drawInstanced(InstancedVertexArray& vertexArray);
+	void drawTerrain(ChunkVertexArray& vertexArray);
+	void drawTerrainPulled(ChunkVertexArray& vertexArray); //Needs the se_TERRAIN_PULLED_SHADER shader
+
 }
\ No newline at end of file
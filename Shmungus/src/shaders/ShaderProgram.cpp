@@ -1,5 +1,6 @@
 #include <sepch.h>
 #include "ShaderProgram.h"
+#include "GLStateTracker.h"
 #include <iostream>
 
 //Must declare shader type for all shader programs
@@ -161,10 +162,10 @@ void ShaderProgram::loadSampler(const char* uniformName, GLuint value) {
 
 // Activates the Shader Program
 void ShaderProgram::start(){
-	glUseProgram(ID);
+	se_glState.useProgram(ID);
 }
 void ShaderProgram::stop() {
-	glUseProgram(NULL);
+	se_glState.useProgram(0);
 }
 
 // Checks if the different Shaders have compiled properly
@@ -202,6 +203,7 @@ void ShaderProgram::cleanUp() {
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 	glDeleteProgram(ID);
+	se_glState.programDeleted(ID);
 
 
 
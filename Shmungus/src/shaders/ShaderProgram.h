@@ -11,7 +11,8 @@ enum ShaderType {
 	se_ENTITY_SHADER,
 	se_TEXT_SHADER,
 	se_MENU_SHADER,
-	se_TERRAIN_SHADER
+	se_TERRAIN_SHADER,
+	se_TERRAIN_PULLED_SHADER
 
 };
 
@@ -1,5 +1,6 @@
 #include <sepch.h>
 #include "Texture.h"
+#include "GLStateTracker.h"
 
 #include <stb_image.h>
 
@@ -50,11 +51,10 @@ Texture2D::Texture2D(GLuint width, GLuint height) : Texture() {
 
 void Texture2D::setTextureData(unsigned char* textureData, GLuint width, GLuint height){
 
-	glBindTexture(GL_TEXTURE_2D, textureID);
 	glTextureSubImage2D(textureID, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
 
 }
 
 void Texture::bind(){
-	glBindTextureUnit(vaoLocalSlot, textureID);
+	se_glState.bindTexture(vaoLocalSlot, GL_TEXTURE_2D, textureID);
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 	
-#include <shmingoCore.h>
+#include <ShmingoCore.h>
 
 class Texture {
 
@@ -1,6 +1,7 @@
 #include <sepch.h>
 
 #include "TextureAtlas.h"
+#include "GLStateTracker.h"
 #define STB_IMAGE_IMPLEMENTATION
 
 Shmingo::TextureAtlas::TextureAtlas(size_t width, size_t height, bool uniformTextureDimensions) 
@@ -70,8 +71,7 @@ void Shmingo::TextureAtlas::addTexture(size_t textureID, std::string filePath){
 		GLsizei textureX = leftX * m_Width;
 		GLsizei textureY = bottomY * m_Height;
 
-		glActiveTexture(GL_TEXTURE0); //Set active texture to 0
-		glBindTexture(GL_TEXTURE_2D, texture.getTextureID()); //Bind texture to 2D texture target
+		se_glState.bindTexture(0, GL_TEXTURE_2D, texture.getTextureID()); //Bind texture to 2D texture target of unit 0
 
 		m_textureCoords.emplace(textureID, coords);
 		glTexSubImage2D(GL_TEXTURE_2D, 0, textureX, textureY, int_width, int_height, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
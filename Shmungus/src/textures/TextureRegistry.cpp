@@ -0,0 +1,129 @@
+#include <sepch.h>
+#include "TextureRegistry.h"
+#include "GLStateTracker.h"
+
+#include <stb_image.h>
+
+void TextureRegistry::cleanUp() {
+
+	for (TextureArray& textureArray : arrays) {
+		se_glState.textureDeleted(textureArray.textureID);
+		glDeleteTextures(1, &textureArray.textureID);
+	}
+
+	arrays.clear();
+	handles.clear();
+}
+
+Shmingo::TextureHandle TextureRegistry::registerTexture(const std::string& filePath) {
+
+	auto it = handles.find(filePath);
+	if (it != handles.end()) {
+		return it->second;
+	}
+
+	std::string realFilePath = "assets/textures/" + filePath;
+
+	int width, height, channels;
+
+	stbi_set_flip_vertically_on_load(1); //Flip texture to offset OpenGL flipping
+	stbi_uc* textureData = stbi_load(realFilePath.c_str(), &width, &height, &channels, 4); //Always RGBA, every array stores RGBA8
+
+	if (!textureData) {
+		se_error("Failed to load texture: " << filePath);
+		return Shmingo::TextureHandle();
+	}
+
+	Shmingo::TextureHandle handle = registerTexture(filePath, textureData, (GLuint)width, (GLuint)height);
+
+	stbi_image_free(textureData);
+	return handle;
+}
+
+Shmingo::TextureHandle TextureRegistry::registerTexture(const std::string& name, const uint8_t* pixels, GLuint width, GLuint height) {
+
+	auto it = handles.find(name);
+	if (it != handles.end()) {
+		return it->second;
+	}
+
+	GLuint arrayIndex = 0;
+	TextureArray* textureArray = findArray(width, height, arrayIndex);
+
+	if (textureArray == nullptr) {
+		se_error("Texture registry is full, " << name << " was not added");
+		return Shmingo::TextureHandle();
+	}
+
+	if (textureArray->layerAmount == textureArray->layerCapacity) {
+		growArray(*textureArray, std::min(textureArray->layerCapacity * 2, TEXTURE_ARRAY_LAYER_MAX));
+	}
+
+	GLuint layer = textureArray->layerAmount++;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage3D(textureArray->textureID, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	Shmingo::TextureHandle handle((uint8_t)arrayIndex, (uint8_t)layer);
+	handles.insert(std::make_pair(name, handle));
+
+	return handle;
+}
+
+void TextureRegistry::bind() {
+	for (GLuint i = 0; i < arrays.size(); i++) {
+		se_glState.bindTexture(i, GL_TEXTURE_2D_ARRAY, arrays[i].textureID);
+	}
+}
+
+TextureRegistry::TextureArray* TextureRegistry::findArray(GLuint width, GLuint height, GLuint& arrayIndex) {
+
+	for (GLuint i = 0; i < arrays.size(); i++) {
+		if (arrays[i].width == width && arrays[i].height == height && arrays[i].layerAmount < TEXTURE_ARRAY_LAYER_MAX) {
+			arrayIndex = i;
+			return &arrays[i];
+		}
+	}
+
+	if (arrays.size() == TEXTURE_REGISTRY_ARRAY_MAX) {
+		return nullptr;
+	}
+
+	arrayIndex = (GLuint)arrays.size();
+
+	TextureArray& textureArray = arrays.emplace_back();
+	textureArray.width = width;
+	textureArray.height = height;
+	growArray(textureArray, TEXTURE_ARRAY_INITIAL_LAYERS);
+
+	return &textureArray;
+}
+
+void TextureRegistry::growArray(TextureArray& textureArray, GLuint capacity) {
+
+	GLuint textureID = 0;
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &textureID);
+
+	//Same sampling as Texture2D, one level and nearest filtering
+	glTextureStorage3D(textureID, 1, GL_RGBA8, textureArray.width, textureArray.height, capacity);
+
+	glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	if (textureArray.textureID != 0) {
+
+		if (textureArray.layerAmount > 0) {
+			glCopyImageSubData(textureArray.textureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, textureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+				textureArray.width, textureArray.height, textureArray.layerAmount);
+		}
+
+		se_glState.textureDeleted(textureArray.textureID);
+		glDeleteTextures(1, &textureArray.textureID);
+	}
+
+	textureArray.textureID = textureID;
+	textureArray.layerCapacity = capacity;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+const GLuint TEXTURE_REGISTRY_ARRAY_MAX = 8; //Arrays bound at once, units 0 to this, must match the size of the entity fragment shader's sampler array and its switch
+const GLuint TEXTURE_ARRAY_LAYER_MAX = 256; //Layers per array, a layer has to fit in the low byte of a handle
+const GLuint TEXTURE_ARRAY_INITIAL_LAYERS = 4;
+
+namespace Shmingo {
+
+	//Where a texture lives in the registry. Packs into 16 bits, which is what entities store as their per instance textureID
+	struct TextureHandle {
+
+		uint8_t arrayIndex = 0;
+		uint8_t layer = 0;
+
+		inline uint16_t pack() const { return (uint16_t)((arrayIndex << 8) | layer); };
+		inline static TextureHandle unpack(uint16_t packed) { return TextureHandle((uint8_t)(packed >> 8), (uint8_t)(packed & 0xFF)); };
+	};
+}
+
+/*
+Every entity texture, packed into layered GL_TEXTURE_2D_ARRAYs. Textures of the same size share an array, each size gets its own.
+Arrays are bound to units 0 to TEXTURE_REGISTRY_ARRAY_MAX once for every entity draw, and instances pick their texture with a handle,
+so entity types with different textures draw with the same bindings and can share a multi draw.
+Arrays start small and double when full, moving their layers over with glCopyImageSubData. Only used from the thread that owns the context.
+*/
+class TextureRegistry {
+
+public:
+
+	TextureRegistry() {};
+
+	TextureRegistry(const TextureRegistry&) = delete;
+	TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+	/// <summary>
+	/// Loads a texture from assets/textures into the array of its size. A file that was already registered is not loaded again
+	/// </summary>
+	/// <returns>Handle of the texture, the handle of layer 0 of array 0 if the file could not be loaded or every array is full</returns>
+	Shmingo::TextureHandle registerTexture(const std::string& filePath);
+
+	/// <summary>
+	/// Adds texture data under a name
+	/// </summary>
+	/// <param name="pixels">Tightly packed 8 bit RGBA rows, bottom row first like GL expects</param>
+	Shmingo::TextureHandle registerTexture(const std::string& name, const uint8_t* pixels, GLuint width, GLuint height);
+
+	inline bool isRegistered(const std::string& name) { return handles.find(name) != handles.end(); };
+
+	//Binds every array to its unit as a GL_TEXTURE_2D_ARRAY
+	void bind();
+
+	//Deletes every array and forgets every handle, needs the context the arrays were made in. Not done on destruction, the registry lives in a static that outlives the context
+	void cleanUp();
+
+	inline GLuint getArrayAmount() { return (GLuint)arrays.size(); };
+	inline GLuint getLayerAmount(GLuint arrayIndex) { return arrays[arrayIndex].layerAmount; };
+
+private:
+
+	struct TextureArray {
+
+		GLuint textureID = 0;
+		GLuint width = 0;
+		GLuint height = 0;
+		GLuint layerAmount = 0;
+		GLuint layerCapacity = 0;
+	};
+
+	std::vector<TextureArray> arrays;
+	std::unordered_map<std::string, Shmingo::TextureHandle> handles;
+
+	//Array with room for a texture of this size, nullptr if a new one would go past TEXTURE_REGISTRY_ARRAY_MAX
+	TextureArray* findArray(GLuint width, GLuint height, GLuint& arrayIndex);
+
+	//Moves the array to new storage with room for capacity layers
+	void growArray(TextureArray& textureArray, GLuint capacity);
+};
@@ -33,3 +33,97 @@ Texture2D Shmingo::createTexture2D(std::string filePath){
 	stbi_image_free(textureData); //Frees char 
 	return texture;
 }
+
+static GLuint crc32(const uint8_t* data, size_t size, GLuint crc = 0) {
+
+	static std::array<GLuint, 256> table = []() {
+		std::array<GLuint, 256> values;
+		for (GLuint i = 0; i < 256; i++) {
+			GLuint value = i;
+			for (int bit = 0; bit < 8; bit++) {
+				value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			}
+			values[i] = value;
+		}
+		return values;
+	}();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void appendBigEndian(std::vector<uint8_t>& out, GLuint value) {
+	out.insert(out.end(), { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value });
+}
+
+//Length, type, data, then a CRC over type and data
+static void appendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+
+	appendBigEndian(out, (GLuint)data.size());
+
+	size_t typeStart = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+
+	appendBigEndian(out, crc32(&out[typeStart], out.size() - typeStart));
+}
+
+bool Shmingo::writePNG(const std::string& filePath, GLuint width, GLuint height, const uint8_t* pixels) {
+
+	const size_t maxStoredBlock = 65535; //Largest block deflate can store uncompressed
+	size_t rowSize = (size_t)width * 4;
+
+	//Every row starts with its filter type, 0 leaves the row as is
+	std::vector<uint8_t> scanlines;
+	scanlines.reserve((rowSize + 1) * height);
+	for (GLuint y = 0; y < height; y++) {
+		scanlines.emplace_back((uint8_t)0);
+		scanlines.insert(scanlines.end(), pixels + y * rowSize, pixels + (y + 1) * rowSize);
+	}
+
+	//zlib stream made of stored deflate blocks
+	std::vector<uint8_t> imageData = { 0x78, 0x01 };
+	imageData.reserve(scanlines.size() + scanlines.size() / maxStoredBlock * 5 + 16);
+
+	GLuint adlerA = 1, adlerB = 0;
+	size_t offset = 0;
+
+	do {
+		size_t blockSize = std::min(maxStoredBlock, scanlines.size() - offset);
+		bool lastBlock = offset + blockSize == scanlines.size();
+
+		imageData.insert(imageData.end(), { (uint8_t)(lastBlock ? 1 : 0), (uint8_t)blockSize, (uint8_t)(blockSize >> 8), (uint8_t)~blockSize, (uint8_t)(~blockSize >> 8) });
+		imageData.insert(imageData.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+
+		for (size_t i = offset; i < offset + blockSize; i++) {
+			adlerA = (adlerA + scanlines[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+
+		offset += blockSize;
+	} while (offset < scanlines.size());
+
+	appendBigEndian(imageData, (adlerB << 16) | adlerA);
+
+	std::vector<uint8_t> header;
+	appendBigEndian(header, width);
+	appendBigEndian(header, height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 }); //8 bits per channel, RGBA, deflate, no filtering method extensions, not interlaced
+
+	std::vector<uint8_t> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	appendChunk(file, "IHDR", header);
+	appendChunk(file, "IDAT", imageData);
+	appendChunk(file, "IEND", {});
+
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream) {
+		se_log("Failed to write " << filePath);
+		return false;
+	}
+
+	stream.write((const char*)file.data(), (std::streamsize)file.size());
+	return stream.good();
+}
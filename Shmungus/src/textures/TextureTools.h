@@ -7,4 +7,11 @@
 namespace Shmingo {
 	Texture2D createTexture2D(std::string filePath);
 
+	/// <summary>
+	/// Writes 8 bit RGBA pixels to a PNG file. The image data is stored without compression, which keeps the writer small and fast at the cost of file size
+	/// </summary>
+	/// <param name="pixels">Tightly packed rows, top row first</param>
+	/// <returns>False if the file could not be written</returns>
+	bool writePNG(const std::string& filePath, GLuint width, GLuint height, const uint8_t* pixels);
+
 }
\ No newline at end of file
@@ -45,7 +45,21 @@ namespace Shmingo {
 		PLAYER_Z,
 		PLAYER_VELOCITY_X,
 		PLAYER_VELOCITY_Y,
-		PLAYER_VELOCITY_Z
+		PLAYER_VELOCITY_Z,
+		INSTANCE_UPLOAD_BYTES,
+		INSTANCE_UPLOAD_CALLS,
+		GL_CALLS_ISSUED,
+		GL_CALLS_ELIDED,
+		VISIBLE_ENTITY_COUNT,
+		GPU_FRAME_TIME,
+		GPU_UPLOAD_TIME,
+		GPU_ENTITY_TIME,
+		GPU_TERRAIN_TIME,
+		GPU_TEXT_TIME,
+		GPU_MENU_TIME,
+		CHUNK_BUILD_QUEUE,
+		CHUNK_BUILD_LATENCY,
+		CHUNK_STREAM_COUNT
 	};
 
 	enum TextAlignment {
@@ -102,32 +116,74 @@ namespace Shmingo {
 	struct EntitySpecificInstanceDataInfo {
 
 		const char* name;
-		GLuint size; //Size of the uniform in number of floats
-		GLuint localFloatOffset;
-		GLuint attributeNumber;
+		GLuint size; //Size of the attribute in bytes
+		GLuint localOffset; //Offset in bytes of the attribute inside one interleaved instance
+		GLuint attributeNumber; //First attribute slot, local to the first per instance slot
+		GLuint slotAmount; //Amount of attribute slots used, a mat4 uses 4
+		GLuint componentAmount; //Components per slot
+		GLenum componentType;
+		bool normalized;
+		bool integer; //Read with glVertexAttribIPointer instead of being converted to float
+	};
+
+	/*
+	Runtime view of an InstanceLayout, see InstanceLayout.h. Points at the layout's constexpr attribute array, so copies are cheap
+	*/
+	struct InstanceLayoutInfo {
+
+		std::span<const EntitySpecificInstanceDataInfo> attributes;
+		GLuint stride; //Size in bytes of one instance with every attribute interleaved
+		GLuint slotAmount; //Total attribute slots used
+	};
+
+	//How the per instance data of an entity type is laid out in GPU and CPU memory
+	enum InstanceStorage {
+		SEPARATE_INSTANCE_BUFFERS, //One buffer per attribute, struct of arrays
+		INTERLEAVED_INSTANCE_BUFFER //One buffer of whole instance records, array of structs
 	};
 
 	/*
 	Represents a transform for an entity
-	Can move on 3 axes, and rotate on 2 axes
+	Can move on 3 axes, rotate on 2 axes, and scale on 3 axes
 	*/
 	struct TransformComponent {
 
 		vec3 position;
 		vec2 rotation;
+		vec3 scale;
 	};
 
 	/*
-	Represents information about an entity type and its storage in an entity vector.
-	Offset is the offset of the first entity of the given type in the entity vector
-	Amount is the amount of entities of the given type in the entity vector
+	Initial transform of one entity in a bulk spawn
 	*/
-	struct EntityTypeInfo {
+	struct EntitySpawnParams {
 
-		GLuint vertexArrayOffset; //Offset of vertex array in VAO map
-		GLuint offset; //Offset of first entity in entity map
-		GLuint amount; //Amount of entities of this type
+		vec3 position;
+		vec2 rotation;
+		vec3 scale;
+	};
 
+	/*
+	Stable reference to an entity in a world.
+	Index points to a slot in the world's slot map, generation is bumped every time that slot is freed so stale handles fail validation instead of aliasing a newer entity.
+	Generation 0 is never handed out, so a default constructed handle is always invalid.
+	*/
+	struct EntityHandle {
+
+		GLuint index = 0;
+		GLuint generation = 0;
+
+		bool operator==(const EntityHandle& other) const = default;
+	};
+
+	/*
+	Slot map entry describing where the entity behind a handle currently lives
+	*/
+	struct EntitySlot {
+
+		EntityType type;
+		GLuint row; //Row in the archetype of type, which is also the instance offset in its VAO
+		GLuint generation;
 	};
 
 
@@ -271,4 +327,188 @@ namespace Shmingo {
 		}
 
 	};
+
+	/// <summary>
+	/// Bitset whose bits can be set from several threads at once, used to track which rows of a buffer changed since its last upload.
+	/// Setting bits is thread safe, resizing and consuming are not and must not overlap with setting.
+	/// </summary>
+	class AtomicBitset {
+
+	public:
+
+		/// <summary>
+		/// Resizes the bitset, set bits below the new size are kept
+		/// </summary>
+		/// <param name="bitAmount">Minimum amount of bits</param>
+		void resize(GLuint bitAmount) {
+
+			GLuint newWordAmount = (bitAmount + 63) / 64;
+			if (newWordAmount <= wordAmount) {
+				return;
+			}
+
+			std::unique_ptr<std::atomic<uint64_t>[]> newWords = std::make_unique<std::atomic<uint64_t>[]>(newWordAmount);
+			for (GLuint i = 0; i < newWordAmount; i++) {
+				newWords[i].store(i < wordAmount ? words[i].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+			}
+
+			words = std::move(newWords);
+			wordAmount = newWordAmount;
+		}
+
+		inline void set(GLuint bit) {
+			words[bit >> 6].fetch_or(1ull << (bit & 63), std::memory_order_relaxed);
+			anySet.store(true, std::memory_order_relaxed);
+		}
+
+		//Sets bits [begin, end)
+		void setRange(GLuint begin, GLuint end) {
+
+			while (begin < end) {
+
+				GLuint bitInWord = begin & 63;
+				GLuint bitsInWord = std::min(64 - bitInWord, end - begin);
+				uint64_t mask = (bitsInWord == 64 ? ~0ull : ((1ull << bitsInWord) - 1)) << bitInWord;
+
+				words[begin >> 6].fetch_or(mask, std::memory_order_relaxed);
+				begin += bitsInWord;
+			}
+			anySet.store(true, std::memory_order_relaxed);
+		}
+
+		inline bool any() { return anySet.load(std::memory_order_relaxed); };
+
+		inline bool test(GLuint bit) {
+			return (words[bit >> 6].load(std::memory_order_relaxed) >> (bit & 63)) & 1;
+		}
+
+		/// <summary>
+		/// Clears every bit and calls function(begin, end) for each run of set bits below limit, in ascending order.
+		/// Runs separated by at most maxGap clear bits are merged into one
+		/// </summary>
+		/// <param name="limit">Bits at or above this are dropped</param>
+		/// <param name="maxGap">Largest amount of clear bits allowed inside a merged run</param>
+		/// <param name="function">Callable taking (GLuint begin, GLuint end)</param>
+		template<typename F>
+		void consumeRanges(GLuint limit, GLuint maxGap, F function) {
+
+			if (!anySet.exchange(false, std::memory_order_relaxed)) {
+				return;
+			}
+
+			bool open = false;
+			GLuint rangeBegin = 0;
+			GLuint rangeEnd = 0;
+
+			auto addBits = [&](GLuint begin, GLuint end) {
+				if (open && begin <= rangeEnd + maxGap) {
+					rangeEnd = end;
+					return;
+				}
+				if (open) {
+					function(rangeBegin, rangeEnd);
+				}
+				rangeBegin = begin;
+				rangeEnd = end;
+				open = true;
+			};
+
+			for (GLuint w = 0; w < wordAmount; w++) {
+
+				uint64_t word = words[w].exchange(0, std::memory_order_relaxed);
+				GLuint wordBegin = w << 6;
+
+				if (word == 0 || wordBegin >= limit) {
+					continue;
+				}
+
+				if (word == ~0ull) { //Fast path for fully dirty words
+					addBits(wordBegin, std::min(wordBegin + 64, limit));
+					continue;
+				}
+
+				while (word != 0) {
+					GLuint bit = wordBegin + (GLuint)std::countr_zero(word);
+					word &= word - 1;
+
+					if (bit >= limit) {
+						break;
+					}
+					addBits(bit, bit + 1);
+				}
+			}
+
+			if (open) {
+				function(rangeBegin, rangeEnd);
+			}
+		}
+
+	private:
+
+		std::unique_ptr<std::atomic<uint64_t>[]> words;
+		GLuint wordAmount = 0;
+		std::atomic<bool> anySet = false;
+	};
+
+	/// <summary>
+	/// Bounded single producer single consumer queue. Exactly one thread pushes and one other thread pops, neither takes a lock:
+	/// a full queue refuses the push and an empty one the pop. The consumer can sleep until something is pushed with waitUntilNotEmpty
+	/// </summary>
+	/// <typeparam name="Capacity">Power of two, so the slot index stays right when the counters wrap</typeparam>
+	template<typename T, GLuint Capacity>
+	class SpscQueue {
+
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+	public:
+
+		//Producer only, returns false if the queue is full
+		bool push(const T& value) {
+
+			GLuint currentTail = tail.load(std::memory_order_relaxed);
+			if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+				return false;
+			}
+
+			slots[currentTail % Capacity] = value;
+			tail.store(currentTail + 1, std::memory_order_release); //Publishes the slot to the consumer
+			tail.notify_one();
+			return true;
+		}
+
+		//Consumer only, returns false if the queue is empty
+		bool pop(T& out) {
+
+			GLuint currentHead = head.load(std::memory_order_relaxed);
+			if (currentHead == tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+
+			out = slots[currentHead % Capacity];
+			head.store(currentHead + 1, std::memory_order_release); //Hands the slot back to the producer
+			return true;
+		}
+
+		//Consumer only
+		inline bool isEmpty() { return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire); };
+
+		//Consumer only, blocks until an item was pushed
+		void waitUntilNotEmpty() {
+
+			GLuint currentHead = head.load(std::memory_order_relaxed);
+			GLuint currentTail = tail.load(std::memory_order_acquire);
+
+			while (currentTail == currentHead) {
+				tail.wait(currentTail, std::memory_order_acquire);
+				currentTail = tail.load(std::memory_order_acquire);
+			}
+		}
+
+	private:
+
+		std::array<T, Capacity> slots;
+
+		alignas(64) std::atomic<GLuint> head = 0; //Next slot to pop, only written by the consumer
+		alignas(64) std::atomic<GLuint> tail = 0; //Next slot to push, only written by the producer. Own cache line so the two threads don't fight over one
+	};
 }
\ No newline at end of file
@@ -10,6 +10,10 @@ void Shmingo::setCurrentWorld(World* world){
 //Disables cursor in order to use first person camera
 void Shmingo::disableGLFWCursor() {
 
+	if (se_application.getWindow()->isHeadless()) { //No cursor without a window
+		return;
+	}
+
 	glfwSetInputMode(se_application.getWindow()->getGLFWwindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 	if (glfwRawMouseMotionSupported()) {
 		glfwSetInputMode(se_application.getWindow()->getGLFWwindow(), GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
@@ -19,12 +23,20 @@ void Shmingo::disableGLFWCursor() {
 //Re enables normal cursor behavior
 void Shmingo::enableGLFWCursor() {
 
+	if (se_application.getWindow()->isHeadless()) {
+		return;
+	}
+
 	glfwSetInputMode(se_application.getWindow()->getGLFWwindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
 }
 
 void Shmingo::centerCursor() {
 
+	if (se_application.getWindow()->isHeadless()) {
+		return;
+	}
+
 	glfwSetCursorPos(se_application.getWindow()->getGLFWwindow(), se_application.getWindow()->getWidth() / 2, se_application.getWindow()->getHeight() / 2);
 
 }
@@ -0,0 +1,610 @@
+#include <sepch.h>
+#include "Benchmarks.h"
+
+#include "MasterRenderer.h"
+#include "Renderer.h"
+#include "MathTools.h"
+#include "DynamicAABBTree.h"
+#include "ChunkMesher.h"
+#include "TerrainGenerator.h"
+#include "ChunkBuilder.h"
+#include "ChunkStreamer.h"
+
+#include <random>
+
+double Shmingo::millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Shmingo::benchmarkEntitySpawn(World& world, GLuint amount) {
+
+	std::vector<Shmingo::EntitySpawnParams> spawnParams;
+	spawnParams.reserve(amount);
+
+	for (GLuint i = 0; i < amount; i++) {
+		spawnParams.emplace_back(Shmingo::EntitySpawnParams(vec3(3.0f * (float)(i % 100), 3.0f * (float)((i / 100) % 100), -4.0f - 3.0f * (float)(i / 10000)), vec2(0.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f)));
+	}
+
+	//Bulk path
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<Shmingo::EntityHandle> handles = world.createEntities(Shmingo::DefaultEntity, spawnParams);
+	world.flushInstanceData();
+	glFinish(); //Include the upload itself, not just queuing it
+	double bulkSpawnTime = millisecondsSince(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	world.destroyEntities(handles);
+	world.flushInstanceData();
+	glFinish();
+	double bulkDespawnTime = millisecondsSince(start);
+
+	//One by one path for comparison
+	handles.clear();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (const Shmingo::EntitySpawnParams& params : spawnParams) {
+		handles.emplace_back(world.createEntity(Shmingo::DefaultEntity, params.position, params.rotation, params.scale));
+	}
+	world.flushInstanceData();
+	glFinish();
+	double singleSpawnTime = millisecondsSince(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	for (const Shmingo::EntityHandle& handle : handles) {
+		world.deleteEntity(handle);
+	}
+	world.flushInstanceData();
+	glFinish();
+	double singleDespawnTime = millisecondsSince(start);
+
+	se_log("Entity spawn benchmark, " << amount << " entities");
+	se_log("  createEntities:  " << bulkSpawnTime << " ms");
+	se_log("  destroyEntities: " << bulkDespawnTime << " ms");
+	se_log("  createEntity:    " << singleSpawnTime << " ms");
+	se_log("  deleteEntity:    " << singleDespawnTime << " ms");
+}
+
+void Shmingo::benchmarkInstanceStorage(GLuint amount) {
+
+	const GLuint frameAmount = 10; //Update and draw timings are averaged over this many frames
+	const GLuint updateSpacing = 97; //Every updateSpacing-th instance changes per frame, far enough apart that flushes can't merge them
+
+	using Layout = ::DefaultEntity::InstanceLayout;
+
+	const Shmingo::InstanceLayoutInfo& layout = se_masterRenderer.getEntityInstanceLayout(Shmingo::DefaultEntity);
+	StreamBuffer& streamBuffer = se_masterRenderer.getInstanceStreamBuffer();
+
+	//One instance record, scattered into whichever arrangement is being measured
+	std::vector<uint8_t> record(layout.stride);
+	std::vector<uint8_t> mirror((size_t)amount * layout.stride);
+
+	se_log("Instance storage benchmark, " << amount << " instances");
+
+	for (Shmingo::InstanceStorage storage : { Shmingo::SEPARATE_INSTANCE_BUFFERS, Shmingo::INTERLEAVED_INSTANCE_BUFFER }) {
+
+		bool interleaved = storage == Shmingo::INTERLEAVED_INSTANCE_BUFFER;
+
+		//Byte position of an attribute of a row in the mirror
+		auto mirrorOffset = [&](GLuint row, GLuint attributePositionInArray) -> size_t {
+			const Shmingo::EntitySpecificInstanceDataInfo& info = layout.attributes[attributePositionInArray];
+			return interleaved ? (size_t)row * layout.stride + info.localOffset : (size_t)info.localOffset * amount + (size_t)row * info.size;
+		};
+
+		for (GLuint row = 0; row < amount; row++) {
+
+			vec3 position = vec3(3.0f * (float)(row % 100), 3.0f * (float)((row / 100) % 100), -4.0f - 3.0f * (float)(row / 10000));
+			glm::i16vec2 rotation = Shmingo::quantizeRotation(vec2(0.0f));
+			glm::u16vec3 scale = Shmingo::packHalfVec3(vec3(1.0f));
+			uint16_t textureID = 0;
+
+			std::memcpy(&record[Layout::offset<0>], &position, sizeof(position));
+			std::memcpy(&record[Layout::offset<1>], &rotation, sizeof(rotation));
+			std::memcpy(&record[Layout::offset<2>], &scale, sizeof(scale));
+			std::memcpy(&record[Layout::offset<3>], &textureID, sizeof(textureID));
+
+			for (GLuint i = 0; i < layout.attributes.size(); i++) {
+				std::memcpy(&mirror[mirrorOffset(row, i)], &record[layout.attributes[i].localOffset], layout.attributes[i].size);
+			}
+		}
+
+		std::shared_ptr<EntityVertexArray> vertexArray = std::make_shared<EntityVertexArray>(Shmingo::DefaultEntity, se_masterRenderer.getEntityModel(Shmingo::DefaultEntity), storage);
+
+		vertexArray->setInstanceMirror([&](GLuint row, GLuint bufferIndex, GLuint& contiguousInstances) -> const void* {
+			contiguousInstances = amount - row;
+			return &mirror[mirrorOffset(row, bufferIndex)]; //Buffer index is the attribute index for separate buffers, 0 is the record start when interleaved
+		});
+
+		vertexArray->reserveInstances(amount);
+		vertexArray->setInstanceAmount(amount);
+		glFinish();
+
+		//Full upload
+		auto start = std::chrono::high_resolution_clock::now();
+		vertexArray->markInstancesDirty(0, amount);
+		Shmingo::InstanceFlushStats uploadStats = vertexArray->flushInstanceData();
+		glFinish();
+		double uploadTime = millisecondsSince(start);
+
+		//Sparse updates, every attribute of an instance changes at once like a moving entity's would
+		Shmingo::InstanceFlushStats updateStats;
+		start = std::chrono::high_resolution_clock::now();
+
+		for (GLuint frame = 0; frame < frameAmount; frame++) {
+
+			streamBuffer.beginFrame();
+
+			for (GLuint row = frame; row < amount; row += updateSpacing) {
+				for (GLuint i = 0; i < layout.attributes.size(); i++) {
+					vertexArray->markInstanceDirty(row, i);
+				}
+			}
+			updateStats = vertexArray->flushInstanceData();
+
+			streamBuffer.endFrame();
+			glFinish();
+		}
+		double updateTime = millisecondsSince(start) / frameAmount;
+
+		//Draws, measures attribute fetch from one stream against several
+		start = std::chrono::high_resolution_clock::now();
+		for (GLuint frame = 0; frame < frameAmount; frame++) {
+			Shmingo::renderEntity(vertexArray, se_masterRenderer.getEntityShader(Shmingo::DefaultEntity));
+			glFinish();
+		}
+		double drawTime = millisecondsSince(start) / frameAmount;
+
+		se_log("  " << (interleaved ? "Interleaved" : "Separate   ") << " upload: " << uploadTime << " ms (" << uploadStats.calls << " calls), update: "
+			<< updateTime << " ms (" << updateStats.calls << " calls), draw: " << drawTime << " ms");
+	}
+}
+
+void Shmingo::benchmarkSpatialIndex(GLuint amount) {
+
+	const GLuint queryAmount = 4096;
+	const GLuint frustumAmount = 64;
+	const vec3 entityExtent(0.6f); //Half size of every box, about the size of the default entity
+
+	float worldSize = 3.0f * std::cbrt((float)amount); //Keeps roughly one entity per 27 cubic units at every amount
+
+	std::mt19937 random(1234); //Fixed seed so runs are comparable
+	std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+	std::uniform_real_distribution<float> jitter(-0.2f, 0.2f); //Stays inside the fat margin
+	std::uniform_real_distribution<float> jump(-5.0f, 5.0f); //Leaves the fat margin
+
+	std::vector<vec3> positions(amount);
+	for (vec3& position : positions) {
+		position = vec3(coordinate(random), coordinate(random), coordinate(random));
+	}
+
+	DynamicAABBTree tree;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (GLuint i = 0; i < amount; i++) {
+		tree.insert(Shmingo::EntityHandle(i, 1), Shmingo::AABB(positions[i] - entityExtent, positions[i] + entityExtent));
+	}
+	double insertTime = millisecondsSince(start);
+
+	//Updates, offsets are generated up front so only the tree is timed
+	std::vector<vec3> smallMoves(amount);
+	std::vector<vec3> largeMoves(amount);
+	for (GLuint i = 0; i < amount; i++) {
+		smallMoves[i] = positions[i] + vec3(jitter(random), jitter(random), jitter(random));
+		largeMoves[i] = positions[i] + vec3(jump(random), jump(random), jump(random));
+	}
+
+	start = std::chrono::high_resolution_clock::now();
+	for (GLuint i = 0; i < amount; i++) {
+		tree.update(Shmingo::EntityHandle(i, 1), Shmingo::AABB(smallMoves[i] - entityExtent, smallMoves[i] + entityExtent));
+	}
+	double smallUpdateTime = millisecondsSince(start);
+
+	GLuint reinsertions = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (GLuint i = 0; i < amount; i++) {
+		reinsertions += tree.update(Shmingo::EntityHandle(i, 1), Shmingo::AABB(largeMoves[i] - entityExtent, largeMoves[i] + entityExtent)) ? 1 : 0;
+	}
+	double largeUpdateTime = millisecondsSince(start);
+
+	//Batched queries
+	std::vector<Shmingo::AABB> boxes;
+	std::vector<Shmingo::BoundingSphere> spheres;
+	std::vector<Shmingo::Ray> rays;
+
+	for (GLuint i = 0; i < queryAmount; i++) {
+
+		vec3 center(coordinate(random), coordinate(random), coordinate(random));
+		boxes.emplace_back(Shmingo::AABB(center - vec3(5.0f), center + vec3(5.0f)));
+		spheres.emplace_back(Shmingo::BoundingSphere(center, 5.0f));
+
+		vec3 direction = glm::normalize(vec3(jump(random), jump(random), jump(random)) + vec3(0.001f));
+		rays.emplace_back(Shmingo::Ray(center, direction, worldSize));
+	}
+
+	std::vector<Shmingo::Frustum> frustums;
+	mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+
+	for (GLuint i = 0; i < frustumAmount; i++) {
+		vec3 eye(coordinate(random), coordinate(random), coordinate(random));
+		frustums.emplace_back(Shmingo::extractFrustumPlanes(projection, glm::lookAt(eye, vec3(worldSize * 0.5f), vec3(0.0f, 1.0f, 0.0f))));
+	}
+
+	std::vector<std::vector<Shmingo::EntityHandle>> results;
+	std::vector<Shmingo::RayHit> hits;
+
+	auto countResults = [&]() {
+		size_t total = 0;
+		for (const std::vector<Shmingo::EntityHandle>& result : results) {
+			total += result.size();
+		}
+		return total;
+	};
+
+	start = std::chrono::high_resolution_clock::now();
+	tree.queryAABBs(boxes, results);
+	double boxQueryTime = millisecondsSince(start);
+	size_t boxResults = countResults();
+
+	start = std::chrono::high_resolution_clock::now();
+	tree.querySpheres(spheres, results);
+	double sphereQueryTime = millisecondsSince(start);
+	size_t sphereResults = countResults();
+
+	start = std::chrono::high_resolution_clock::now();
+	tree.queryFrustums(frustums, results);
+	double frustumQueryTime = millisecondsSince(start);
+	size_t frustumResults = countResults();
+
+	start = std::chrono::high_resolution_clock::now();
+	tree.raycasts(rays, hits);
+	double rayQueryTime = millisecondsSince(start);
+	size_t rayHits = std::count_if(hits.begin(), hits.end(), [](const Shmingo::RayHit& hit) { return hit.handle.generation != 0; });
+
+	se_log("Spatial index benchmark, " << amount << " entities, tree height " << tree.getHeight());
+	se_log("  insert:             " << insertTime << " ms");
+	se_log("  update in margin:   " << smallUpdateTime << " ms");
+	se_log("  update reinserting: " << largeUpdateTime << " ms (" << reinsertions << " reinserted)");
+	se_log("  " << queryAmount << " box queries:    " << boxQueryTime << " ms (" << boxResults << " results)");
+	se_log("  " << queryAmount << " sphere queries: " << sphereQueryTime << " ms (" << sphereResults << " results)");
+	se_log("  " << frustumAmount << " frustum queries:  " << frustumQueryTime << " ms (" << frustumResults << " results)");
+	se_log("  " << queryAmount << " raycasts:       " << rayQueryTime << " ms (" << rayHits << " hits)");
+}
+
+//Baseline for benchmarkChunkMeshing, same faces as Shmingo::meshChunk without neighbors but found by looking up every block's 6 neighbors
+static void meshChunkPerBlock(const Chunk& chunk, Shmingo::ChunkMesh& mesh) {
+
+	static const ivec3 faceDirections[Shmingo::CHUNK_FACE_AMOUNT] = { ivec3(0, 0, 1), ivec3(1, 0, 0), ivec3(0, 0, -1), ivec3(-1, 0, 0), ivec3(0, 1, 0), ivec3(0, -1, 0) };
+
+	mesh.clear();
+
+	for (int x = 0; x < (int)CHUNK_WIDTH; x++) {
+		for (int z = 0; z < (int)CHUNK_WIDTH; z++) {
+			for (int y = 0; y < (int)CHUNK_HEIGHT; y++) {
+
+				Shmingo::BlockID material = chunk.getBlock(x, y, z);
+				if (material == Shmingo::AIR_BLOCK) {
+					continue;
+				}
+
+				for (GLuint face = 0; face < Shmingo::CHUNK_FACE_AMOUNT; face++) {
+
+					ivec3 neighbor = ivec3(x, y, z) + faceDirections[face];
+
+					bool hidden;
+					if (neighbor.y < 0) {
+						hidden = true; //Bottom of the world
+					}
+					else if (neighbor.x < 0 || neighbor.x >= (int)CHUNK_WIDTH || neighbor.z < 0 || neighbor.z >= (int)CHUNK_WIDTH || neighbor.y >= (int)CHUNK_HEIGHT) {
+						hidden = false;
+					}
+					else {
+						hidden = chunk.getBlock(neighbor.x, neighbor.y, neighbor.z) != Shmingo::AIR_BLOCK;
+					}
+
+					if (!hidden) {
+						uint8_t positionXZ = (uint8_t)((x << 4) | z);
+						mesh.positions.insert(mesh.positions.end(), { positionXZ, (uint8_t)y, positionXZ, (uint8_t)y });
+						mesh.IDs.insert(mesh.IDs.end(), { Shmingo::packTerrainID(material, (uint8_t)(face * 2)), Shmingo::packTerrainID(material, (uint8_t)(face * 2 + 1)) });
+						mesh.extents.insert(mesh.extents.end(), { 0, 0, 0, 0 });
+					}
+				}
+			}
+		}
+	}
+}
+
+void Shmingo::benchmarkChunkMeshing(GLuint chunkAmount) {
+
+	const GLuint variantAmount = 16; //Distinct chunks per kind of terrain, meshed round robin so the caches see more than one chunk
+
+	std::mt19937 random(1234);
+	std::bernoulli_distribution halfFull(0.5);
+
+	struct TerrainKind {
+
+		const char* name;
+		std::vector<Chunk> chunks;
+	};
+
+	std::vector<TerrainKind> kinds;
+	kinds.reserve(4); //References to the kinds are kept while adding them
+
+	TerrainKind& flat = kinds.emplace_back(TerrainKind("flat slab, 64 high", {}));
+	TerrainKind& randomBlocks = kinds.emplace_back(TerrainKind("random blocks, half full below 128", {}));
+	TerrainKind& checkerboard = kinds.emplace_back(TerrainKind("checkerboard, 64 high", {}));
+	TerrainKind& noise = kinds.emplace_back(TerrainKind("noise terrain", {}));
+
+	for (GLuint i = 0; i < variantAmount; i++) {
+
+		Chunk& flatChunk = flat.chunks.emplace_back(Chunk(ivec2(i, 0)));
+		Chunk& randomChunk = randomBlocks.chunks.emplace_back(Chunk(ivec2(i, 0)));
+		Chunk& checkerChunk = checkerboard.chunks.emplace_back(Chunk(ivec2(i, 0)));
+		Chunk& noiseChunk = noise.chunks.emplace_back(Chunk(ivec2(i % 4, i / 4)));
+
+		for (GLuint x = 0; x < CHUNK_WIDTH; x++) {
+			for (GLuint z = 0; z < CHUNK_WIDTH; z++) {
+
+				flatChunk.fillColumn(x, z, 0, 64, Shmingo::STONE_BLOCK);
+
+				for (GLuint y = 0; y < 128; y++) {
+					if (halfFull(random)) {
+						randomChunk.setBlock(x, y, z, Shmingo::STONE_BLOCK);
+					}
+				}
+
+				for (GLuint y = (x + z + i) % 2; y < 64; y += 2) {
+					checkerChunk.setBlock(x, y, z, Shmingo::STONE_BLOCK);
+				}
+			}
+		}
+
+		Shmingo::generateTerrain(noiseChunk, 1234);
+	}
+
+	se_log("Chunk meshing benchmark, " << chunkAmount << " chunks per terrain");
+
+	Shmingo::ChunkMesh mesh;
+
+	for (TerrainKind& kind : kinds) {
+
+		size_t triangles = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (GLuint i = 0; i < chunkAmount; i++) {
+			Shmingo::meshChunk(kind.chunks[i % variantAmount], Shmingo::ChunkNeighbors(), mesh, false);
+			triangles += mesh.getTriangleAmount();
+		}
+		double bitmaskTime = millisecondsSince(start);
+
+		size_t greedyTriangles = 0;
+
+		start = std::chrono::high_resolution_clock::now();
+		for (GLuint i = 0; i < chunkAmount; i++) {
+			Shmingo::meshChunk(kind.chunks[i % variantAmount], Shmingo::ChunkNeighbors(), mesh, true);
+			greedyTriangles += mesh.getTriangleAmount();
+		}
+		double greedyTime = millisecondsSince(start);
+
+		//Merged quads have to cover exactly the faces they replace, checked on the variants once outside the timing
+		size_t faceArea = 0;
+		size_t greedyArea = 0;
+		for (const Chunk& chunk : kind.chunks) {
+
+			Shmingo::meshChunk(chunk, Shmingo::ChunkNeighbors(), mesh, false);
+			faceArea += mesh.getTriangleAmount();
+
+			Shmingo::meshChunk(chunk, Shmingo::ChunkNeighbors(), mesh, true);
+			for (size_t triangle = 0; triangle < mesh.getTriangleAmount(); triangle++) {
+				greedyArea += (size_t)(mesh.extents[triangle * 2] + 1) * (mesh.extents[triangle * 2 + 1] + 1);
+			}
+		}
+
+		size_t baselineTriangles = 0;
+
+		start = std::chrono::high_resolution_clock::now();
+		for (GLuint i = 0; i < chunkAmount; i++) {
+			meshChunkPerBlock(kind.chunks[i % variantAmount], mesh);
+			baselineTriangles += mesh.getTriangleAmount();
+		}
+		double baselineTime = millisecondsSince(start);
+
+		se_log("  " << kind.name << ", " << triangles / chunkAmount << " triangles per chunk" << (triangles != baselineTriangles ? " (MISMATCH with baseline)" : ""));
+		se_log("    column bitmasks:  " << bitmaskTime << " ms, " << (double)chunkAmount * 1000.0 / bitmaskTime << " chunks/s");
+		se_log("    greedy quads:     " << greedyTime << " ms, " << (double)chunkAmount * 1000.0 / greedyTime << " chunks/s, "
+			<< greedyTriangles / chunkAmount << " triangles per chunk" << (greedyArea != faceArea ? " (MISMATCH in covered area)" : ""));
+		se_log("    per block lookup: " << baselineTime << " ms, " << (double)chunkAmount * 1000.0 / baselineTime << " chunks/s");
+	}
+}
+
+void Shmingo::benchmarkTerrainDraw(GLuint drawAmount) {
+
+	Chunk chunk(ivec2(0, 0));
+	Shmingo::generateTerrain(chunk, 1234);
+
+	ChunkVertexArray vertexArray;
+
+	ShaderProgram& instancedShader = *se_masterRenderer.getShader(se_TERRAIN_SHADER);
+	ShaderProgram& pulledShader = *se_masterRenderer.getShader(se_TERRAIN_PULLED_SHADER);
+
+	se_log("Terrain draw benchmark, " << drawAmount << " draws of one noise chunk per path");
+
+	Shmingo::ChunkMesh mesh;
+
+	for (bool greedy : { false, true }) {
+
+		Shmingo::meshChunk(chunk, Shmingo::ChunkNeighbors(), mesh, greedy);
+		vertexArray.submitMesh(mesh);
+
+		//Warms up both paths so shader compilation on first use is not timed
+		instancedShader.start();
+		Shmingo::drawTerrain(vertexArray);
+		pulledShader.start();
+		Shmingo::drawTerrainPulled(vertexArray);
+		glFinish();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		instancedShader.start();
+		for (GLuint i = 0; i < drawAmount; i++) {
+			Shmingo::drawTerrain(vertexArray);
+		}
+		glFinish();
+		double instancedTime = millisecondsSince(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		pulledShader.start();
+		for (GLuint i = 0; i < drawAmount; i++) {
+			Shmingo::drawTerrainPulled(vertexArray);
+		}
+		glFinish();
+		double pulledTime = millisecondsSince(start);
+
+		pulledShader.stop();
+
+		double triangles = (double)mesh.getTriangleAmount() * drawAmount;
+
+		se_log("  " << (greedy ? "greedy quads" : "single faces") << ", " << mesh.getTriangleAmount() << " triangles per draw");
+		se_log("    instanced, 3 vertices per instance: " << instancedTime << " ms, " << triangles / instancedTime / 1000.0 << " M triangles/s");
+		se_log("    vertex pulling, one draw:          " << pulledTime << " ms, " << triangles / pulledTime / 1000.0 << " M triangles/s");
+	}
+
+	vertexArray.cleanUp();
+}
+
+void Shmingo::benchmarkChunkBuilder(GLuint chunkAmount) {
+
+	const std::chrono::microseconds frameTime(16667); //Uploads happen once per simulated 60 Hz frame
+
+	//Square of noise chunks around the origin, so most chunks have all 4 neighbors
+	int side = (int)std::ceil(std::sqrt((double)chunkAmount));
+	chunkAmount = (GLuint)(side * side);
+
+	std::vector<std::shared_ptr<Chunk>> chunks;
+	std::vector<std::shared_ptr<ChunkVertexArray>> vertexArrays;
+
+	for (int i = 0; i < side * side; i++) {
+		std::shared_ptr<Chunk>& chunk = chunks.emplace_back(std::make_shared<Chunk>(ivec2(i % side - side / 2, i / side - side / 2)));
+		Shmingo::generateTerrain(*chunk, 1234);
+		vertexArrays.emplace_back(std::make_shared<ChunkVertexArray>());
+	}
+
+	auto getChunk = [&](int x, int z) -> std::shared_ptr<const Chunk> {
+		return (x >= 0 && x < side && z >= 0 && z < side) ? chunks[z * side + x] : nullptr;
+	};
+
+	auto getNeighbors = [&](int i) {
+		int x = i % side;
+		int z = i / side;
+		return Shmingo::ChunkBuildNeighbors(getChunk(x + 1, z), getChunk(x - 1, z), getChunk(x, z + 1), getChunk(x, z - 1));
+	};
+
+	se_log("Chunk builder benchmark, " << chunkAmount << " noise chunks");
+
+	//Baseline, every chunk meshed and uploaded on this thread in one go
+	Shmingo::ChunkMesh mesh;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (GLuint i = 0; i < chunkAmount; i++) {
+
+		Shmingo::ChunkBuildNeighbors neighbors = getNeighbors(i);
+		Shmingo::meshChunk(*chunks[i], Shmingo::ChunkNeighbors(neighbors.positiveX.get(), neighbors.negativeX.get(), neighbors.positiveZ.get(), neighbors.negativeZ.get()), mesh);
+		vertexArrays[i]->submitMesh(mesh);
+	}
+	glFinish();
+	double serialTime = millisecondsSince(start);
+
+	ChunkBuilder builder;
+	builder.init();
+	builder.setCameraPosition(vec3(0.0f, 0.0f, 0.0f));
+
+	auto runFrames = [&]() {
+
+		GLuint frames = 0;
+		size_t largestUpload = 0;
+
+		while (!builder.isIdle()) {
+			auto frameStart = std::chrono::high_resolution_clock::now();
+			largestUpload = std::max(largestUpload, builder.uploadFinished());
+			frames++;
+			std::this_thread::sleep_until(frameStart + frameTime);
+		}
+		return std::make_pair(frames, largestUpload);
+	};
+
+	start = std::chrono::high_resolution_clock::now();
+	for (GLuint i = 0; i < chunkAmount; i++) {
+		builder.markDirty(chunks[i], getNeighbors(i), vertexArrays[i]);
+	}
+	double markTime = millisecondsSince(start);
+
+	auto [frames, largestUpload] = runFrames();
+	double pipelineTime = millisecondsSince(start);
+	Shmingo::ChunkBuildStats stats = builder.getStats();
+
+	se_log("  on this thread:   " << serialTime << " ms, the frame would stall for all of it");
+	se_log("  builder:          " << pipelineTime << " ms over " << frames << " frames, marking took " << markTime << " ms, at most " << largestUpload << " bytes uploaded in a frame");
+	se_log("  latency of the last " << std::min(chunkAmount, CHUNK_BUILD_LATENCY_HISTORY) << " builds: " << stats.averageLatencyMs << " ms average, " << stats.maxLatencyMs << " ms max");
+
+	//Every chunk edited twice while its first builds are in flight, only the latest build of each may be uploaded
+	for (GLuint edit = 0; edit < 2; edit++) {
+		for (GLuint i = 0; i < chunkAmount; i++) {
+			Shmingo::editChunk(chunks[i]).setBlock(0, 200, 0, edit == 0 ? Shmingo::STONE_BLOCK : Shmingo::AIR_BLOCK);
+			builder.markDirty(chunks[i], getNeighbors(i), vertexArrays[i]);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	runFrames();
+
+	se_log("  re-edited every chunk mid build: " << builder.getStats().cancelledAmount << " stale results dropped");
+
+	builder.shutdown();
+	for (std::shared_ptr<ChunkVertexArray>& vertexArray : vertexArrays) {
+		vertexArray->cleanUp();
+	}
+}
+
+void Shmingo::benchmarkChunkStreaming(GLuint frameAmount, float blocksPerFrame) {
+
+	const std::chrono::microseconds frameTime(16667);
+
+	se_log("Chunk streaming benchmark, " << frameAmount << " frames at " << blocksPerFrame << " blocks per frame, view radius " << CHUNK_VIEW_RADIUS);
+
+	for (double frameBudgetMs : { CHUNK_STREAM_FRAME_BUDGET_MS, 1000000.0 }) {
+
+		ChunkBuilder builder;
+		builder.init();
+
+		ChunkStreamer streamer;
+		streamer.init(builder);
+
+		double totalTime = 0.0;
+		double longestFrame = 0.0;
+		GLuint generatedAmount = 0;
+		GLuint settledFrames = 0;
+
+		for (GLuint frame = 0; frame < frameAmount; frame++) {
+
+			auto frameStart = std::chrono::high_resolution_clock::now();
+
+			generatedAmount += streamer.update(vec3(frame * blocksPerFrame, 100.0f, 0.0f), frameBudgetMs);
+			builder.uploadFinished();
+
+			double streamTime = millisecondsSince(frameStart);
+			totalTime += streamTime;
+			longestFrame = std::max(longestFrame, streamTime);
+
+			if (streamer.isSettled()) {
+				settledFrames++;
+			}
+
+			std::this_thread::sleep_until(frameStart + frameTime);
+		}
+
+		Shmingo::ChunkStreamStats stats = streamer.getStats();
+
+		se_log("  " << (frameBudgetMs == CHUNK_STREAM_FRAME_BUDGET_MS ? "budgeted:  " : "unbudgeted:") << " " << totalTime / frameAmount << " ms average, " << longestFrame << " ms longest frame, "
+			<< generatedAmount << " chunks generated, every chunk around the player loaded in " << settledFrames << " of " << frameAmount << " frames");
+		se_log("              " << stats.loadedAmount << " loaded, " << stats.meshedAmount << " meshed, " << stats.createdAmount << " chunk objects allocated, " << stats.pooledAmount << " pooled");
+
+		builder.shutdown();
+		streamer.clear();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include "World.h"
+
+//Debug benchmarks, results are printed to the console. They need a live GL context so run them from a layer, not at startup
+namespace Shmingo {
+	//Returns milliseconds elapsed since start
+	double millisecondsSince(std::chrono::high_resolution_clock::time_point start);
+
+	//Spawns and despawns amount entities through the bulk API and one by one, and prints the timings of both
+	void benchmarkEntitySpawn(World& world, GLuint amount);
+
+	/// <summary>
+	/// Compares separate and interleaved instance buffers for amount instances of the default entity: a full upload,
+	/// per frame updates of a sparse set of instances, and instanced draws. Timings include GPU work
+	/// </summary>
+	void benchmarkInstanceStorage(GLuint amount);
+
+	/// <summary>
+	/// Fills a dynamic AABB tree with amount entity sized boxes at a constant density and prints insert, update and batched query throughput.
+	/// Updates are timed twice, once with moves that stay inside the fat margin and once with moves that force reinsertion
+	/// </summary>
+	void benchmarkSpatialIndex(GLuint amount);
+
+	/// <summary>
+	/// Meshes chunkAmount chunks of each kind of terrain and prints chunks per second for the column bitmask mesher, with and without
+	/// greedy quad merging, and for a mesher that looks up the 6 neighbors of every block, as a baseline. Synthetic terrain covers a flat slab,
+	/// random blocks and a 3D checkerboard, the worst case for face count, noise terrain is what the world generator makes. CPU only
+	/// </summary>
+	void benchmarkChunkMeshing(GLuint chunkAmount);
+
+	/// <summary>
+	/// Draws one noise terrain chunk drawAmount times with the instanced terrain path and with vertex pulling, for its per face and its greedy mesh,
+	/// and prints triangles per second. Timings include GPU work and depend on what the camera sees, so compare paths within one run
+	/// </summary>
+	void benchmarkTerrainDraw(GLuint drawAmount);
+
+	/// <summary>
+	/// Builds about chunkAmount noise chunks through the chunk builder, uploading once per simulated 60 Hz frame, and prints the time taken, build latency
+	/// and the most bytes uploaded in one frame, next to meshing and uploading them all on the calling thread. Then edits every chunk twice mid build
+	/// and prints how many stale results were dropped
+	/// </summary>
+	void benchmarkChunkBuilder(GLuint chunkAmount);
+
+	/// <summary>
+	/// Flies a chunk streamer in a straight line at blocksPerFrame for frameAmount simulated 60 Hz frames, once with the per frame generation budget and once without,
+	/// and prints the average and longest main thread time per frame, chunks streamed, and how many chunk objects were allocated instead of reused
+	/// </summary>
+	void benchmarkChunkStreaming(GLuint frameAmount, float blocksPerFrame);
+}
@@ -0,0 +1,95 @@
+#include <sepch.h>
+#include "FrustumCulling.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define SE_CULL_SSE
+#include <immintrin.h>
+#endif
+
+Shmingo::Frustum Shmingo::extractFrustumPlanes(const mat4& projectionMatrix, const mat4& viewMatrix) {
+
+	mat4 viewProjection = projectionMatrix * viewMatrix;
+	mat4 rows = glm::transpose(viewProjection); //Planes are sums and differences of the matrix's rows
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0]; //Left
+	frustum.planes[1] = rows[3] - rows[0]; //Right
+	frustum.planes[2] = rows[3] + rows[1]; //Bottom
+	frustum.planes[3] = rows[3] - rows[1]; //Top
+	frustum.planes[4] = rows[3] + rows[2]; //Near
+	frustum.planes[5] = rows[3] - rows[2]; //Far
+
+	for (vec4& plane : frustum.planes) {
+		plane /= glm::length(vec3(plane));
+	}
+
+	return frustum;
+}
+
+static inline float getMaxScale(const Shmingo::TransformComponent& transform) {
+	return std::max(std::max(std::abs(transform.scale.x), std::abs(transform.scale.y)), std::abs(transform.scale.z));
+}
+
+static inline bool isSphereVisible(const Shmingo::Frustum& frustum, vec3 center, float radius) {
+
+	for (const vec4& plane : frustum.planes) {
+		if (glm::dot(vec3(plane), center) + plane.w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+GLuint Shmingo::cullSpheres(const Frustum& frustum, const TransformComponent* transforms, GLuint count, float radius, GLuint firstRow, GLuint* visibleRows) {
+
+	GLuint visibleAmount = 0;
+	GLuint i = 0;
+
+#ifdef SE_CULL_SSE
+
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++) {
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+
+	__m128 baseRadius = _mm_set1_ps(radius);
+
+	for (; i + 4 <= count; i += 4) {
+
+		const TransformComponent* t = transforms + i;
+
+		//Transforms are stored as structs, so the four lanes are gathered here. Everything after is four spheres per instruction
+		__m128 x = _mm_set_ps(t[3].position.x, t[2].position.x, t[1].position.x, t[0].position.x);
+		__m128 y = _mm_set_ps(t[3].position.y, t[2].position.y, t[1].position.y, t[0].position.y);
+		__m128 z = _mm_set_ps(t[3].position.z, t[2].position.z, t[1].position.z, t[0].position.z);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(),
+			_mm_mul_ps(baseRadius, _mm_set_ps(getMaxScale(t[3]), getMaxScale(t[2]), getMaxScale(t[1]), getMaxScale(t[0]))));
+
+		int visibleMask = 0xF;
+
+		for (int p = 0; p < 6 && visibleMask != 0; p++) {
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)), _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+			visibleMask &= _mm_movemask_ps(_mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		while (visibleMask != 0) {
+			int lane = std::countr_zero((unsigned int)visibleMask);
+			visibleRows[visibleAmount++] = firstRow + i + lane;
+			visibleMask &= visibleMask - 1;
+		}
+	}
+
+#endif
+
+	for (; i < count; i++) {
+		if (isSphereVisible(frustum, transforms[i].position, radius * getMaxScale(transforms[i]))) {
+			visibleRows[visibleAmount++] = firstRow + i;
+		}
+	}
+
+	return visibleAmount;
+}
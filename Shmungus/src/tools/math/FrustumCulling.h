@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ShmingoCore.h>
+
+namespace Shmingo {
+
+	//Six planes facing into the view volume, xyz is the unit normal and w the distance, so dot(normal, point) + w is the signed distance of a point
+	struct Frustum {
+
+		vec4 planes[6];
+	};
+
+	//Extracts the view frustum of a camera, in world space
+	Frustum extractFrustumPlanes(const mat4& projectionMatrix, const mat4& viewMatrix);
+
+	/// <summary>
+	/// Tests one bounding sphere per transform against a frustum, 4 at a time with SSE where available.
+	/// Spheres are centered on each transform's position and scaled by its largest scale component
+	/// </summary>
+	/// <param name="transforms">Transforms to test, contiguous</param>
+	/// <param name="count">Amount of transforms</param>
+	/// <param name="radius">Radius of the sphere at scale 1, must cover the model from the transform's position</param>
+	/// <param name="firstRow">Row of the first transform, written rows are offset by it</param>
+	/// <param name="visibleRows">Receives the rows of visible transforms in order, must have room for count rows</param>
+	/// <returns>Amount of visible rows written</returns>
+	GLuint cullSpheres(const Frustum& frustum, const TransformComponent* transforms, GLuint count, float radius, GLuint firstRow, GLuint* visibleRows);
+}
@@ -1,6 +1,8 @@
 #include <sepch.h>
 #include "MathTools.h"
 
+#include <glm/gtc/packing.hpp>
+
 vec3 calcDirection(vec3 rotation) {
 
 	mat4 ones(1.0f);
@@ -10,4 +12,62 @@ vec3 calcDirection(vec3 rotation) {
 	glm::vec4 finalVec(xRotMatrix * yRotMatrix * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)); //All math requires vectors of length 4
 
 	return vec3(finalVec.x, finalVec.y, finalVec.z); //Return first 3 values
-}
\ No newline at end of file
+}
+
+glm::i16vec2 Shmingo::quantizeRotation(vec2 rotation) {
+
+	glm::i16vec2 out;
+
+	for (int i = 0; i < 2; i++) {
+		float wrapped = std::remainder(rotation[i], glm::two_pi<float>()); //Angle in [-pi, pi]
+		out[i] = (int16_t)std::round(glm::clamp(wrapped / glm::pi<float>(), -1.0f, 1.0f) * 32767.0f);
+	}
+
+	return out;
+}
+
+glm::u16vec3 Shmingo::packHalfVec3(vec3 value) {
+	return glm::u16vec3(glm::packHalf1x16(value.x), glm::packHalf1x16(value.y), glm::packHalf1x16(value.z));
+}
+
+//Integer hash of a grid point, spread over [0, 1]
+static float hashGridPoint(int x, int y, uint32_t seed) {
+
+	uint32_t hash = (uint32_t)x * 0x8DA6B343u ^ (uint32_t)y * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+
+	return (float)(hash & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+float Shmingo::valueNoise2D(vec2 position, uint32_t seed) {
+
+	vec2 cell = glm::floor(position);
+	vec2 fraction = position - cell;
+	vec2 weight = fraction * fraction * (3.0f - 2.0f * fraction); //Smoothstep, so slopes stay continuous across cells
+
+	int x = (int)cell.x;
+	int y = (int)cell.y;
+
+	float bottom = glm::mix(hashGridPoint(x, y, seed), hashGridPoint(x + 1, y, seed), weight.x);
+	float top = glm::mix(hashGridPoint(x, y + 1, seed), hashGridPoint(x + 1, y + 1, seed), weight.x);
+
+	return glm::mix(bottom, top, weight.y);
+}
+
+float Shmingo::fractalNoise2D(vec2 position, GLuint octaves, uint32_t seed) {
+
+	float total = 0.0f;
+	float amplitude = 1.0f;
+	float amplitudeSum = 0.0f;
+
+	for (GLuint octave = 0; octave < octaves; octave++) {
+		total += valueNoise2D(position, seed + octave) * amplitude;
+		amplitudeSum += amplitude;
+		position *= 2.0f;
+		amplitude *= 0.5f;
+	}
+
+	return amplitudeSum > 0.0f ? total / amplitudeSum : 0.0f;
+}
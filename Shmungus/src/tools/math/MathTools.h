@@ -2,5 +2,21 @@
 
 #include <ShmingoCore.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
 
-vec3 calcDirection(vec3 rotation);
\ No newline at end of file
+vec3 calcDirection(vec3 rotation);
+
+namespace Shmingo {
+
+	//Wraps pitch and yaw in radians to [-pi, pi] and stores them as snorm16 fractions of pi, about 0.0001 radians of precision
+	glm::i16vec2 quantizeRotation(vec2 rotation);
+
+	//Converts each component to a half float bit pattern
+	glm::u16vec3 packHalfVec3(vec3 value);
+
+	//Smoothly interpolated noise over a grid of hashed values, in [0, 1]. The same position and seed always give the same value
+	float valueNoise2D(vec2 position, uint32_t seed);
+
+	//Sum of octaves of value noise, each at twice the frequency and half the amplitude of the one before, in [0, 1]
+	float fractalNoise2D(vec2 position, GLuint octaves, uint32_t seed);
+}
\ No newline at end of file
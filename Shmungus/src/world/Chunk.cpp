@@ -0,0 +1,66 @@
+#include <sepch.h>
+#include "Chunk.h"
+
+Chunk::Chunk(ivec2 position) : position(position), blocks(CHUNK_BLOCK_AMOUNT, Shmingo::AIR_BLOCK) {
+	columns.fill(Shmingo::ChunkColumn());
+}
+
+void Chunk::setBlock(GLuint x, GLuint y, GLuint z, Shmingo::BlockID block) {
+
+	Shmingo::BlockID& current = blocks[getBlockIndex(x, y, z)];
+	uint64_t bit = 1ull << (y & 63);
+	uint64_t& word = columns[x * CHUNK_WIDTH + z][y >> 6];
+
+	if (current != Shmingo::AIR_BLOCK) {
+		blockAmount--;
+	}
+	if (block != Shmingo::AIR_BLOCK) {
+		blockAmount++;
+	}
+
+	current = block;
+	word = block == Shmingo::AIR_BLOCK ? word & ~bit : word | bit;
+}
+
+void Chunk::fillColumn(GLuint x, GLuint z, GLuint y, GLuint height, Shmingo::BlockID block) {
+
+	height = std::min(height, CHUNK_HEIGHT - std::min(y, CHUNK_HEIGHT));
+	if (height == 0) {
+		return;
+	}
+
+	Shmingo::BlockID* columnBlocks = &blocks[getBlockIndex(x, 0, z)];
+	Shmingo::ChunkColumn& column = columns[x * CHUNK_WIDTH + z];
+
+	for (GLuint i = y; i < y + height; i++) {
+		blockAmount -= columnBlocks[i] != Shmingo::AIR_BLOCK;
+		columnBlocks[i] = block;
+	}
+
+	//Sets or clears bits y to y + height - 1 a word at a time
+	for (GLuint word = y >> 6; word <= (y + height - 1) >> 6; word++) {
+
+		GLuint first = std::max(y, word * 64) - word * 64;
+		GLuint last = std::min(y + height, word * 64 + 64) - word * 64; //One past the last bit
+		uint64_t mask = (last - first == 64) ? ~0ull : ((1ull << (last - first)) - 1) << first;
+
+		column[word] = block == Shmingo::AIR_BLOCK ? column[word] & ~mask : column[word] | mask;
+	}
+
+	if (block != Shmingo::AIR_BLOCK) {
+		blockAmount += height;
+	}
+}
+
+void Chunk::clear() {
+
+	std::fill(blocks.begin(), blocks.end(), Shmingo::AIR_BLOCK);
+	columns.fill(Shmingo::ChunkColumn());
+	blockAmount = 0;
+}
+
+void Chunk::reset(ivec2 position) {
+
+	this->position = position;
+	clear();
+}
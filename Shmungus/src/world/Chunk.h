@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+const GLuint CHUNK_WIDTH = 16; //Blocks along x and z, positions are packed into 4 bits each
+const GLuint CHUNK_HEIGHT = 256; //Blocks along y, packed into 8 bits
+const GLuint CHUNK_COLUMN_WORDS = CHUNK_HEIGHT / 64; //64 bit words in one column's opaque mask
+const GLuint CHUNK_BLOCK_AMOUNT = CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT;
+
+namespace Shmingo {
+
+	//Material of a block, 0 is air. Only the low 10 bits reach the terrain shader
+	typedef uint16_t BlockID;
+
+	const BlockID AIR_BLOCK = 0;
+	const BlockID MAX_BLOCK_ID = 0x3FF;
+
+	//Bit y of word y / 64 is set when the block at height y is solid
+	typedef std::array<uint64_t, CHUNK_COLUMN_WORDS> ChunkColumn;
+
+	//One key per chunk position, for maps of chunks
+	inline uint64_t packChunkPosition(ivec2 position) {
+		return ((uint64_t)(uint32_t)position.x << 32) | (uint32_t)position.y;
+	}
+
+	//Chunk position of the chunk containing a world position
+	inline ivec2 getChunkPosition(vec3 position) {
+		return ivec2((int)std::floor(position.x / (float)CHUNK_WIDTH), (int)std::floor(position.z / (float)CHUNK_WIDTH));
+	}
+}
+
+/*
+Blocks of one 16 x 256 x 16 column of the world. Blocks are stored column by column with y contiguous, and next to them every column keeps
+a 256 bit mask of which heights are solid. The mask is updated on every set, so meshing reads whole columns as four words instead of looking up blocks one at a time.
+Nothing here touches GL, chunks can be filled and meshed on any thread.
+*/
+class Chunk {
+
+public:
+
+	//position is in chunks, the chunk covers blocks position * CHUNK_WIDTH to position * CHUNK_WIDTH + CHUNK_WIDTH - 1 along x and z
+	Chunk(ivec2 position = ivec2(0, 0));
+
+	inline Shmingo::BlockID getBlock(GLuint x, GLuint y, GLuint z) const { return blocks[getBlockIndex(x, y, z)]; };
+	void setBlock(GLuint x, GLuint y, GLuint z, Shmingo::BlockID block);
+
+	//Sets every block of a column from y to y + height - 1, faster than setting them one by one
+	void fillColumn(GLuint x, GLuint z, GLuint y, GLuint height, Shmingo::BlockID block);
+
+	//Turns every block into air
+	void clear();
+
+	//Turns every block into air and moves the chunk to position, so chunk objects are reused instead of reallocated
+	void reset(ivec2 position);
+
+	inline const Shmingo::ChunkColumn& getColumn(GLuint x, GLuint z) const { return columns[x * CHUNK_WIDTH + z]; };
+
+	//Blocks of a column from y = 0 upwards
+	inline const Shmingo::BlockID* getColumnBlocks(GLuint x, GLuint z) const { return &blocks[getBlockIndex(x, 0, z)]; };
+
+	inline ivec2 getPosition() const { return position; };
+
+	//Amount of solid blocks
+	inline GLuint getBlockAmount() const { return blockAmount; };
+
+private:
+
+	ivec2 position;
+
+	std::vector<Shmingo::BlockID> blocks;
+	std::array<Shmingo::ChunkColumn, CHUNK_WIDTH * CHUNK_WIDTH> columns;
+	GLuint blockAmount = 0;
+
+	inline static size_t getBlockIndex(GLuint x, GLuint y, GLuint z) { return ((size_t)x * CHUNK_WIDTH + z) * CHUNK_HEIGHT + y; };
+};
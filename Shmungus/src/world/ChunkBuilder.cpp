@@ -0,0 +1,247 @@
+#include <sepch.h>
+#include "ChunkBuilder.h"
+
+ChunkBuilder::~ChunkBuilder() {
+	shutdown();
+}
+
+void ChunkBuilder::init(GLuint workerAmount) {
+
+	if (workerAmount == 0xFFFFFFFF) {
+		workerAmount = std::max(1u, std::thread::hardware_concurrency() / 4);
+	}
+
+	running = true;
+
+	for (GLuint i = 0; i < workerAmount; i++) {
+		workers.emplace_back(&ChunkBuilder::workerLoop, this);
+	}
+}
+
+void ChunkBuilder::shutdown() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	workCondition.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	queuedJobs.clear();
+	finishedResults.clear();
+	freeMeshes.clear();
+	currentVersions.clear();
+	runningAmount = 0;
+}
+
+void ChunkBuilder::markDirty(std::shared_ptr<const Chunk> chunk, const Shmingo::ChunkBuildNeighbors& neighbors, std::shared_ptr<ChunkVertexArray> vertexArray) {
+
+	ivec2 position = chunk->getPosition();
+
+	BuildJob job(position, 0, std::chrono::high_resolution_clock::now(), std::move(chunk), neighbors, std::move(vertexArray));
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		job.version = nextVersion++;
+		currentVersions[Shmingo::packChunkPosition(position)] = job.version; //A running or finished build of the chunk is stale from here on
+
+		//Same position means same priority, so a queued job is swapped out in place without touching the heap order
+		auto queued = std::find_if(queuedJobs.begin(), queuedJobs.end(), [position](const BuildJob& other) { return other.position == position; });
+
+		if (queued != queuedJobs.end()) {
+			job.markedTime = queued->markedTime; //Latency counts from the first time the chunk went dirty
+			*queued = std::move(job);
+			return;
+		}
+
+		queuedJobs.emplace_back(std::move(job));
+		std::push_heap(queuedJobs.begin(), queuedJobs.end(), [this](const BuildJob& a, const BuildJob& b) { return isFartherThan(a, b); });
+	}
+
+	workCondition.notify_one();
+}
+
+void ChunkBuilder::cancel(ivec2 position) {
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (currentVersions.erase(Shmingo::packChunkPosition(position)) == 0) {
+		return;
+	}
+
+	auto queued = std::find_if(queuedJobs.begin(), queuedJobs.end(), [position](const BuildJob& other) { return other.position == position; });
+
+	if (queued != queuedJobs.end()) {
+		queuedJobs.erase(queued);
+		std::make_heap(queuedJobs.begin(), queuedJobs.end(), [this](const BuildJob& a, const BuildJob& b) { return isFartherThan(a, b); });
+		cancelledAmount++;
+	}
+}
+
+void ChunkBuilder::setCameraPosition(vec3 position) {
+
+	ivec2 chunk = Shmingo::getChunkPosition(position);
+
+	if (chunk == cameraChunk) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	cameraChunk = chunk;
+	std::make_heap(queuedJobs.begin(), queuedJobs.end(), [this](const BuildJob& a, const BuildJob& b) { return isFartherThan(a, b); });
+}
+
+size_t ChunkBuilder::uploadFinished(size_t byteBudget) {
+
+	std::vector<BuildResult> uploads;
+	size_t uploadBytes = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		while (!finishedResults.empty()) {
+
+			BuildResult& result = finishedResults.front();
+
+			//Marked dirty again or cancelled while waiting here
+			if (!isCurrent(result.position, result.version)) {
+				freeMeshes.emplace_back(std::move(result.mesh));
+				finishedResults.pop_front();
+				cancelledAmount++;
+				continue;
+			}
+
+			size_t bytes = (size_t)result.mesh.getTriangleAmount() * CHUNK_MESH_TRIANGLE_BYTES;
+			if (!uploads.empty() && uploadBytes + bytes > byteBudget) {
+				break;
+			}
+
+			uploadBytes += bytes;
+			currentVersions.erase(Shmingo::packChunkPosition(result.position)); //Built, nothing of the chunk is in flight anymore
+
+			uploads.emplace_back(std::move(result));
+			finishedResults.pop_front();
+		}
+	}
+
+	if (uploads.empty()) {
+		return 0;
+	}
+
+	//GL calls outside the lock, workers keep finishing meanwhile
+	for (BuildResult& result : uploads) {
+
+		result.vertexArray->submitMesh(result.mesh);
+
+		latencyHistory[latencyAmount % CHUNK_BUILD_LATENCY_HISTORY] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - result.markedTime).count();
+		latencyAmount++;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (BuildResult& result : uploads) {
+		freeMeshes.emplace_back(std::move(result.mesh));
+	}
+
+	return uploadBytes;
+}
+
+Shmingo::ChunkBuildStats ChunkBuilder::getStats() {
+
+	Shmingo::ChunkBuildStats stats;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		stats.queuedAmount = (GLuint)queuedJobs.size();
+		stats.buildingAmount = runningAmount + (GLuint)finishedResults.size();
+		stats.cancelledAmount = cancelledAmount;
+	}
+
+	GLuint historyAmount = std::min(latencyAmount, CHUNK_BUILD_LATENCY_HISTORY);
+
+	for (GLuint i = 0; i < historyAmount; i++) {
+		stats.averageLatencyMs += latencyHistory[i];
+		stats.maxLatencyMs = std::max(stats.maxLatencyMs, latencyHistory[i]);
+	}
+
+	if (historyAmount > 0) {
+		stats.averageLatencyMs /= historyAmount;
+	}
+
+	return stats;
+}
+
+bool ChunkBuilder::isIdle() {
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return queuedJobs.empty() && runningAmount == 0 && finishedResults.empty();
+}
+
+void ChunkBuilder::workerLoop() {
+
+	while (true) {
+
+		BuildJob job;
+		Shmingo::ChunkMesh mesh;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workCondition.wait(lock, [this] { return !queuedJobs.empty() || !running; });
+
+			if (!running) {
+				return;
+			}
+
+			std::pop_heap(queuedJobs.begin(), queuedJobs.end(), [this](const BuildJob& a, const BuildJob& b) { return isFartherThan(a, b); });
+			job = std::move(queuedJobs.back());
+			queuedJobs.pop_back();
+
+			if (!freeMeshes.empty()) {
+				mesh = std::move(freeMeshes.back());
+				freeMeshes.pop_back();
+			}
+
+			runningAmount++;
+		}
+
+		Shmingo::ChunkNeighbors neighbors(job.neighbors.positiveX.get(), job.neighbors.negativeX.get(), job.neighbors.positiveZ.get(), job.neighbors.negativeZ.get());
+		Shmingo::meshChunk(*job.chunk, neighbors, mesh);
+
+		//Let go of the chunks before publishing, so once the result is visible the main thread can edit them in place again
+		job.chunk.reset();
+		job.neighbors = Shmingo::ChunkBuildNeighbors();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		runningAmount--;
+
+		if (!isCurrent(job.position, job.version)) {
+			freeMeshes.emplace_back(std::move(mesh));
+			cancelledAmount++;
+			continue;
+		}
+
+		finishedResults.emplace_back(BuildResult(job.position, job.version, job.markedTime, std::move(job.vertexArray), std::move(mesh)));
+	}
+}
+
+bool ChunkBuilder::isFartherThan(const BuildJob& a, const BuildJob& b) const {
+
+	ivec2 offsetA = a.position - cameraChunk;
+	ivec2 offsetB = b.position - cameraChunk;
+
+	return offsetA.x * offsetA.x + offsetA.y * offsetA.y > offsetB.x * offsetB.x + offsetB.y * offsetB.y;
+}
+
+bool ChunkBuilder::isCurrent(ivec2 position, GLuint version) const {
+
+	auto it = currentVersions.find(Shmingo::packChunkPosition(position));
+	return it != currentVersions.end() && it->second == version;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "Chunk.h"
+#include "ChunkMesher.h"
+#include "ChunkVertexArray.h"
+
+const size_t CHUNK_UPLOAD_BYTE_BUDGET = 256 * 1024; //Mesh bytes uploaded per frame, a single mesh larger than this still goes up on its own
+const size_t CHUNK_MESH_TRIANGLE_BYTES = 6; //Position, ID and extents of one triangle
+const GLuint CHUNK_BUILD_LATENCY_HISTORY = 64; //Latest builds the latency statistics cover
+
+namespace Shmingo {
+
+	//Chunks around the one being built. The build holds them until it has meshed, a missing neighbor counts as air
+	struct ChunkBuildNeighbors {
+
+		std::shared_ptr<const Chunk> positiveX;
+		std::shared_ptr<const Chunk> negativeX;
+		std::shared_ptr<const Chunk> positiveZ;
+		std::shared_ptr<const Chunk> negativeZ;
+	};
+
+	struct ChunkBuildStats {
+
+		GLuint queuedAmount = 0; //Waiting for a worker
+		GLuint buildingAmount = 0; //Being meshed or waiting for upload
+		GLuint cancelledAmount = 0; //Results dropped since init because their chunk was marked dirty again or cancelled
+		double averageLatencyMs = 0.0; //From being marked dirty to being uploaded, over the latest CHUNK_BUILD_LATENCY_HISTORY builds
+		double maxLatencyMs = 0.0;
+	};
+
+	/// <summary>
+	/// Makes a chunk safe to edit while builds may be reading it. If anything else holds the chunk it is copied first,
+	/// so a build never sees a half edited chunk and the caller's pointer moves to the copy
+	/// </summary>
+	/// <returns>The chunk to edit</returns>
+	inline Chunk& editChunk(std::shared_ptr<Chunk>& chunk) {
+
+		if (chunk.use_count() > 1) {
+			chunk = std::make_shared<Chunk>(*chunk);
+		}
+		return *chunk;
+	}
+}
+
+/*
+Meshes chunks on worker threads, so the thread that draws never does. The main thread marks chunks dirty, workers take the dirty chunk closest
+to the camera first and mesh it, and uploadFinished copies finished meshes into their vertex arrays on the GL thread, a byte budget's worth per frame.
+Builds read their chunk and its neighbors while the main thread carries on, so a chunk that was handed to a build must not be edited in place,
+see Shmingo::editChunk. Marking a chunk dirty again supersedes its earlier build wherever that is: a queued build is replaced,
+a running or finished one is dropped instead of uploaded.
+Every function is main thread only
+*/
+class ChunkBuilder {
+
+public:
+
+	~ChunkBuilder();
+
+	/// <summary>
+	/// Starts the worker threads
+	/// </summary>
+	/// <param name="workerAmount">Defaults to a quarter of the hardware threads, at least one, the job system and simulation use the rest</param>
+	void init(GLuint workerAmount = 0xFFFFFFFF);
+
+	//Joins the workers and drops every queued and finished build
+	void shutdown();
+
+	/// <summary>
+	/// Queues a chunk to be meshed into vertexArray, replacing any build of the same chunk position
+	/// </summary>
+	/// <param name="chunk">Held until meshed, must not change meanwhile</param>
+	/// <param name="neighbors">Held until meshed, must not change meanwhile</param>
+	/// <param name="vertexArray">Receives the mesh in uploadFinished</param>
+	void markDirty(std::shared_ptr<const Chunk> chunk, const Shmingo::ChunkBuildNeighbors& neighbors, std::shared_ptr<ChunkVertexArray> vertexArray);
+
+	//Drops every build of the chunk at position, for chunks being unloaded
+	void cancel(ivec2 position);
+
+	//Queued builds are ordered by their chunk's distance from here. Only reorders the queue when the camera enters another chunk
+	void setCameraPosition(vec3 position);
+
+	/// <summary>
+	/// GL thread. Uploads finished meshes, in the order they finished, until byteBudget is spent
+	/// </summary>
+	/// <returns>Bytes uploaded</returns>
+	size_t uploadFinished(size_t byteBudget = CHUNK_UPLOAD_BYTE_BUDGET);
+
+	Shmingo::ChunkBuildStats getStats();
+
+	//No build is queued, running or waiting for upload
+	bool isIdle();
+
+private:
+
+	typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+	struct BuildJob {
+
+		ivec2 position;
+		GLuint version;
+		TimePoint markedTime;
+
+		std::shared_ptr<const Chunk> chunk;
+		Shmingo::ChunkBuildNeighbors neighbors;
+		std::shared_ptr<ChunkVertexArray> vertexArray;
+	};
+
+	struct BuildResult {
+
+		ivec2 position;
+		GLuint version;
+		TimePoint markedTime;
+
+		std::shared_ptr<ChunkVertexArray> vertexArray;
+		Shmingo::ChunkMesh mesh;
+	};
+
+	std::vector<std::thread> workers;
+
+	//Everything below is shared with the workers and guarded by mutex
+	std::mutex mutex;
+	std::condition_variable workCondition;
+	bool running = false;
+
+	std::vector<BuildJob> queuedJobs; //Heap, closest chunk to the camera on top. Holds at most one job per chunk position
+	std::deque<BuildResult> finishedResults;
+	std::vector<Shmingo::ChunkMesh> freeMeshes; //Meshes of uploaded results, reused so workers stop allocating
+
+	std::unordered_map<uint64_t, GLuint> currentVersions; //Latest version of every chunk position with a build anywhere, keyed by Shmingo::packChunkPosition
+	GLuint nextVersion = 1;
+	ivec2 cameraChunk = ivec2(0, 0);
+
+	GLuint runningAmount = 0;
+	GLuint cancelledAmount = 0;
+
+	//Main thread only
+	std::array<double, CHUNK_BUILD_LATENCY_HISTORY> latencyHistory = {};
+	GLuint latencyAmount = 0; //Builds recorded into the history, wraps around it
+
+	void workerLoop();
+
+	//Heap order, true if a should be built after b
+	bool isFartherThan(const BuildJob& a, const BuildJob& b) const;
+
+	//Whether version is still the chunk's latest build. Needs the mutex
+	bool isCurrent(ivec2 position, GLuint version) const;
+};
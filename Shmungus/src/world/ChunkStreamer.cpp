@@ -0,0 +1,238 @@
+#include <sepch.h>
+#include "ChunkStreamer.h"
+
+#include "TerrainGenerator.h"
+#include "MasterRenderer.h"
+
+void ChunkStreamer::init(ChunkBuilder& builder, GLuint viewRadius, uint32_t seed) {
+
+	this->builder = &builder;
+	this->viewRadius = viewRadius;
+	this->seed = seed;
+
+	//One ring past the view radius is generated and never meshed, so every chunk on the view radius has its 4 neighbors
+	int radius = (int)viewRadius + 1;
+
+	spiralOffsets.clear();
+
+	for (int x = -radius; x <= radius; x++) {
+		for (int z = -radius; z <= radius; z++) {
+			if (x * x + z * z <= radius * radius) {
+				spiralOffsets.emplace_back(x, z);
+			}
+		}
+	}
+
+	//Rings by distance, ties broken by angle so every ring is walked around in one direction
+	std::sort(spiralOffsets.begin(), spiralOffsets.end(), [](ivec2 a, ivec2 b) {
+
+		int distanceA = a.x * a.x + a.y * a.y;
+		int distanceB = b.x * b.x + b.y * b.y;
+
+		if (distanceA != distanceB) {
+			return distanceA < distanceB;
+		}
+		return std::atan2((float)a.y, (float)a.x) < std::atan2((float)b.y, (float)b.x);
+	});
+
+	hasCenter = false;
+	createdChunkAmount = 0;
+}
+
+GLuint ChunkStreamer::update(vec3 centerPosition, double frameBudgetMs) {
+
+	ivec2 chunk = Shmingo::getChunkPosition(centerPosition);
+
+	if (!hasCenter || chunk != centerChunk) {
+		moveCenter(chunk);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	GLuint generatedAmount = 0;
+
+	while (nextPendingLoad < pendingLoads.size()) {
+
+		ivec2 position = pendingLoads[nextPendingLoad++];
+
+		if (findLoaded(position) != nullptr) {
+			continue;
+		}
+
+		loadChunk(position);
+		generatedAmount++;
+
+		if (std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() >= frameBudgetMs) {
+			break;
+		}
+	}
+
+	return generatedAmount;
+}
+
+void ChunkStreamer::submitDraws() {
+
+	for (auto& [key, loaded] : loadedChunks) {
+		if (loaded.vertexArray->getInstanceCount() > 0) {
+			se_masterRenderer.submitTerrainVertexArray(loaded.vertexArray, se_TERRAIN_SHADER);
+		}
+	}
+}
+
+void ChunkStreamer::clear() {
+
+	while (!loadedChunks.empty()) {
+		unloadChunk(loadedChunks.begin());
+	}
+
+	for (std::shared_ptr<ChunkVertexArray>& vertexArray : vertexArrayPool) {
+		vertexArray->cleanUp();
+	}
+
+	vertexArrayPool.clear();
+	chunkPool.clear();
+	pendingLoads.clear();
+	nextPendingLoad = 0;
+	hasCenter = false;
+}
+
+Shmingo::ChunkStreamStats ChunkStreamer::getStats() {
+
+	Shmingo::ChunkStreamStats stats;
+
+	stats.loadedAmount = (GLuint)loadedChunks.size();
+	stats.pooledAmount = (GLuint)chunkPool.size();
+	stats.createdAmount = createdChunkAmount;
+
+	for (auto& [key, loaded] : loadedChunks) {
+		if (loaded.vertexArray->getInstanceCount() > 0) {
+			stats.meshedAmount++;
+		}
+	}
+
+	for (size_t i = nextPendingLoad; i < pendingLoads.size(); i++) {
+		if (findLoaded(pendingLoads[i]) == nullptr) {
+			stats.pendingAmount++;
+		}
+	}
+
+	return stats;
+}
+
+void ChunkStreamer::moveCenter(ivec2 chunk) {
+
+	centerChunk = chunk;
+	hasCenter = true;
+
+	int unloadRadius = (int)(viewRadius + CHUNK_UNLOAD_MARGIN);
+
+	for (auto it = loadedChunks.begin(); it != loadedChunks.end();) {
+
+		ivec2 offset = it->second.chunk->getPosition() - centerChunk;
+
+		if (offset.x * offset.x + offset.y * offset.y > unloadRadius * unloadRadius) {
+			auto next = std::next(it);
+			unloadChunk(it);
+			it = next;
+		}
+		else {
+			it++;
+		}
+	}
+
+	//Chunks that are still loaded are skipped when their turn comes, so the list is just the spiral around the new center
+	pendingLoads.clear();
+	nextPendingLoad = 0;
+
+	for (ivec2 offset : spiralOffsets) {
+		if (findLoaded(centerChunk + offset) == nullptr) {
+			pendingLoads.emplace_back(centerChunk + offset);
+		}
+	}
+
+	builder->setCameraPosition(vec3((float)(centerChunk.x * (int)CHUNK_WIDTH), 0.0f, (float)(centerChunk.y * (int)CHUNK_WIDTH)));
+}
+
+void ChunkStreamer::loadChunk(ivec2 position) {
+
+	std::shared_ptr<Chunk> chunk = takePooledChunk(position);
+	Shmingo::generateTerrain(*chunk, seed);
+
+	std::shared_ptr<ChunkVertexArray> vertexArray = takePooledVertexArray();
+	vertexArray->setChunkPosition(position);
+
+	loadedChunks.emplace(Shmingo::packChunkPosition(position), LoadedChunk(std::move(chunk), std::move(vertexArray), false));
+
+	//This chunk may have been the last missing neighbor of the ones around it
+	requestMesh(position);
+	requestMesh(position + ivec2(1, 0));
+	requestMesh(position + ivec2(-1, 0));
+	requestMesh(position + ivec2(0, 1));
+	requestMesh(position + ivec2(0, -1));
+}
+
+void ChunkStreamer::unloadChunk(std::unordered_map<uint64_t, LoadedChunk>::iterator loaded) {
+
+	builder->cancel(loaded->second.chunk->getPosition()); //A build still running is dropped instead of uploaded into the recycled vertex array
+
+	loaded->second.vertexArray->clear();
+
+	chunkPool.emplace_back(std::move(loaded->second.chunk));
+	vertexArrayPool.emplace_back(std::move(loaded->second.vertexArray));
+
+	loadedChunks.erase(loaded);
+}
+
+void ChunkStreamer::requestMesh(ivec2 position) {
+
+	LoadedChunk* loaded = findLoaded(position);
+
+	if (loaded == nullptr || loaded->meshRequested) {
+		return;
+	}
+
+	LoadedChunk* positiveX = findLoaded(position + ivec2(1, 0));
+	LoadedChunk* negativeX = findLoaded(position + ivec2(-1, 0));
+	LoadedChunk* positiveZ = findLoaded(position + ivec2(0, 1));
+	LoadedChunk* negativeZ = findLoaded(position + ivec2(0, -1));
+
+	//Chunks on the edge of the loaded area wait, meshing them against air would draw walls along the border
+	if (positiveX == nullptr || negativeX == nullptr || positiveZ == nullptr || negativeZ == nullptr) {
+		return;
+	}
+
+	builder->markDirty(loaded->chunk, Shmingo::ChunkBuildNeighbors(positiveX->chunk, negativeX->chunk, positiveZ->chunk, negativeZ->chunk), loaded->vertexArray);
+	loaded->meshRequested = true;
+}
+
+std::shared_ptr<Chunk> ChunkStreamer::takePooledChunk(ivec2 position) {
+
+	//Oldest first, the most recently unloaded are the likeliest to still be held by a neighbor's build
+	for (auto it = chunkPool.begin(); it != chunkPool.end(); it++) {
+
+		if (it->use_count() == 1) {
+
+			std::shared_ptr<Chunk> chunk = std::move(*it);
+			*it = std::move(chunkPool.back());
+			chunkPool.pop_back();
+
+			chunk->reset(position);
+			return chunk;
+		}
+	}
+
+	createdChunkAmount++;
+	return std::make_shared<Chunk>(position);
+}
+
+std::shared_ptr<ChunkVertexArray> ChunkStreamer::takePooledVertexArray() {
+
+	//Builds of unloaded chunks are cancelled, so a pooled vertex array never receives another upload and is free right away
+	if (vertexArrayPool.empty()) {
+		return std::make_shared<ChunkVertexArray>();
+	}
+
+	std::shared_ptr<ChunkVertexArray> vertexArray = std::move(vertexArrayPool.back());
+	vertexArrayPool.pop_back();
+
+	return vertexArray;
+}
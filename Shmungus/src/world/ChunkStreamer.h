@@ -0,0 +1,109 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include "Chunk.h"
+#include "ChunkBuilder.h"
+#include "ChunkVertexArray.h"
+
+const GLuint CHUNK_VIEW_RADIUS = 8; //Chunks are drawn this far around the center, in chunks
+const GLuint CHUNK_UNLOAD_MARGIN = 2; //Loaded chunks stay until they are this much past the view radius, so pacing along a chunk border does not load and unload the same ring
+const double CHUNK_STREAM_FRAME_BUDGET_MS = 2.0; //Main thread time spent generating chunks per frame, at least one chunk is generated regardless
+const uint32_t CHUNK_STREAM_SEED = 1234;
+
+namespace Shmingo {
+
+	struct ChunkStreamStats {
+
+		GLuint loadedAmount = 0; //Generated and in memory
+		GLuint meshedAmount = 0; //Loaded and drawing something
+		GLuint pendingAmount = 0; //Around the center and not loaded yet
+		GLuint pooledAmount = 0; //Chunk objects waiting to be reused
+		GLuint createdAmount = 0; //Chunk objects allocated since init, stops growing once the pools cover what moving unloads
+	};
+}
+
+/*
+Keeps the terrain around a moving center loaded. Chunks inside the view radius are generated closest first, walking a spiral of offsets
+sorted by distance, and handed to the chunk builder once all 4 of their neighbors are loaded so their borders mesh against real blocks.
+Chunks past the view radius plus a margin are unloaded, their chunk objects and vertex arrays go to pools and are reused by the next chunks loaded,
+so streaming allocates nothing once the pools have filled.
+Generation runs on the main thread under a time budget per frame and meshing runs on the builder's threads under its upload budget,
+so moving fast only makes the pending list longer, never a frame longer.
+Every function is main thread only
+*/
+class ChunkStreamer {
+
+public:
+
+	/// <summary>
+	/// Starts streaming with builder meshing the chunks. Nothing loads until the first update
+	/// </summary>
+	/// <param name="builder">Must outlive the streamer's chunks, see clear</param>
+	/// <param name="viewRadius">Chunks loaded around the center</param>
+	/// <param name="seed">Terrain seed</param>
+	void init(ChunkBuilder& builder, GLuint viewRadius = CHUNK_VIEW_RADIUS, uint32_t seed = CHUNK_STREAM_SEED);
+
+	/// <summary>
+	/// Moves the center, unloading what fell out of range when it entered another chunk, then generates pending chunks closest first until frameBudgetMs is spent
+	/// </summary>
+	/// <param name="centerPosition">World position, usually the player's</param>
+	/// <returns>Chunks generated</returns>
+	GLuint update(vec3 centerPosition, double frameBudgetMs = CHUNK_STREAM_FRAME_BUDGET_MS);
+
+	//Submits every loaded chunk with a mesh to the master renderer
+	void submitDraws();
+
+	//Unloads every chunk and frees the pools' GL buffers. The builder must be shut down first, it may still hold vertex arrays
+	void clear();
+
+	Shmingo::ChunkStreamStats getStats();
+
+	//Every chunk around the center is loaded
+	inline bool isSettled() { return nextPendingLoad >= pendingLoads.size(); };
+
+private:
+
+	struct LoadedChunk {
+
+		std::shared_ptr<Chunk> chunk;
+		std::shared_ptr<ChunkVertexArray> vertexArray;
+		bool meshRequested = false; //Handed to the builder, a chunk is meshed once when its last neighbor loads
+	};
+
+	ChunkBuilder* builder = nullptr;
+	GLuint viewRadius = CHUNK_VIEW_RADIUS;
+	uint32_t seed = CHUNK_STREAM_SEED;
+
+	std::unordered_map<uint64_t, LoadedChunk> loadedChunks; //Keyed by Shmingo::packChunkPosition
+
+	std::vector<ivec2> spiralOffsets; //Every offset inside the view radius plus one, closest first
+	std::vector<ivec2> pendingLoads; //Chunks to load around the current center, in spiral order. Rebuilt when the center enters another chunk
+	size_t nextPendingLoad = 0;
+
+	ivec2 centerChunk = ivec2(0, 0);
+	bool hasCenter = false;
+
+	//Chunks may still be held by builds after unloading, they are only reused once nothing else holds them
+	std::vector<std::shared_ptr<Chunk>> chunkPool;
+	std::vector<std::shared_ptr<ChunkVertexArray>> vertexArrayPool;
+	GLuint createdChunkAmount = 0;
+
+	//Loads the pending list for a new center and unloads everything past the unload radius
+	void moveCenter(ivec2 chunk);
+
+	void loadChunk(ivec2 position);
+	void unloadChunk(std::unordered_map<uint64_t, LoadedChunk>::iterator loaded);
+
+	//Hands a loaded chunk to the builder if it has not been yet and all its neighbors are loaded
+	void requestMesh(ivec2 position);
+
+	std::shared_ptr<Chunk> takePooledChunk(ivec2 position);
+	std::shared_ptr<ChunkVertexArray> takePooledVertexArray();
+
+	inline LoadedChunk* findLoaded(ivec2 position) {
+		auto it = loadedChunks.find(Shmingo::packChunkPosition(position));
+		return it == loadedChunks.end() ? nullptr : &it->second;
+	}
+};
@@ -0,0 +1,527 @@
+#include <sepch.h>
+#include "DynamicAABBTree.h"
+
+#include "JobSystem.h"
+
+//Overlap tests -----------------------------------------------------------------
+
+static inline bool overlapsSphere(const Shmingo::AABB& box, const Shmingo::BoundingSphere& sphere) {
+	vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+	vec3 offset = sphere.center - closest;
+	return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+}
+
+static inline bool overlapsFrustum(const Shmingo::AABB& box, const Shmingo::Frustum& frustum) {
+
+	for (const vec4& plane : frustum.planes) {
+
+		//Corner furthest along the plane normal, if even that one is behind the plane the whole box is
+		vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+
+		if (glm::dot(vec3(plane), corner) + plane.w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//Slab test, returns the distance at which the ray enters the box or -1 if it misses it within maxDistance
+static inline float intersectRay(const Shmingo::AABB& box, vec3 origin, vec3 inverseDirection, float maxDistance) {
+
+	vec3 t1 = (box.min - origin) * inverseDirection;
+	vec3 t2 = (box.max - origin) * inverseDirection;
+
+	vec3 tNear = glm::min(t1, t2);
+	vec3 tFar = glm::max(t1, t2);
+
+	float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+	return entry <= exit ? entry : -1.0f;
+}
+
+
+
+//Changes -----------------------------------------------------------------------
+
+void DynamicAABBTree::insert(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds) {
+	insertLeaf(createLeaf(handle, bounds));
+}
+
+void DynamicAABBTree::insertBatch(std::span<const Shmingo::EntityHandle> handles, std::span<const Shmingo::AABB> bounds) {
+
+	if (handles.empty()) {
+		return;
+	}
+
+	bool rebuild = handles.size() >= leafAmount;
+
+	nodes.reserve(nodes.size() + 2 * handles.size()); //Every leaf and, on a rebuild, about as many internal nodes
+
+	if (!rebuild) {
+		for (size_t i = 0; i < handles.size(); i++) {
+			insertLeaf(createLeaf(handles[i], bounds[i]));
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < handles.size(); i++) {
+		createLeaf(handles[i], bounds[i]);
+	}
+
+	//Only the leaves are kept, the internal nodes above them are rebuilt from scratch
+	for (GLuint node = 0; node < nodes.size(); node++) {
+		if (nodes[node].height > 0) {
+			freeNode(node);
+		}
+	}
+
+	//Centers are gathered once so the splits sort small records instead of reaching into the nodes
+	std::vector<BuildLeaf> leaves;
+	leaves.reserve(leafAmount);
+
+	for (GLuint leaf : handleLeaves) {
+		if (leaf != AABB_TREE_NULL_NODE) {
+			leaves.emplace_back(BuildLeaf(nodes[leaf].box.min + nodes[leaf].box.max, leaf));
+		}
+	}
+
+	root = buildSubtree(leaves);
+	nodes[root].parent = AABB_TREE_NULL_NODE;
+}
+
+void DynamicAABBTree::remove(Shmingo::EntityHandle handle) {
+
+	if (!contains(handle)) {
+		return;
+	}
+
+	GLuint leaf = handleLeaves[handle.index];
+
+	removeLeaf(leaf);
+	freeNode(leaf);
+
+	handleLeaves[handle.index] = AABB_TREE_NULL_NODE;
+	leafAmount--;
+}
+
+bool DynamicAABBTree::update(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds) {
+
+	if (!contains(handle)) {
+		return false;
+	}
+
+	GLuint leaf = handleLeaves[handle.index];
+	nodes[leaf].tightBox = bounds;
+
+	if (nodes[leaf].box.contains(bounds)) { //Small move, no node above the leaf changes
+		return false;
+	}
+
+	removeLeaf(leaf);
+	nodes[leaf].box = Shmingo::AABB(bounds.min - vec3(AABB_TREE_FAT_MARGIN), bounds.max + vec3(AABB_TREE_FAT_MARGIN));
+	insertLeaf(leaf);
+
+	return true;
+}
+
+void DynamicAABBTree::clear() {
+	nodes.clear();
+	handleLeaves.clear();
+	root = AABB_TREE_NULL_NODE;
+	freeList = AABB_TREE_NULL_NODE;
+	leafAmount = 0;
+}
+
+
+
+//Queries -----------------------------------------------------------------------
+
+template<typename Test, typename Visit>
+void DynamicAABBTree::traverse(Test test, Visit visit, std::vector<GLuint>& stack) const {
+
+	if (root == AABB_TREE_NULL_NODE) {
+		return;
+	}
+
+	stack.clear();
+	stack.emplace_back(root);
+
+	while (!stack.empty()) {
+
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!test(node.box)) {
+			continue;
+		}
+
+		if (node.isLeaf()) {
+			if (test(node.tightBox)) {
+				visit(node);
+			}
+			continue;
+		}
+
+		stack.emplace_back(node.child1);
+		stack.emplace_back(node.child2);
+	}
+}
+
+void DynamicAABBTree::queryAABB(const Shmingo::AABB& bounds, std::vector<Shmingo::EntityHandle>& results) const {
+
+	std::vector<GLuint> stack;
+	traverse([&](const Shmingo::AABB& box) { return box.overlaps(bounds); }, [&](const Node& leaf) { results.emplace_back(leaf.handle); }, stack);
+}
+
+void DynamicAABBTree::querySphere(const Shmingo::BoundingSphere& sphere, std::vector<Shmingo::EntityHandle>& results) const {
+
+	std::vector<GLuint> stack;
+	traverse([&](const Shmingo::AABB& box) { return overlapsSphere(box, sphere); }, [&](const Node& leaf) { results.emplace_back(leaf.handle); }, stack);
+}
+
+void DynamicAABBTree::queryFrustum(const Shmingo::Frustum& frustum, std::vector<Shmingo::EntityHandle>& results) const {
+
+	std::vector<GLuint> stack;
+	traverse([&](const Shmingo::AABB& box) { return overlapsFrustum(box, frustum); }, [&](const Node& leaf) { results.emplace_back(leaf.handle); }, stack);
+}
+
+Shmingo::RayHit DynamicAABBTree::raycast(const Shmingo::Ray& ray) const {
+
+	Shmingo::RayHit hit;
+	float closest = ray.maxDistance; //Shrinks with every hit, so anything behind the closest hit so far is pruned
+	vec3 inverseDirection = 1.0f / ray.direction;
+
+	std::vector<GLuint> stack;
+	traverse([&](const Shmingo::AABB& box) { return intersectRay(box, ray.origin, inverseDirection, closest) >= 0.0f; },
+		[&](const Node& leaf) {
+			hit.handle = leaf.handle;
+			hit.distance = intersectRay(leaf.tightBox, ray.origin, inverseDirection, closest);
+			closest = hit.distance;
+		}, stack);
+
+	return hit;
+}
+
+
+
+//Batched queries ---------------------------------------------------------------
+
+template<typename Query, typename Run>
+void DynamicAABBTree::runBatch(std::span<const Query> queries, Run run) const {
+
+	se_jobSystem.parallelFor((GLuint)queries.size(), AABB_TREE_QUERY_GRAIN, [&](GLuint begin, GLuint end, GLuint) {
+
+		std::vector<GLuint> stack; //Shared by every query of the range
+		for (GLuint i = begin; i < end; i++) {
+			run(queries[i], i, stack);
+		}
+	});
+}
+
+void DynamicAABBTree::queryAABBs(std::span<const Shmingo::AABB> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const {
+
+	results.resize(queries.size());
+
+	runBatch(queries, [&](const Shmingo::AABB& bounds, GLuint index, std::vector<GLuint>& stack) {
+		results[index].clear();
+		traverse([&](const Shmingo::AABB& box) { return box.overlaps(bounds); }, [&](const Node& leaf) { results[index].emplace_back(leaf.handle); }, stack);
+	});
+}
+
+void DynamicAABBTree::querySpheres(std::span<const Shmingo::BoundingSphere> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const {
+
+	results.resize(queries.size());
+
+	runBatch(queries, [&](const Shmingo::BoundingSphere& sphere, GLuint index, std::vector<GLuint>& stack) {
+		results[index].clear();
+		traverse([&](const Shmingo::AABB& box) { return overlapsSphere(box, sphere); }, [&](const Node& leaf) { results[index].emplace_back(leaf.handle); }, stack);
+	});
+}
+
+void DynamicAABBTree::queryFrustums(std::span<const Shmingo::Frustum> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const {
+
+	results.resize(queries.size());
+
+	runBatch(queries, [&](const Shmingo::Frustum& frustum, GLuint index, std::vector<GLuint>& stack) {
+		results[index].clear();
+		traverse([&](const Shmingo::AABB& box) { return overlapsFrustum(box, frustum); }, [&](const Node& leaf) { results[index].emplace_back(leaf.handle); }, stack);
+	});
+}
+
+void DynamicAABBTree::raycasts(std::span<const Shmingo::Ray> rays, std::vector<Shmingo::RayHit>& hits) const {
+
+	hits.resize(rays.size());
+
+	runBatch(rays, [&](const Shmingo::Ray& ray, GLuint index, std::vector<GLuint>& stack) {
+
+		Shmingo::RayHit& hit = hits[index];
+		hit = Shmingo::RayHit();
+
+		float closest = ray.maxDistance;
+		vec3 inverseDirection = 1.0f / ray.direction;
+
+		traverse([&](const Shmingo::AABB& box) { return intersectRay(box, ray.origin, inverseDirection, closest) >= 0.0f; },
+			[&](const Node& leaf) {
+				hit.handle = leaf.handle;
+				hit.distance = intersectRay(leaf.tightBox, ray.origin, inverseDirection, closest);
+				closest = hit.distance;
+			}, stack);
+	});
+}
+
+
+
+//Tree structure ----------------------------------------------------------------
+
+GLuint DynamicAABBTree::allocateNode() {
+
+	if (freeList == AABB_TREE_NULL_NODE) {
+		nodes.emplace_back();
+		return (GLuint)nodes.size() - 1;
+	}
+
+	GLuint node = freeList;
+	freeList = nodes[node].parent;
+
+	nodes[node] = Node();
+	return node;
+}
+
+void DynamicAABBTree::freeNode(GLuint node) {
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+GLuint DynamicAABBTree::createLeaf(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds) {
+
+	if (handle.index >= handleLeaves.size()) {
+		handleLeaves.resize(handle.index + 1, AABB_TREE_NULL_NODE);
+	}
+
+	if (handleLeaves[handle.index] != AABB_TREE_NULL_NODE) { //A stale handle of the same slot is still in the tree
+		removeLeaf(handleLeaves[handle.index]);
+		freeNode(handleLeaves[handle.index]);
+		leafAmount--;
+	}
+
+	GLuint leaf = allocateNode();
+	Node& node = nodes[leaf];
+
+	node.box = Shmingo::AABB(bounds.min - vec3(AABB_TREE_FAT_MARGIN), bounds.max + vec3(AABB_TREE_FAT_MARGIN));
+	node.tightBox = bounds;
+	node.handle = handle;
+	node.height = 0;
+
+	handleLeaves[handle.index] = leaf;
+	leafAmount++;
+
+	return leaf;
+}
+
+void DynamicAABBTree::insertLeaf(GLuint leaf) {
+
+	if (root == AABB_TREE_NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	Shmingo::AABB leafBox = nodes[leaf].box;
+
+	//Descend towards the sibling whose bounds grow the least, stop once pairing with the current node is cheaper than going further down
+	GLuint index = root;
+	while (!nodes[index].isLeaf()) {
+
+		const Node& node = nodes[index];
+
+		float area = node.box.getSurfaceArea();
+		float combinedArea = Shmingo::AABB::merge(node.box, leafBox).getSurfaceArea();
+
+		float cost = 2.0f * combinedArea; //New parent for this node and the leaf
+		float inheritanceCost = 2.0f * (combinedArea - area); //Growth every ancestor pays if the leaf goes below this node
+
+		auto descendCost = [&](GLuint child) {
+			const Node& childNode = nodes[child];
+			float mergedArea = Shmingo::AABB::merge(childNode.box, leafBox).getSurfaceArea();
+			return (childNode.isLeaf() ? mergedArea : mergedArea - childNode.box.getSurfaceArea()) + inheritanceCost;
+		};
+
+		float cost1 = descendCost(node.child1);
+		float cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2) {
+			break;
+		}
+
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+
+	GLuint sibling = index;
+	GLuint oldParent = nodes[sibling].parent;
+	GLuint newParent = allocateNode(); //May reallocate nodes, so no references are held across it
+
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = Shmingo::AABB::merge(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+
+	if (oldParent == AABB_TREE_NULL_NODE) {
+		root = newParent;
+	}
+	else if (nodes[oldParent].child1 == sibling) {
+		nodes[oldParent].child1 = newParent;
+	}
+	else {
+		nodes[oldParent].child2 = newParent;
+	}
+
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	refitUpwards(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(GLuint leaf) {
+
+	if (leaf == root) {
+		root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	GLuint parent = nodes[leaf].parent;
+	GLuint grandParent = nodes[parent].parent;
+	GLuint sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	//The sibling takes the parent's place
+	if (grandParent == AABB_TREE_NULL_NODE) {
+		root = sibling;
+		nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		freeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].child1 == parent) {
+		nodes[grandParent].child1 = sibling;
+	}
+	else {
+		nodes[grandParent].child2 = sibling;
+	}
+
+	nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	refitUpwards(grandParent);
+}
+
+GLuint DynamicAABBTree::buildSubtree(std::span<BuildLeaf> leaves) {
+
+	if (leaves.size() == 1) {
+		return leaves[0].leaf;
+	}
+
+	vec3 centerMin = leaves[0].center;
+	vec3 centerMax = centerMin;
+
+	for (const BuildLeaf& leaf : leaves) {
+		centerMin = glm::min(centerMin, leaf.center);
+		centerMax = glm::max(centerMax, leaf.center);
+	}
+
+	vec3 extent = centerMax - centerMin;
+	int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+	//Halves of equal size keep sibling heights within one of each other, so the tree starts out balanced
+	size_t middle = leaves.size() / 2;
+	std::nth_element(leaves.begin(), leaves.begin() + middle, leaves.end(), [axis](const BuildLeaf& a, const BuildLeaf& b) {
+		return a.center[axis] < b.center[axis];
+	});
+
+	GLuint child1 = buildSubtree(leaves.first(middle));
+	GLuint child2 = buildSubtree(leaves.subspan(middle));
+
+	GLuint node = allocateNode(); //May reallocate nodes, so nothing is referenced across it
+
+	nodes[node].child1 = child1;
+	nodes[node].child2 = child2;
+	nodes[node].box = Shmingo::AABB::merge(nodes[child1].box, nodes[child2].box);
+	nodes[node].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+	nodes[child1].parent = node;
+	nodes[child2].parent = node;
+
+	return node;
+}
+
+void DynamicAABBTree::refitUpwards(GLuint node) {
+
+	while (node != AABB_TREE_NULL_NODE) {
+
+		node = balance(node);
+
+		Node& current = nodes[node];
+		current.height = 1 + std::max(nodes[current.child1].height, nodes[current.child2].height);
+		current.box = Shmingo::AABB::merge(nodes[current.child1].box, nodes[current.child2].box);
+
+		node = current.parent;
+	}
+}
+
+GLuint DynamicAABBTree::balance(GLuint a) {
+
+	if (nodes[a].isLeaf() || nodes[a].height < 2) {
+		return a;
+	}
+
+	GLuint b = nodes[a].child1;
+	GLuint c = nodes[a].child2;
+	int balanceFactor = nodes[c].height - nodes[b].height;
+
+	if (balanceFactor >= -1 && balanceFactor <= 1) {
+		return a;
+	}
+
+	//The taller child f moves up into a's place, a keeps its other child and takes f's shorter child
+	GLuint f = balanceFactor > 1 ? c : b;
+	GLuint f1 = nodes[f].child1;
+	GLuint f2 = nodes[f].child2;
+
+	nodes[f].parent = nodes[a].parent;
+	nodes[a].parent = f;
+
+	if (nodes[f].parent == AABB_TREE_NULL_NODE) {
+		root = f;
+	}
+	else if (nodes[nodes[f].parent].child1 == a) {
+		nodes[nodes[f].parent].child1 = f;
+	}
+	else {
+		nodes[nodes[f].parent].child2 = f;
+	}
+
+	GLuint taller = nodes[f1].height > nodes[f2].height ? f1 : f2;
+	GLuint shorter = taller == f1 ? f2 : f1;
+
+	nodes[f].child1 = a;
+	nodes[f].child2 = taller;
+
+	if (nodes[a].child1 == f) {
+		nodes[a].child1 = shorter;
+	}
+	else {
+		nodes[a].child2 = shorter;
+	}
+	nodes[shorter].parent = a;
+
+	Node& nodeA = nodes[a];
+	nodeA.box = Shmingo::AABB::merge(nodes[nodeA.child1].box, nodes[nodeA.child2].box);
+	nodeA.height = 1 + std::max(nodes[nodeA.child1].height, nodes[nodeA.child2].height);
+
+	Node& nodeF = nodes[f];
+	nodeF.box = Shmingo::AABB::merge(nodeA.box, nodes[taller].box);
+	nodeF.height = 1 + std::max(nodeA.height, nodes[taller].height);
+
+	return f;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include "FrustumCulling.h"
+
+const GLuint AABB_TREE_NULL_NODE = 0xFFFFFFFF;
+const float AABB_TREE_FAT_MARGIN = 0.5f; //Leaves are enlarged by this much on every side, so entities moving inside it never touch the tree
+const GLuint AABB_TREE_QUERY_GRAIN = 16; //Queries per job in batched queries
+
+namespace Shmingo {
+
+	//Axis aligned bounding box in world space
+	struct AABB {
+
+		vec3 min;
+		vec3 max;
+
+		inline float getSurfaceArea() const {
+			vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		inline bool contains(const AABB& other) const {
+			return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+		}
+
+		inline bool overlaps(const AABB& other) const {
+			return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+		}
+
+		inline static AABB merge(const AABB& a, const AABB& b) {
+			return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+		}
+	};
+
+	struct BoundingSphere {
+
+		vec3 center;
+		float radius;
+	};
+
+	//Direction must be normalized, hits further than maxDistance are ignored
+	struct Ray {
+
+		vec3 origin;
+		vec3 direction;
+		float maxDistance;
+	};
+
+	//Closest entity along a ray, handle is null (generation 0) when nothing was hit
+	struct RayHit {
+
+		EntityHandle handle;
+		float distance = 0.0f;
+	};
+}
+
+/*
+Bounding volume hierarchy over entity bounds, keyed by entity handle.
+Leaves hold a fattened copy of each entity's box, so an update that stays inside it only rewrites the leaf, anything else removes and reinserts the leaf.
+Insertion picks the sibling that grows the tree's surface area the least and rotations keep it height balanced, so queries stay logarithmic
+however entities are added. Batches at least as large as the tree are built top down by median splits instead.
+Queries test nodes against the fat boxes and leaves against the exact box the entity was last updated with.
+Not thread safe for writes, batched queries may run while nothing modifies the tree.
+*/
+class DynamicAABBTree {
+
+public:
+
+	//Changes ------------------------------------------------------------------
+	void insert(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds);
+
+	/// <summary>
+	/// Inserts many entities at once. A batch at least as large as the tree rebuilds the whole tree top down, which costs far less than
+	/// that many single inserts and gives a tighter tree. Smaller batches are inserted one by one, a rebuild would mostly redo the existing tree
+	/// </summary>
+	/// <param name="bounds">One box per handle, in the same order</param>
+	void insertBatch(std::span<const Shmingo::EntityHandle> handles, std::span<const Shmingo::AABB> bounds);
+
+	//Does nothing if the handle is not in the tree
+	void remove(Shmingo::EntityHandle handle);
+
+	/// <summary>
+	/// Moves an entity's leaf to new bounds
+	/// </summary>
+	/// <returns>True if the bounds left the fat box and the leaf had to be reinserted</returns>
+	bool update(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds);
+
+	inline bool contains(Shmingo::EntityHandle handle) const {
+		return handle.index < handleLeaves.size() && handleLeaves[handle.index] != AABB_TREE_NULL_NODE && nodes[handleLeaves[handle.index]].handle == handle;
+	}
+
+	void clear();
+
+
+	//Queries, every handle found is appended to results ----------------------
+	void queryAABB(const Shmingo::AABB& bounds, std::vector<Shmingo::EntityHandle>& results) const;
+	void querySphere(const Shmingo::BoundingSphere& sphere, std::vector<Shmingo::EntityHandle>& results) const;
+	void queryFrustum(const Shmingo::Frustum& frustum, std::vector<Shmingo::EntityHandle>& results) const;
+
+	//Closest entity box hit by the ray
+	Shmingo::RayHit raycast(const Shmingo::Ray& ray) const;
+
+
+	//Batched queries, run over the job system. Results has one entry per query, in the same order ------------
+	void queryAABBs(std::span<const Shmingo::AABB> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const;
+	void querySpheres(std::span<const Shmingo::BoundingSphere> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const;
+	void queryFrustums(std::span<const Shmingo::Frustum> queries, std::vector<std::vector<Shmingo::EntityHandle>>& results) const;
+	void raycasts(std::span<const Shmingo::Ray> rays, std::vector<Shmingo::RayHit>& hits) const;
+
+
+	//Getters ------------------------------------------------------------------
+	inline GLuint getLeafAmount() const { return leafAmount; };
+	inline GLuint getHeight() const { return root == AABB_TREE_NULL_NODE ? 0 : (GLuint)nodes[root].height; };
+
+private:
+
+	struct Node {
+
+		Shmingo::AABB box; //Fattened for leaves
+		Shmingo::AABB tightBox; //Leaves only, the bounds the entity was last given
+
+		GLuint parent = AABB_TREE_NULL_NODE; //Next free node while the node is on the free list
+		GLuint child1 = AABB_TREE_NULL_NODE;
+		GLuint child2 = AABB_TREE_NULL_NODE;
+
+		int height = 0; //0 for leaves, -1 while free
+
+		Shmingo::EntityHandle handle;
+
+		inline bool isLeaf() const { return child1 == AABB_TREE_NULL_NODE; };
+	};
+
+	std::vector<Node> nodes;
+	GLuint root = AABB_TREE_NULL_NODE;
+	GLuint freeList = AABB_TREE_NULL_NODE;
+	GLuint leafAmount = 0;
+
+	std::vector<GLuint> handleLeaves; //Leaf of each handle index, AABB_TREE_NULL_NODE if it has none
+
+	GLuint allocateNode();
+	void freeNode(GLuint node);
+
+	//Allocates a leaf for handle, dropping a stale handle of the same slot first. The leaf is not linked into the tree yet
+	GLuint createLeaf(Shmingo::EntityHandle handle, const Shmingo::AABB& bounds);
+
+	void insertLeaf(GLuint leaf);
+	void removeLeaf(GLuint leaf);
+
+	struct BuildLeaf {
+
+		vec3 center; //Of the fat box, doubled
+		GLuint leaf;
+	};
+
+	//Builds a balanced subtree over leaves by splitting them at the median along the longest axis of their centers, returns its root
+	GLuint buildSubtree(std::span<BuildLeaf> leaves);
+
+	//Walks from a node up to the root, rebalancing and recomputing bounds and heights
+	void refitUpwards(GLuint node);
+
+	//Rotates a node's taller child above it if the children's heights differ by more than one, returns the node now in its place
+	GLuint balance(GLuint node);
+
+	/// <summary>
+	/// Depth first walk of every node whose box passes test, calling visit on each leaf whose tight box passes test too
+	/// </summary>
+	/// <param name="stack">Scratch space, reused between calls</param>
+	template<typename Test, typename Visit>
+	void traverse(Test test, Visit visit, std::vector<GLuint>& stack) const;
+
+	//Runs a query per item over the job system, run receives (query, index, stack)
+	template<typename Query, typename Run>
+	void runBatch(std::span<const Query> queries, Run run) const;
+};
@@ -0,0 +1,285 @@
+#include <sepch.h>
+#include "EntityArchetype.h"
+
+#include "MasterRenderer.h"
+#include "JobSystem.h"
+
+std::unique_ptr<EntityArchetype> Shmingo::createEntityArchetype(Shmingo::EntityType type) {
+
+	switch (type) {
+
+	case Shmingo::DefaultEntity:
+		return std::make_unique<TypedEntityArchetype<::DefaultEntity>>(type);
+
+	default:
+		se_error("No archetype declared for entity type " << type);
+		return nullptr;
+	}
+}
+
+
+EntityArchetype::EntityArchetype(Shmingo::EntityType type) : entityType(type),
+	instanceLayout(se_masterRenderer.getEntityInstanceLayout(type)) {
+
+	bool interleaved = se_masterRenderer.getEntityInstanceStorage(type) == Shmingo::INTERLEAVED_INSTANCE_BUFFER;
+
+	for (const Shmingo::EntitySpecificInstanceDataInfo& info : instanceLayout.attributes) {
+		if (interleaved) {
+			//One record per row, attributes sit at their offset inside the record
+			attributeColumnOffsets.emplace_back(info.localOffset);
+			attributeRowStrides.emplace_back(instanceLayout.stride);
+		}
+		else {
+			//One column per attribute, each column holds ENTITY_CHUNK_CAPACITY rows of that attribute
+			attributeColumnOffsets.emplace_back(info.localOffset * ENTITY_CHUNK_CAPACITY);
+			attributeRowStrides.emplace_back(info.size);
+		}
+	}
+
+	vertexArray = std::make_shared<EntityVertexArray>(type, se_masterRenderer.getEntityModel(type));
+
+	//Buffer i starts at attribute i for separate buffers, interleaved records start at attribute 0. Both are contiguous up to the end of the row's chunk
+	vertexArray->setInstanceMirror([this](GLuint row, GLuint bufferIndex, GLuint& contiguousInstances) -> const void* {
+		contiguousInstances = ENTITY_CHUNK_CAPACITY - (row & (ENTITY_CHUNK_CAPACITY - 1));
+		return getInstanceData(row, bufferIndex);
+	});
+}
+
+GLuint EntityArchetype::addEntity(GLuint slot, vec3 position, vec2 rotation, vec3 scale) {
+
+	GLuint row = constructRow(slot, position, rotation, scale);
+
+	growInstanceCapacity();
+	vertexArray->setInstanceAmount(entityCount);
+
+	vertexArray->markInstancesDirty(row, row + 1);
+
+	return row;
+}
+
+GLuint EntityArchetype::addEntities(const GLuint* slots, std::span<const Shmingo::EntitySpawnParams> spawnParams) {
+
+	GLuint firstRow = entityCount;
+
+	reserveRows(entityCount + (GLuint)spawnParams.size());
+
+	for (GLuint i = 0; i < spawnParams.size(); i++) {
+		const Shmingo::EntitySpawnParams& params = spawnParams[i];
+		constructRow(slots[i], params.position, params.rotation, params.scale);
+	}
+
+	growInstanceCapacity();
+	vertexArray->setInstanceAmount(entityCount);
+	vertexArray->markInstancesDirty(firstRow, entityCount);
+
+	return firstRow;
+}
+
+GLuint EntityArchetype::removeEntity(GLuint row) {
+
+	GLuint movedSlot = removeRow(row);
+
+	if (movedSlot != ENTITY_SLOT_NONE) {
+		vertexArray->markInstancesDirty(row, row + 1); //The last row now lives here
+	}
+	vertexArray->setInstanceAmount(entityCount);
+
+	return movedSlot;
+}
+
+void EntityArchetype::reserveRows(GLuint rowCount) {
+
+	while (chunks.size() * ENTITY_CHUNK_CAPACITY < rowCount) {
+		allocateChunk();
+	}
+}
+
+void EntityArchetype::reserveEntities(GLuint amount) {
+	reserveRows(amount);
+	vertexArray->setCapacityHint(amount);
+}
+
+void EntityArchetype::shrinkIfIdle() {
+
+	GLuint previousCapacity = vertexArray->getInstanceCapacity();
+	vertexArray->shrinkIfIdle();
+
+	if (vertexArray->getInstanceCapacity() == previousCapacity) {
+		return;
+	}
+
+	//Capacity stays above the entity count, so every chunk past it is empty
+	GLuint chunkAmount = (vertexArray->getInstanceCapacity() + ENTITY_CHUNK_CAPACITY - 1) >> ENTITY_CHUNK_SHIFT;
+	while (chunks.size() > chunkAmount) {
+		chunks.pop_back();
+		releaseEntityColumn();
+	}
+}
+
+void EntityArchetype::cullEntities(const Shmingo::Frustum& frustum, vec3 cameraPosition) {
+
+	std::vector<GLuint>& visibleRows = vertexArray->getVisibleInstances();
+	GLuint* lodInstanceAmounts = vertexArray->getLodInstanceAmounts();
+	GLuint lodAmount = vertexArray->getLodAmount();
+
+	float radius = vertexArray->getCullingRadius();
+	GLuint chunkAmount = (entityCount + ENTITY_CHUNK_CAPACITY - 1) >> ENTITY_CHUNK_SHIFT;
+
+	cullRows.resize(entityCount);
+	chunkLodAmounts.assign((size_t)chunkAmount * ENTITY_LOD_MAX, 0);
+
+	float lodDistances2[ENTITY_LOD_MAX] = {}; //Squared, at scale 1
+	for (GLuint level = 1; level < lodAmount; level++) {
+		lodDistances2[level] = vertexArray->getLodDistance(level) * vertexArray->getLodDistance(level);
+	}
+
+	//Ranges line up with chunks, so each job reads one contiguous transform column and writes its rows where the chunk starts, no thread touches another's output
+	se_jobSystem.parallelFor(entityCount, ENTITY_CHUNK_CAPACITY, [&](GLuint begin, GLuint end, GLuint) {
+
+		GLuint* rows = &cullRows[begin];
+		GLuint* levelAmounts = &chunkLodAmounts[(size_t)(begin >> ENTITY_CHUNK_SHIFT) * ENTITY_LOD_MAX];
+
+		GLuint visibleAmount = Shmingo::cullSpheres(frustum, &getTransform(begin), end - begin, radius, begin, rows);
+
+		if (lodAmount == 1) {
+			levelAmounts[0] = visibleAmount;
+			return;
+		}
+
+		//Counting sort of the chunk's visible rows by level, keeping row order inside each level
+		std::array<uint8_t, ENTITY_CHUNK_CAPACITY> levels;
+		std::array<GLuint, ENTITY_CHUNK_CAPACITY> sortedRows;
+
+		for (GLuint i = 0; i < visibleAmount; i++) {
+
+			const Shmingo::TransformComponent& transform = getTransform(rows[i]);
+			vec3 offset = transform.position - cameraPosition;
+			vec3 scale = glm::abs(transform.scale);
+			float maxScale = std::max(std::max(scale.x, scale.y), scale.z);
+
+			//Bigger instances switch later, distances scale with them
+			float distance2 = glm::dot(offset, offset) / (maxScale * maxScale);
+
+			GLuint level = 0;
+			while (level + 1 < lodAmount && distance2 > lodDistances2[level + 1]) {
+				level++;
+			}
+
+			levels[i] = (uint8_t)level;
+			levelAmounts[level]++;
+		}
+
+		GLuint levelOffsets[ENTITY_LOD_MAX];
+		GLuint offset = 0;
+		for (GLuint level = 0; level < ENTITY_LOD_MAX; level++) {
+			levelOffsets[level] = offset;
+			offset += levelAmounts[level];
+		}
+
+		for (GLuint i = 0; i < visibleAmount; i++) {
+			sortedRows[levelOffsets[levels[i]]++] = rows[i];
+		}
+
+		std::copy(sortedRows.begin(), sortedRows.begin() + visibleAmount, rows);
+	});
+
+	//Gather level by level, each level's rows from every chunk back to back
+	GLuint visibleAmount = 0;
+	for (GLuint i = 0; i < chunkAmount * ENTITY_LOD_MAX; i++) {
+		visibleAmount += chunkLodAmounts[i];
+	}
+
+	visibleRows.resize(visibleAmount);
+	GLuint written = 0;
+
+	for (GLuint level = 0; level < ENTITY_LOD_MAX; level++) {
+
+		lodInstanceAmounts[level] = 0;
+
+		for (GLuint chunk = 0; chunk < chunkAmount; chunk++) {
+
+			const GLuint* levelAmounts = &chunkLodAmounts[(size_t)chunk * ENTITY_LOD_MAX];
+
+			GLuint levelStart = chunk << ENTITY_CHUNK_SHIFT;
+			for (GLuint previous = 0; previous < level; previous++) {
+				levelStart += levelAmounts[previous];
+			}
+
+			std::copy(cullRows.begin() + levelStart, cullRows.begin() + levelStart + levelAmounts[level], visibleRows.begin() + written);
+			written += levelAmounts[level];
+			lodInstanceAmounts[level] += levelAmounts[level];
+		}
+	}
+}
+
+void EntityArchetype::clear() {
+	releaseEntityColumns();
+	chunks.clear();
+
+	vertexArray->setInstanceAmount(0);
+	entityCount = 0;
+}
+
+GLuint EntityArchetype::constructRow(GLuint slot, vec3 position, vec2 rotation, vec3 scale) {
+
+	GLuint row = entityCount;
+
+	if ((row >> ENTITY_CHUNK_SHIFT) == chunks.size()) {
+		allocateChunk();
+	}
+
+	chunks[row >> ENTITY_CHUNK_SHIFT].slots[row & (ENTITY_CHUNK_CAPACITY - 1)] = slot;
+	getTransform(row) = Shmingo::TransformComponent(position, rotation, scale);
+	constructEntity(row, position, rotation, scale); //Entity writes its initial instance data into the columns here, the caller marks the row dirty
+
+	entityCount++;
+	return row;
+}
+
+GLuint EntityArchetype::removeRow(GLuint row) {
+
+	if (row >= entityCount) {
+		se_log("Attempted to remove row " << row << " of entity type " << entityType << " but only " << entityCount << " entities exist");
+		return ENTITY_SLOT_NONE;
+	}
+
+	GLuint lastRow = entityCount - 1;
+	GLuint movedSlot = ENTITY_SLOT_NONE;
+
+	if (row != lastRow) {
+		copyRow(lastRow, row);
+		moveEntity(lastRow, row); //Overwrites the removed entity with the last one
+		movedSlot = getSlot(row);
+	}
+	else {
+		destroyEntity(lastRow);
+	}
+
+	entityCount--;
+	return movedSlot;
+}
+
+void EntityArchetype::growInstanceCapacity() {
+	vertexArray->growInstanceCapacity(entityCount);
+}
+
+void EntityArchetype::allocateChunk() {
+
+	EntityChunk chunk;
+	chunk.slots = std::make_unique<GLuint[]>(ENTITY_CHUNK_CAPACITY);
+	chunk.transforms = std::make_unique<Shmingo::TransformComponent[]>(ENTITY_CHUNK_CAPACITY);
+	chunk.instanceData = std::make_unique<uint8_t[]>(instanceLayout.stride * ENTITY_CHUNK_CAPACITY);
+
+	chunks.emplace_back(std::move(chunk));
+	allocateEntityColumn();
+}
+
+void EntityArchetype::copyRow(GLuint sourceRow, GLuint destinationRow) {
+
+	chunks[destinationRow >> ENTITY_CHUNK_SHIFT].slots[destinationRow & (ENTITY_CHUNK_CAPACITY - 1)] = getSlot(sourceRow);
+	getTransform(destinationRow) = getTransform(sourceRow);
+
+	for (GLuint i = 0; i < instanceLayout.attributes.size(); i++) {
+		std::memcpy(getInstanceData(destinationRow, i), getInstanceData(sourceRow, i), instanceLayout.attributes[i].size);
+	}
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include "InstancedEntity.h"
+#include "EntityVertexArray.h"
+#include "EntityCommandBuffer.h"
+#include "FrustumCulling.h"
+
+//Amount of entities stored in one chunk of an archetype. Power of two so row -> chunk lookups are a shift and a mask
+const GLuint ENTITY_CHUNK_CAPACITY = 4096;
+const GLuint ENTITY_CHUNK_SHIFT = 12;
+
+const GLuint ENTITY_SLOT_NONE = 0xFFFFFFFF;
+
+/*
+Fixed size block of contiguous component columns for one entity type.
+Transforms and per instance GPU data live here, user state (the entity objects themselves) lives in the typed archetype.
+Per instance data is laid out like the type's instance buffers: attribute major for separate buffers, so the rows of one attribute are contiguous,
+or as whole records for interleaved storage. Either way a range of rows of one buffer is contiguous and can be uploaded in one write.
+*/
+struct EntityChunk {
+
+	std::unique_ptr<GLuint[]> slots; //Slot map index of the entity in each row, used to patch handles when rows move
+	std::unique_ptr<Shmingo::TransformComponent[]> transforms;
+	std::unique_ptr<uint8_t[]> instanceData;
+};
+
+/*
+Struct of arrays storage for every entity of one type.
+Rows are dense, row N of the archetype is always instance N of its vertex array, so removing an entity swaps the last row into its place.
+Every chunk except the last one is always full. The instance data columns are the CPU mirror of the vertex array, changed rows are only marked dirty and uploaded when the vertex array is flushed.
+*/
+class EntityArchetype {
+
+public:
+
+	EntityArchetype(Shmingo::EntityType type);
+	virtual ~EntityArchetype() = default;
+
+	/// <summary>
+	/// Creates an entity at the back of the archetype and marks its instance data dirty
+	/// </summary>
+	/// <param name="slot">Slot map index of the entity's handle</param>
+	/// <returns>Row of the new entity</returns>
+	GLuint addEntity(GLuint slot, vec3 position, vec2 rotation, vec3 scale);
+
+	/// <summary>
+	/// Creates entities at the back of the archetype, storage is reserved once and the new rows are marked dirty as one range
+	/// </summary>
+	/// <param name="slots">Slot map index of each new entity, one per spawn parameter</param>
+	/// <param name="spawnParams">Transform of each new entity</param>
+	/// <returns>Row of the first new entity, the rest follow contiguously</returns>
+	GLuint addEntities(const GLuint* slots, std::span<const Shmingo::EntitySpawnParams> spawnParams);
+
+	/// <summary>
+	/// Removes the entity at row by moving the last entity into its place
+	/// </summary>
+	/// <param name="row">Row of the entity to remove</param>
+	/// <returns>Slot map index of the entity that was moved into row, or ENTITY_SLOT_NONE if no entity moved</returns>
+	GLuint removeEntity(GLuint row);
+
+	//Allocates chunks until rowCount rows fit
+	void reserveRows(GLuint rowCount);
+
+	/// <summary>
+	/// Capacity hint, allocates rows and instance buffers for amount entities up front and keeps them allocated when shrinking
+	/// </summary>
+	/// <param name="amount">Expected peak amount of entities of this type</param>
+	void reserveEntities(GLuint amount);
+
+	//Called once per frame, shrinks the instance buffers after a long enough idle period and frees the chunks they no longer cover
+	void shrinkIfIdle();
+
+	/// <summary>
+	/// Tests every entity's bounding sphere against a frustum and picks a level of detail for each visible one by its distance, one job per chunk.
+	/// Fills the vertex array's visible instances grouped by level and its per level amounts
+	/// </summary>
+	/// <param name="cameraPosition">Position distances are measured from</param>
+	void cullEntities(const Shmingo::Frustum& frustum, vec3 cameraPosition);
+
+	//Calls update on every entity of this type, in row order
+	virtual void updateEntities() = 0;
+
+	/// <summary>
+	/// Calls update on the entities in rows [begin, end). Safe to run on several threads at once for disjoint ranges
+	/// </summary>
+	virtual void updateRows(GLuint begin, GLuint end) = 0;
+
+	virtual InstancedEntity* getEntity(GLuint row) = 0;
+
+	void clear();
+
+
+	//Column access -----------------------------------------------------------
+	inline GLuint getSlot(GLuint row) {
+		return chunks[row >> ENTITY_CHUNK_SHIFT].slots[row & (ENTITY_CHUNK_CAPACITY - 1)];
+	}
+
+	inline Shmingo::TransformComponent& getTransform(GLuint row) {
+		return chunks[row >> ENTITY_CHUNK_SHIFT].transforms[row & (ENTITY_CHUNK_CAPACITY - 1)];
+	}
+
+	/// <summary>
+	/// Returns a pointer to the per instance data of an attribute for one row
+	/// </summary>
+	/// <param name="row">Row of the entity</param>
+	/// <param name="attributePositionInArray">Index of the attribute in the instance attribute info list</param>
+	inline uint8_t* getInstanceData(GLuint row, GLuint attributePositionInArray) {
+		return &chunks[row >> ENTITY_CHUNK_SHIFT].instanceData[attributeColumnOffsets[attributePositionInArray] +
+			(row & (ENTITY_CHUNK_CAPACITY - 1)) * attributeRowStrides[attributePositionInArray]];
+	}
+
+	//Flags the instance data of an attribute for one row as changed, it is uploaded on the next flush. Safe to call from any thread
+	inline void markInstanceDataDirty(GLuint row, GLuint attributePositionInArray) {
+		vertexArray->markInstanceDirty(row, attributePositionInArray);
+	}
+
+	//Flags the bounds of the entity at row as changed, the world refits it in its spatial index at the next sync point. Safe to call from any thread
+	inline void markMoved(GLuint row) {
+		if (movedSlots != nullptr) {
+			movedSlots->set(getSlot(row));
+		}
+	}
+
+	//Bitset of slot map indices that markMoved sets, owned by the world
+	inline void setMovedSlots(Shmingo::AtomicBitset* bitset) { movedSlots = bitset; };
+
+
+	//Getters ------------------------------------------------------------------
+	inline GLuint getEntityCount() { return entityCount; };
+	inline Shmingo::EntityType getEntityType() { return entityType; };
+	inline std::shared_ptr<EntityVertexArray> getVertexArray() { return vertexArray; };
+
+protected:
+
+	Shmingo::EntityType entityType;
+
+	GLuint entityCount = 0;
+
+	std::vector<EntityChunk> chunks;
+	std::vector<GLuint> attributeColumnOffsets; //Offset in bytes of each attribute's first row inside a chunk's instance data block
+	std::vector<GLuint> attributeRowStrides; //Bytes between two rows of each attribute
+
+	std::vector<GLuint> cullRows; //Visible rows of each chunk at the chunk's first row, grouped by level
+	std::vector<GLuint> chunkLodAmounts; //Visible rows found at each level in each chunk by the last cull, ENTITY_LOD_MAX per chunk
+
+	Shmingo::AtomicBitset* movedSlots = nullptr;
+
+	Shmingo::InstanceLayoutInfo instanceLayout;
+	std::shared_ptr<EntityVertexArray> vertexArray;
+
+	void allocateChunk();
+	void growInstanceCapacity();
+
+	GLuint constructRow(GLuint slot, vec3 position, vec2 rotation, vec3 scale); //Fills the next row on the CPU side only
+	GLuint removeRow(GLuint row); //Swap-removes a row on the CPU side only
+
+	//Copies every column except user state from one row to another
+	void copyRow(GLuint sourceRow, GLuint destinationRow);
+
+	//User state column, implemented by the typed archetype
+	virtual void constructEntity(GLuint row, vec3 position, vec2 rotation, vec3 scale) = 0;
+	virtual void moveEntity(GLuint sourceRow, GLuint destinationRow) = 0; //Moves the entity object at sourceRow over the one at destinationRow and destroys the source
+	virtual void destroyEntity(GLuint row) = 0;
+	virtual void allocateEntityColumn() = 0;
+	virtual void releaseEntityColumn() = 0; //Frees the column of the last chunk, which has to be empty
+	virtual void releaseEntityColumns() = 0;
+};
+
+/*
+Archetype for a concrete entity class. Entity objects are stored by value in one vector per chunk so updating them walks memory linearly.
+Vectors are reserved to the chunk capacity up front and never reallocate, so pointers to entities stay valid until they are moved by a removal.
+*/
+template<typename E>
+class TypedEntityArchetype : public EntityArchetype {
+
+public:
+
+	TypedEntityArchetype(Shmingo::EntityType type) : EntityArchetype(type) {}
+
+	~TypedEntityArchetype() override {
+		releaseEntityColumns();
+	}
+
+	void updateEntities() override {
+		updateRows(0, entityCount);
+	}
+
+	void updateRows(GLuint begin, GLuint end) override {
+		for (GLuint row = begin; row < end; row++) {
+			EntityCommandBuffer::setCurrentEntity(entityType, row); //Orders anything the entity defers during its update
+			entityColumns[row >> ENTITY_CHUNK_SHIFT][row & (ENTITY_CHUNK_CAPACITY - 1)].E::update(); //Qualified call, type is known so there is no virtual dispatch
+		}
+		EntityCommandBuffer::clearCurrentEntity();
+	}
+
+	InstancedEntity* getEntity(GLuint row) override {
+		return &entityColumns[row >> ENTITY_CHUNK_SHIFT][row & (ENTITY_CHUNK_CAPACITY - 1)];
+	}
+
+protected:
+
+	std::vector<std::vector<E>> entityColumns;
+
+	void constructEntity(GLuint row, vec3 position, vec2 rotation, vec3 scale) override {
+		std::vector<E>& column = entityColumns[row >> ENTITY_CHUNK_SHIFT];
+		column.emplace_back(position, rotation, scale);
+		column.back().attachToArchetype(this, row);
+		column.back().initializeInstanceData(); //Needs the row's transform, which constructRow has already written
+	}
+
+	void moveEntity(GLuint sourceRow, GLuint destinationRow) override {
+		std::vector<E>& sourceColumn = entityColumns[sourceRow >> ENTITY_CHUNK_SHIFT];
+
+		E& destination = entityColumns[destinationRow >> ENTITY_CHUNK_SHIFT][destinationRow & (ENTITY_CHUNK_CAPACITY - 1)];
+		destination = std::move(sourceColumn.back()); //Source is always the last row
+		destination.attachToArchetype(this, destinationRow);
+
+		sourceColumn.pop_back();
+	}
+
+	void destroyEntity(GLuint row) override {
+		entityColumns[row >> ENTITY_CHUNK_SHIFT].pop_back(); //Only ever called on the last row
+	}
+
+	void allocateEntityColumn() override {
+		entityColumns.emplace_back();
+		entityColumns.back().reserve(ENTITY_CHUNK_CAPACITY);
+	}
+
+	void releaseEntityColumn() override {
+		entityColumns.pop_back();
+	}
+
+	void releaseEntityColumns() override {
+		entityColumns.clear();
+	}
+};
+
+namespace Shmingo {
+	//Creates the archetype for an entity type, add a case here when declaring a new entity type
+	std::unique_ptr<EntityArchetype> createEntityArchetype(Shmingo::EntityType type);
+}
@@ -0,0 +1,45 @@
+#include <sepch.h>
+#include "EntityCommandBuffer.h"
+
+#include "JobSystem.h"
+
+void EntityCommandBuffer::init(GLuint threadAmount) {
+	threadCommands.resize(std::max(threadAmount, 1u));
+}
+
+void EntityCommandBuffer::recordSpawn(Shmingo::EntityType type, const Shmingo::EntitySpawnParams& spawnParams) {
+	getThreadCommands().emplace_back(Shmingo::EntityCommand(currentKey, Shmingo::SPAWN_ENTITY, type, Shmingo::EntityHandle(), spawnParams));
+}
+
+void EntityCommandBuffer::recordDelete(Shmingo::EntityHandle handle) {
+	getThreadCommands().emplace_back(Shmingo::EntityCommand(currentKey, Shmingo::DELETE_ENTITY, Shmingo::DefaultEntity, handle, Shmingo::EntitySpawnParams()));
+}
+
+void EntityCommandBuffer::collectCommands(std::vector<Shmingo::EntityCommand>& out) {
+
+	out.clear();
+
+	for (std::vector<Shmingo::EntityCommand>& commands : threadCommands) {
+		out.insert(out.end(), commands.begin(), commands.end());
+		commands.clear();
+	}
+
+	//Every entity is updated by exactly one thread, so stable sorting by entity restores a schedule independent order
+	std::stable_sort(out.begin(), out.end(), [](const Shmingo::EntityCommand& a, const Shmingo::EntityCommand& b) {
+		return a.key < b.key;
+	});
+}
+
+bool EntityCommandBuffer::isEmpty() {
+
+	for (std::vector<Shmingo::EntityCommand>& commands : threadCommands) {
+		if (!commands.empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::vector<Shmingo::EntityCommand>& EntityCommandBuffer::getThreadCommands() {
+	return threadCommands[JobSystem::getThreadIndex()];
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+namespace Shmingo {
+
+	enum EntityCommandType {
+		DELETE_ENTITY,
+		SPAWN_ENTITY
+	};
+
+	/*
+	Structural change requested while entities are being updated in parallel.
+	Key is the type and row of the entity whose update emitted the command, so commands can be put back in a fixed order no matter which thread ran which range
+	*/
+	struct EntityCommand {
+
+		uint64_t key;
+		EntityCommandType commandType;
+		EntityType entityType; //Type to spawn
+		EntityHandle handle; //Entity to delete
+		EntitySpawnParams spawnParams;
+	};
+}
+
+/*
+Per thread buffers of deferred entity commands.
+Recording never locks, every thread only touches its own buffer. collectCommands merges them in (type, row, emission) order so applying them is deterministic
+*/
+class EntityCommandBuffer {
+
+public:
+
+	void init(GLuint threadAmount);
+
+	//Sets the entity whose update is currently running on this thread, commands recorded after this are ordered by it
+	inline static void setCurrentEntity(Shmingo::EntityType type, GLuint row) {
+		currentKey = ((uint64_t)type << 32) | row;
+	}
+
+	//Commands recorded outside of an entity update sort after every entity's commands
+	inline static void clearCurrentEntity() {
+		currentKey = UINT64_MAX;
+	}
+
+	void recordSpawn(Shmingo::EntityType type, const Shmingo::EntitySpawnParams& spawnParams);
+	void recordDelete(Shmingo::EntityHandle handle);
+
+	/// <summary>
+	/// Moves every recorded command into out, sorted by the entity that recorded it. Keeps recording order for commands of the same entity
+	/// </summary>
+	void collectCommands(std::vector<Shmingo::EntityCommand>& out);
+
+	bool isEmpty();
+
+private:
+
+	std::vector<std::vector<Shmingo::EntityCommand>> threadCommands; //Indexed by job system thread index
+
+	inline static thread_local uint64_t currentKey = UINT64_MAX;
+
+	std::vector<Shmingo::EntityCommand>& getThreadCommands();
+};
@@ -0,0 +1,85 @@
+#include <sepch.h>
+#include "SimulationThread.h"
+
+SimulationThread::~SimulationThread() {
+	stop();
+}
+
+void SimulationThread::start(FrameFunction function) {
+
+	if (isRunning()) {
+		return;
+	}
+
+	frameFunction = function;
+	ownerThread = std::this_thread::get_id();
+	thread = std::thread([this]() { threadLoop(); });
+}
+
+void SimulationThread::stop() {
+
+	if (!isRunning()) {
+		return;
+	}
+
+	takePacket();
+
+	requests.push(FrameRequest(Shmingo::SimulationInput(), nullptr));
+	thread.join();
+
+	//Packets hold the vertex arrays they draw, release them here on the main thread
+	for (Shmingo::FramePacket& packet : packets) {
+		packet.clear();
+	}
+}
+
+void SimulationThread::kick(const Shmingo::SimulationInput& input) {
+
+	Shmingo::FramePacket& packet = packets[nextPacket];
+	nextPacket = (nextPacket + 1) % SIMULATION_PACKET_AMOUNT;
+
+	//Cleared here and not on the simulation thread, so the last reference to a vertex array is never dropped away from the GL context
+	packet.clear();
+
+	requests.push(FrameRequest(input, &packet)); //Never full, at most one frame is in flight
+	frameInFlight = true;
+}
+
+Shmingo::FramePacket* SimulationThread::takePacket() {
+
+	if (!frameInFlight) {
+		return nullptr;
+	}
+
+	Shmingo::FramePacket* packet = nullptr;
+	recordedPackets.waitUntilNotEmpty();
+	recordedPackets.pop(packet);
+
+	frameInFlight = false;
+	return packet;
+}
+
+void SimulationThread::waitIdle() {
+
+	if (frameInFlight) {
+		recordedPackets.waitUntilNotEmpty();
+	}
+}
+
+void SimulationThread::threadLoop() {
+
+	FrameRequest request;
+
+	while (true) {
+
+		requests.waitUntilNotEmpty();
+		requests.pop(request);
+
+		if (request.packet == nullptr) {
+			return;
+		}
+
+		frameFunction(request.input, *request.packet);
+		recordedPackets.push(request.packet);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <sepch.h>
+#include <ShmingoCore.h>
+
+#include "FramePacket.h"
+
+const GLuint SIMULATION_PACKET_AMOUNT = 2; //One packet is replayed while the simulation records the other, so it never runs more than a frame ahead
+
+namespace Shmingo {
+
+	//What the main thread hands the simulation for one frame
+	struct SimulationInput {
+
+		mat4 viewMatrix;
+		mat4 projectionMatrix;
+		bool entityCulling;
+	};
+}
+
+/*
+Thread running the world's simulation one frame at a time. The main thread owns the GL context: it kicks a frame with kick, keeps drawing the packet
+it took from the frame before, and takes the new packet at the start of the next frame. Both directions go through bounded lock-free queues,
+and only two packets exist, so the simulation is at most one frame ahead of what is drawn.
+While a frame is in flight the main thread must not touch the world, waitIdle blocks until the simulation is done with it.
+The simulation thread submits jobs to the job system as thread index 0, the main thread must not run a parallelFor of its own at the same time.
+*/
+class SimulationThread {
+
+public:
+
+	//Runs on the simulation thread, simulates a frame and records it into packet
+	typedef std::function<void(const Shmingo::SimulationInput& input, Shmingo::FramePacket& packet)> FrameFunction;
+
+	~SimulationThread();
+
+	void start(FrameFunction function);
+
+	//Waits for the frame in flight, drops every packet and joins the thread
+	void stop();
+
+	/// <summary>
+	/// Starts simulating a frame into the packet that is not being drawn. The packet of the previous frame must have been taken already
+	/// </summary>
+	void kick(const Shmingo::SimulationInput& input);
+
+	/// <summary>
+	/// Blocks until the frame in flight is recorded
+	/// </summary>
+	/// <returns>Its packet, valid until the frame after next is kicked, or nullptr if no frame was in flight</returns>
+	Shmingo::FramePacket* takePacket();
+
+	//Blocks until the frame in flight is recorded without taking its packet, the world can be changed safely afterwards
+	void waitIdle();
+
+	inline bool isRunning() { return thread.joinable(); };
+
+	//Whether the caller is the thread that started the simulation and hands it frames
+	inline bool isOwnerThread() { return std::this_thread::get_id() == ownerThread; };
+
+private:
+
+	struct FrameRequest {
+
+		Shmingo::SimulationInput input;
+		Shmingo::FramePacket* packet; //nullptr asks the thread to exit
+	};
+
+	std::thread thread;
+	std::thread::id ownerThread;
+	FrameFunction frameFunction;
+
+	std::array<Shmingo::FramePacket, SIMULATION_PACKET_AMOUNT> packets;
+	GLuint nextPacket = 0;
+	bool frameInFlight = false; //Main thread only, a frame was kicked and its packet not taken yet
+
+	Shmingo::SpscQueue<FrameRequest, 2> requests; //Main thread to simulation
+	Shmingo::SpscQueue<Shmingo::FramePacket*, 2> recordedPackets; //Simulation to main thread
+
+	void threadLoop();
+};
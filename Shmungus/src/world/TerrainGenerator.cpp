@@ -0,0 +1,29 @@
+#include <sepch.h>
+#include "TerrainGenerator.h"
+#include "MathTools.h"
+
+GLuint Shmingo::getTerrainHeight(int x, int z, uint32_t seed) {
+
+	float noise = fractalNoise2D(vec2((float)x, (float)z) * TERRAIN_NOISE_SCALE, 4, seed);
+	return TERRAIN_BASE_HEIGHT + (GLuint)(noise * (float)TERRAIN_HEIGHT_RANGE);
+}
+
+void Shmingo::generateTerrain(Chunk& chunk, uint32_t seed) {
+
+	const GLuint dirtDepth = 3;
+
+	chunk.clear();
+
+	ivec2 origin = chunk.getPosition() * (int)CHUNK_WIDTH;
+
+	for (GLuint x = 0; x < CHUNK_WIDTH; x++) {
+		for (GLuint z = 0; z < CHUNK_WIDTH; z++) {
+
+			GLuint height = getTerrainHeight(origin.x + (int)x, origin.y + (int)z, seed);
+
+			chunk.fillColumn(x, z, 0, height - dirtDepth - 1, STONE_BLOCK);
+			chunk.fillColumn(x, z, height - dirtDepth - 1, dirtDepth, DIRT_BLOCK);
+			chunk.fillColumn(x, z, height - 1, 1, GRASS_BLOCK);
+		}
+	}
+}
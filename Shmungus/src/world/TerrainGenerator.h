@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ShmingoCore.h>
+#include <sepch.h>
+
+#include "Chunk.h"
+
+namespace Shmingo {
+
+	//Placeholder materials until blocks get a registry of their own
+	const BlockID STONE_BLOCK = 1;
+	const BlockID DIRT_BLOCK = 2;
+	const BlockID GRASS_BLOCK = 3;
+
+	const GLuint TERRAIN_BASE_HEIGHT = 48; //Lowest the surface goes
+	const GLuint TERRAIN_HEIGHT_RANGE = 64; //Surface height varies this much above the base
+	const float TERRAIN_NOISE_SCALE = 1.0f / 64.0f; //Noise cells per block, larger values make rougher hills
+
+	/// <summary>
+	/// Blocks in the column at a world block position, the surface block is at the returned height - 1
+	/// </summary>
+	GLuint getTerrainHeight(int x, int z, uint32_t seed);
+
+	/// <summary>
+	/// Fills a chunk with rolling hills from fractal noise: stone, a few blocks of dirt, then grass on top.
+	/// Depends only on the chunk's position and the seed, so neighboring chunks line up
+	/// </summary>
+	void generateTerrain(Chunk& chunk, uint32_t seed);
+}
@@ -16,147 +16,449 @@ void World::init(){
 
 	Shmingo::setCurrentWorld(this);
 
-	//Initialize the entity type info map with all entity types
-	for (Shmingo::EntityType type : se_application.entityTypes) {
-		initializedInstancedVaoMap.insert(std::make_pair(type, false));
-	}
+	commandBuffer.init(se_jobSystem.getThreadAmount());
+	chunkBuilder.init();
+	chunkStreamer.init(chunkBuilder);
 }
 
 void World::update(){
 
+	//The view matrix is set by the player before the world updates. Threaded, the frame culled with it is drawn under the next frame's matrices
+	Shmingo::SimulationInput input(se_uniformBuffer.getViewMatrix(), se_uniformBuffer.getProjectionMatrix(), se_masterRenderer.isEntityCullingEnabled());
+
+	updateTerrain();
+
+	if (!threadedSimulation) {
+
+		if (simulation.isRunning()) {
+			simulation.stop();
+			resendEntityInstances(); //The frame in flight was dropped along with the instance uploads its packet carried
+		}
+
+		simulateImmediateFrame(input);
+		return;
+	}
+
+	if (!simulation.isRunning()) {
+		simulation.start([this](const Shmingo::SimulationInput& frameInput, Shmingo::FramePacket& packet) {
+			simulateFrame(frameInput, packet);
+		});
+	}
+
+	//Last frame's packet is drawn this frame while the simulation thread runs this frame into the other one
+	Shmingo::FramePacket* packet = simulation.takePacket();
+
+	//Nothing is in flight on the first threaded frame or right after threading is turned back on. Last frame's packet recorded here stands in for it,
+	//and without one this frame is recorded here as well and the thread takes over next frame, so no frame is drawn without entities or simulated twice
+	if (packet == nullptr) {
+
+		if (!immediatePacketCurrent) {
+			simulateImmediateFrame(input);
+			return;
+		}
+
+		packet = &immediatePacket;
+	}
+
+	immediatePacketCurrent = false;
+	simulation.kick(input);
+	replayPacket(*packet);
+}
+
+void World::simulateImmediateFrame(const Shmingo::SimulationInput& input) {
+
+	immediatePacket.clear();
+	simulateFrame(input, immediatePacket);
+	replayPacket(immediatePacket);
+	immediatePacketCurrent = true;
+}
+
+void World::resendEntityInstances() {
+	for (auto& [type, archetype] : archetypeMap) {
+		archetype->getVertexArray()->resendInstances();
+	}
+}
+
+void World::waitForSimulation() {
+
+	//The simulation itself and the workers running its jobs are the frame in flight, waiting there would never return
+	if (simulation.isRunning() && simulation.isOwnerThread()) {
+		simulation.waitIdle();
+	}
+}
+
+void World::simulateFrame(const Shmingo::SimulationInput& input, Shmingo::FramePacket& packet) {
+
 	updateEntities();
-	submitVertexArrays();
+	refitSpatialIndex();
+	recordVertexArrays(input, packet);
+
+	for (auto& [type, archetype] : archetypeMap) {
+		archetype->shrinkIfIdle(); //Only changes the CPU capacity, the next packet carries it to the GPU
+	}
+
+	packet.entityCount = entityCount;
 }
 
-void World::updateEntities() {
-	for (InstancedEntity* entity : entityList) {
-		entity->update();
+void World::updateTerrain() {
+
+	chunkStreamer.update(terrainCenter); //Also points the builder at the center
+	chunkBuilder.uploadFinished();
+	chunkStreamer.submitDraws();
+
+	if (Shmingo::isTimeMultipleOf(0.2)) {
+
+		Shmingo::ChunkBuildStats stats = chunkBuilder.getStats();
+
+		se_application.setApplicationInfo(Shmingo::CHUNK_BUILD_QUEUE, std::to_string(stats.queuedAmount) + "/" + std::to_string(stats.buildingAmount));
+		se_application.setApplicationInfo(Shmingo::CHUNK_BUILD_LATENCY, std::to_string(stats.averageLatencyMs).substr(0, 4) + "/" + std::to_string(stats.maxLatencyMs).substr(0, 4));
+
+		Shmingo::ChunkStreamStats streamStats = chunkStreamer.getStats();
+
+		se_application.setApplicationInfo(Shmingo::CHUNK_STREAM_COUNT, std::to_string(streamStats.loadedAmount) + "/" + std::to_string(streamStats.meshedAmount) + "/" + std::to_string(streamStats.pendingAmount));
 	}
 }
 
+void World::replayPacket(const Shmingo::FramePacket& packet) {
 
+	for (const Shmingo::EntityDrawPacket& draw : packet.entityDraws) {
+		draw.vertexArray->beginFrameDraw(packet, draw);
+		se_masterRenderer.submitEntityVertexArray(draw.vertexArray);
+	}
 
-//Other functions
+	if (packet.entityCount != publishedEntityCount) {
+		publishedEntityCount = packet.entityCount;
+		se_application.setApplicationInfo(Shmingo::ENTITY_COUNT, std::to_string(publishedEntityCount));
+	}
+
+	if (packet.entityCulling && Shmingo::isTimeMultipleOf(0.2)) {
+		se_application.setApplicationInfo(Shmingo::VISIBLE_ENTITY_COUNT, std::to_string(packet.visibleEntityCount));
+	}
+}
+
+void World::updateEntities() {
 
-void World::submitVertexArrays(){
- 	for (auto it = instancedVAOMap.begin(); it != instancedVAOMap.end(); it++) {
-		se_masterRenderer.submitEntityVertexArray(it->second);
+	for (auto& [type, archetype] : archetypeMap) {
+
+		if (!parallelUpdate) {
+			archetype->updateEntities();
+			continue;
+		}
+
+		//Rows of one type are contiguous, so each job walks a dense slice of the archetype's columns
+		EntityArchetype* currentArchetype = archetype.get();
+		se_jobSystem.parallelFor(currentArchetype->getEntityCount(), ENTITY_UPDATE_GRAIN, [currentArchetype](GLuint begin, GLuint end, GLuint) {
+			currentArchetype->updateRows(begin, end);
+		});
 	}
+
+	applyDeferredCommands();
 }
 
-void World::deleteEntity(Shmingo::EntityType type, GLuint localOffset){
-	Shmingo::EntityTypeInfo typeInfo = entityTypeInfoMap.map[type];
+void World::applyDeferredCommands() {
 
-	if (typeInfo.amount == 0) {
-		se_log("Attempted to delete entity of type " << type << " but no entities of that type exist");
+	if (commandBuffer.isEmpty()) {
 		return;
-	}	
+	}
+
+	commandBuffer.collectCommands(deferredCommands);
 
-	//Condition where we are removing the last entity of a certain type - delete VAO and associated information
-	else if (typeInfo.amount == 1) {
+	std::vector<Shmingo::EntityHandle> deletions;
+	std::map<Shmingo::EntityType, std::vector<Shmingo::EntitySpawnParams>> spawns; //Ordered by type so types are always spawned in the same order
 
-		delete entityList[typeInfo.offset + localOffset]; //Delete entity
+	for (Shmingo::EntityCommand& command : deferredCommands) {
+		switch (command.commandType) {
 
-		entityList.erase(entityList.begin() + typeInfo.offset);
-		entityTransformList.erase(entityTransformList.begin() + typeInfo.offset);
-		entityTypeInfoMap.erase(type);
-		instancedVAOMap.erase(type);
-		initializedInstancedVaoMap[type] = false;
+		case Shmingo::DELETE_ENTITY:
+			deletions.emplace_back(command.handle);
+			break;
 
+		case Shmingo::SPAWN_ENTITY:
+			spawns[command.entityType].emplace_back(command.spawnParams);
+			break;
+		}
+	}
+
+	if (!deletions.empty()) {
+		destroyEntities(deletions);
 	}
 
-	//Condition where we are removing an entity that is not the last entity of a certain type
-	else {
+	for (auto& [type, spawnParams] : spawns) {
+		createEntities(type, spawnParams);
+	}
+}
 
-		GLuint selectedEntityIndex = typeInfo.offset + localOffset;
-		GLuint lastEntityIndex = typeInfo.offset + typeInfo.amount - 1;
+void World::refitSpatialIndex() {
+
+	//Slots are stable while rows get swapped around by removals, deleted entities left a bit behind but are no longer in the tree
+	movedEntitySlots.consumeRanges((GLuint)entitySlots.size(), 0, [this](GLuint begin, GLuint end) {
+		for (GLuint slot = begin; slot < end; slot++) {
+
+			Shmingo::EntityHandle handle = getHandleFromSlot(slot);
+			if (spatialIndex.contains(handle)) {
+				spatialIndex.update(handle, computeEntityBounds(entitySlots[slot]));
+			}
+		}
+	});
+}
 
-		if (selectedEntityIndex != lastEntityIndex) {
-			
-			delete entityList[selectedEntityIndex]; //Delete entity
+Shmingo::AABB World::computeEntityBounds(const Shmingo::EntitySlot& slot) {
+
+	EntityArchetype& archetype = *archetypeMap.at(slot.type);
+	const Shmingo::TransformComponent& transform = archetype.getTransform(slot.row);
+
+	vec3 scale = glm::abs(transform.scale);
+	float radius = archetype.getVertexArray()->getCullingRadius() * std::max(std::max(scale.x, scale.y), scale.z);
+
+	return Shmingo::AABB(transform.position - vec3(radius), transform.position + vec3(radius));
+}
+
+void World::deferCreateEntity(Shmingo::EntityType type, vec3 position, vec2 rotation, vec3 scale){
+	waitForSimulation(); //From the main thread the command buffer's first list would be shared with the simulation thread
+	commandBuffer.recordSpawn(type, Shmingo::EntitySpawnParams(position, rotation, scale));
+}
+
+void World::deferDeleteEntity(Shmingo::EntityHandle handle){
+	waitForSimulation();
+	commandBuffer.recordDelete(handle);
+}
 
-			entityList[selectedEntityIndex] = entityList[lastEntityIndex]; //Replace entity with last entity of the same type
-			entityTransformList[selectedEntityIndex] = entityTransformList[lastEntityIndex]; //Replace transform with last transform of the same type
 
-			entityList[selectedEntityIndex]->setOffsetInVao(localOffset);
 
-			//Removal process involves replacing the entity to be removed with the last entity of the same type, and removing the last entity to reduce shifting of entities and maintain consistency with VAO
+//Other functions
+
+Shmingo::InstanceFlushStats World::flushInstanceData(){
+
+	waitForSimulation();
+
+	Shmingo::InstanceFlushStats stats;
+
+	for (auto& [type, archetype] : archetypeMap) {
+		Shmingo::InstanceFlushStats archetypeStats = archetype->getVertexArray()->flushInstanceData();
+		stats.bytes += archetypeStats.bytes;
+		stats.calls += archetypeStats.calls;
+	}
+
+	return stats;
+}
+
+void World::recordVertexArrays(const Shmingo::SimulationInput& input, Shmingo::FramePacket& packet){
+
+	packet.entityCulling = input.entityCulling;
+
+	if (!input.entityCulling) {
+		for (auto& [type, archetype] : archetypeMap) {
+			if (archetype->getEntityCount() > 0) { //Empty archetypes keep their VAO around but have nothing to draw
+				archetype->getVertexArray()->recordFrame(packet, false);
+			}
 		}
-		
-		else {
-			delete entityList[lastEntityIndex]; //Delete entity that was moved to the position of the entity to be removed
+		return;
+	}
+
+	Shmingo::Frustum frustum = Shmingo::extractFrustumPlanes(input.projectionMatrix, input.viewMatrix);
+	vec3 cameraPosition = vec3(glm::inverse(input.viewMatrix)[3]);
+
+	for (auto& [type, archetype] : archetypeMap) {
+
+		if (archetype->getEntityCount() == 0) {
+			continue;
+		}
+
+		std::shared_ptr<EntityVertexArray> vertexArray = archetype->getVertexArray();
+		archetype->cullEntities(frustum, cameraPosition); //Also buckets the visible instances by level of detail
 
+		if (vertexArray->getVisibleInstances().empty()) { //Every entity of the type is off screen
+			continue;
 		}
 
-		entityList.erase(entityList.begin() + lastEntityIndex); //Erase last entity of the same type
-		entityTransformList.erase(entityTransformList.begin() + lastEntityIndex); //Erase last transform of the same type
+		packet.visibleEntityCount += (GLuint)vertexArray->getVisibleInstances().size();
+		vertexArray->recordFrame(packet, true);
+	}
+}
+
+Shmingo::EntityHandle World::createEntity(Shmingo::EntityType type, vec3 position, vec2 rotation, vec3 scale){
+
+	waitForSimulation();
+
+	GLuint slot = allocateEntitySlot(type);
+	entitySlots[slot].row = getArchetype(type).addEntity(slot, position, rotation, scale);
+
+	Shmingo::EntityHandle handle(slot, entitySlots[slot].generation);
+	spatialIndex.insert(handle, computeEntityBounds(entitySlots[slot]));
+
+	entityCount++;
+
+	return handle;
+}
+
+void World::deleteEntity(Shmingo::EntityHandle handle){
+
+	waitForSimulation();
+
+	if (!isHandleCurrent(handle)) {
+		se_log("Attempted to delete entity with stale handle " << handle.index << ":" << handle.generation);
+		return;
+	}
+
+	Shmingo::EntitySlot& slot = entitySlots[handle.index];
+
+	spatialIndex.remove(handle);
+
+	GLuint movedSlot = archetypeMap.at(slot.type)->removeEntity(slot.row); //Last entity of the type is swapped into the removed row
+	if (movedSlot != ENTITY_SLOT_NONE) {
+		entitySlots[movedSlot].row = slot.row;
+	}
+
+	freeEntitySlot(handle.index);
+
+	entityCount--;
+}
+
+std::vector<Shmingo::EntityHandle> World::createEntities(Shmingo::EntityType type, std::span<const Shmingo::EntitySpawnParams> spawnParams){
+
+	waitForSimulation();
+
+	std::vector<Shmingo::EntityHandle> handles;
+	std::vector<GLuint> slots;
+	std::vector<Shmingo::AABB> bounds;
+
+	handles.reserve(spawnParams.size());
+	slots.reserve(spawnParams.size());
+	bounds.reserve(spawnParams.size());
+
+	//One reallocation for a large batch, but still geometric so small per frame batches do not reallocate every call
+	size_t neededSlots = entitySlots.size() + spawnParams.size();
+	if (neededSlots > entitySlots.capacity()) {
+		entitySlots.reserve(std::max(entitySlots.capacity() * 2, neededSlots));
+	}
+
+	for (size_t i = 0; i < spawnParams.size(); i++) {
+		slots.emplace_back(allocateEntitySlot(type));
+	}
 
-		instancedVAOMap.at(type)->removeInstancedData(localOffset); //Remove instance data from VAO and replace with last instance data
+	GLuint firstRow = getArchetype(type).addEntities(slots.data(), spawnParams);
 
-		entityTypeInfoMap.map[type].amount--; //Decrement amount of entities of the given type
+	for (GLuint i = 0; i < slots.size(); i++) {
+		entitySlots[slots[i]].row = firstRow + i;
+		handles.emplace_back(Shmingo::EntityHandle(slots[i], entitySlots[slots[i]].generation));
+		bounds.emplace_back(computeEntityBounds(entitySlots[slots[i]]));
 	}
 
-	//Update information about all succeeding entity types - happens regardless of whether the entity is the last entity of a certain type, except when entity is the last entity in the vector
+	spatialIndex.insertBatch(handles, bounds); //After the rows are written, computeEntityBounds reads them
 
-	if (typeInfo.offset + localOffset != entityList.size()) {
+	entityCount += (GLuint)spawnParams.size();
+
+	return handles;
+}
 
-		for (auto it = entityTypeInfoMap.keys.begin() + entityTypeInfoMap.map[type].vertexArrayOffset + 1; it < entityTypeInfoMap.keys.end(); it++) { //Start updating from the next entity type
-			entityTypeInfoMap.map[*it].offset--; //Increment offset of all succeeding entity types
+void World::destroyEntities(std::span<const Shmingo::EntityHandle> handles){
+
+	waitForSimulation();
+
+	for (const Shmingo::EntityHandle& handle : handles) {
+
+		if (!isHandleCurrent(handle)) {
+			continue;
 		}
 
-		//Update local VAO offset of all succeding entities of the same type
-		auto entityOffset = entityTypeInfoMap.map[type].offset;
-		for (auto it = entityList.begin() + entityTypeInfoMap.map[type].offset + localOffset + 1; it < entityList.begin() + entityOffset + entityTypeInfoMap.map[type].amount; it++) {
-			(*it)->decrementOffsetInVao();
+		Shmingo::EntitySlot& slot = entitySlots[handle.index];
+
+		spatialIndex.remove(handle);
+
+		GLuint movedSlot = archetypeMap.at(slot.type)->removeEntity(slot.row); //Only marks rows dirty, the GPU sees every removal in the next flush
+		if (movedSlot != ENTITY_SLOT_NONE) {
+			entitySlots[movedSlot].row = slot.row;
 		}
+
+		freeEntitySlot(handle.index);
+		entityCount--;
 	}
+}
+
+void World::reserveEntities(Shmingo::EntityType type, GLuint amount){
+	waitForSimulation();
+	getArchetype(type).reserveEntities(amount);
+}
 
-	se_application.setApplicationInfo(Shmingo::ENTITY_COUNT, std::to_string(entityList.size()));
+InstancedEntity* World::getEntity(Shmingo::EntityHandle handle){
 
+	waitForSimulation();
+
+	if (!isHandleCurrent(handle)) {
+		return nullptr;
+	}
+
+	Shmingo::EntitySlot& slot = entitySlots[handle.index];
+	return archetypeMap.at(slot.type)->getEntity(slot.row);
 }
 
+GLuint World::getInstanceOffset(Shmingo::EntityHandle handle){
 
-void World::addEntity(Shmingo::EntityType type, InstancedEntity* entity){
+	waitForSimulation();
 
-	//If entity type does not exist in the entity type map, create a new entity type info and VAO
-	if (initializedInstancedVaoMap.at(type) == false) {
-		//Creates info for new entity type. Sets the offset to the current size of the entity list, amount is 0 because will increment after conditional
-		entityTypeInfoMap.insert(type, Shmingo::EntityTypeInfo((GLuint)initializedInstancedVaoMap.size(), (GLuint)entityList.size(), 0)); //Creates information about the new VAO
+	if (!isHandleCurrent(handle)) {
+		return ENTITY_SLOT_NONE;
+	}
 
-		instancedVAOMap.insert(std::make_pair(type, std::make_shared<EntityVertexArray>(type, se_masterRenderer.getEntityModel(type)))); //Create new VAO for entity type
-		initializedInstancedVaoMap[type] = true; //Set entity type to initialized
+	return entitySlots[handle.index].row;
+}
+
+GLuint World::allocateEntitySlot(Shmingo::EntityType type){
+
+	if (freeEntitySlots.empty()) {
+		entitySlots.emplace_back(Shmingo::EntitySlot(type, 0, 1));
+		movedEntitySlots.resize((GLuint)entitySlots.capacity()); //Follows the vector's geometric growth, so this rarely reallocates
+		return (GLuint)entitySlots.size() - 1;
 	}
 
+	GLuint slot = freeEntitySlots.back();
+	freeEntitySlots.pop_back();
+
+	entitySlots[slot].type = type;
+	return slot;
+}
 
-	std::shared_ptr<EntityVertexArray> entityVAO = instancedVAOMap.at(type); //Get VAO for entity type
-	uint16_t emplaceOffset = entityTypeInfoMap.map[type].offset + entityTypeInfoMap.map[type].amount; //Offset to the back of the section of the given type in the entity list - works because amount has not yet been incremented
+void World::freeEntitySlot(GLuint slot){
 
-	//Emplace entity into entity list at the offset of the entity type
-	entityList.emplace(entityList.begin() + emplaceOffset, entity); //Inserts entity into entity list at the offset of the entity type
-	entityTransformList.emplace(entityTransformList.begin() + emplaceOffset, entity->getTransformComponent()); //Inserts entity transform into entity list at the offset of the entity type
+	entitySlots[slot].generation++; //Invalidates every outstanding handle to this slot
+	if (entitySlots[slot].generation == 0) {
+		entitySlots[slot].generation = 1; //Skip 0 on wrap around, it is reserved for null handles
+	}
 
-	//Submit entity data to the VAO
-	entityVAO->submitInstanceData(entity);
+	freeEntitySlots.emplace_back(slot);
+}
 
-	Shmingo::TransformComponent currentTransform = entityTransformList[entityTypeInfoMap.map[type].offset];
+EntityArchetype& World::getArchetype(Shmingo::EntityType type){
 
+	auto it = archetypeMap.find(type);
 
-	//Update information about all succeeding entity types as long as this entity isnt the last in the vector
-	if (type != entityTypeInfoMap.keys[entityTypeInfoMap.keys.size() - 1]) {
-		for (auto it = entityTypeInfoMap.keys.begin() + entityTypeInfoMap.map[type].vertexArrayOffset + 1; it < entityTypeInfoMap.keys.end(); it++) { //Start updating from the next entity type
-			entityTypeInfoMap.map[*it].offset++; //Increment offset of all succeeding entity types
-		}
+	if (it == archetypeMap.end()) {
+		it = archetypeMap.insert(std::make_pair(type, Shmingo::createEntityArchetype(type))).first;
+		it->second->setMovedSlots(&movedEntitySlots);
 	}
-	entityTypeInfoMap.map[type].amount++; //Increment amount of entities of the given type
-	se_application.setApplicationInfo(Shmingo::ENTITY_COUNT, std::to_string(entityList.size()));
 
+	return *it->second;
 }
 
 
 
 void World::cleanUp(){
 
-	for (InstancedEntity* entity : entityList) {
-		delete entity;
+	simulation.stop(); //Packets let go of their vertex arrays here, before the archetypes do
+	immediatePacket.clear();
+	immediatePacketCurrent = false;
+	chunkBuilder.shutdown();
+	chunkStreamer.clear(); //After the builder, its builds held vertex arrays
+
+	archetypeMap.clear(); //Archetypes destroy their entities and VAOs
+	spatialIndex.clear();
+	entityCount = 0;
+	publishedEntityCount = 0;
+	se_application.setApplicationInfo(Shmingo::ENTITY_COUNT, "0");
+
+	//Invalidate every handle, slots that were already free are bumped too which is harmless
+	freeEntitySlots.clear();
+	for (GLuint i = 0; i < entitySlots.size(); i++) {
+		freeEntitySlot(i);
 	}
 }
\ No newline at end of file
@@ -6,58 +6,128 @@
 
 #include "InstancedEntity.h"
 #include "EntityVertexArray.h"
+#include "EntityArchetype.h"
+#include "EntityCommandBuffer.h"
+#include "DynamicAABBTree.h"
+#include "SimulationThread.h"
+#include "ChunkBuilder.h"
+#include "ChunkStreamer.h"
+
+//Entities per job when updating in parallel
+const GLuint ENTITY_UPDATE_GRAIN = 1024;
 
 /*
 Represents the world owned by the sandbox layer, including all of the expected constituents.
-This class manages terrain, entities, and all game logic in the gameplay stage
+This class manages terrain, entities, and all game logic in the gameplay stage.
+Entities are simulated on a simulation thread which records each frame into a frame packet, the main thread draws the packet during the next frame.
+Public functions called from outside the simulation wait for the frame in flight first, so they are safe from the main thread at any time
 */
 class World {
 
-	friend class InstancedEntity;
-	friend class DefaultEntity;
-
 public:
 	
 	World();
 
-	void submitVertexArrays(); //Submits all vertex arrays to the renderer
-
 	/// <summary>
-	/// Creates an entity based on type Shmingo::EntityType. Forward arguments required for entity constructor 
+	/// Creates an entity based on type Shmingo::EntityType and stores it in the archetype of that type
 	/// </summary>
-	/// <typeparam name="...Args">
-	/// Forwarded arguments
-	/// </typeparam>
 	/// <param name="type">
-	/// Type of Entity, see Shmingo::EntityType enum in InstancedEntity.h
+	/// Type of Entity, see Shmingo::EntityType enum in DataStructures.h
 	/// </param>
 	/// <param name="position"> Position </param>
 	/// <param name="rotation"> Rotation </param>
-	/// <param name="...args">
-	/// Forwarded arguments to specific constructor
-	/// </param>
-	template<typename... Args>
-	void createEntity(Shmingo::EntityType type, vec3 position, vec2 rotation, vec3 scale) {
+	/// <param name="scale"> Scale </param>
+	/// <returns> Handle that stays valid until the entity is deleted </returns>
+	Shmingo::EntityHandle createEntity(Shmingo::EntityType type, vec3 position, vec2 rotation, vec3 scale);
 
-		InstancedEntity* e = nullptr; //return type
+	/// <summary>
+	/// Creates many entities of one type at once. Storage is reserved once and every instance attribute is uploaded in one contiguous write
+	/// </summary>
+	/// <param name="type"> Type of every entity </param>
+	/// <param name="spawnParams"> Transform of each entity </param>
+	/// <returns> Handles in the same order as spawnParams </returns>
+	std::vector<Shmingo::EntityHandle> createEntities(Shmingo::EntityType type, std::span<const Shmingo::EntitySpawnParams> spawnParams);
 
-		switch (type) {
+	void deleteEntity(Shmingo::EntityHandle handle);
 
-		case Shmingo::DefaultEntity:
-			e = new DefaultEntity(position, rotation, scale);
-			break;
+	/// <summary>
+	/// Deletes many entities at once, rows are compacted on the CPU and each affected VAO is synced once at the end. Stale handles are skipped
+	/// </summary>
+	void destroyEntities(std::span<const Shmingo::EntityHandle> handles);
 
-		default:
-			e = nullptr;
-			break;
-		}
+	inline GLuint getEntityCount() { return entityCount; };
 
+	/// <summary>
+	/// Queues an entity spawn, applied at the end of the entity update. Safe to call from entity update functions on any thread
+	/// </summary>
+	void deferCreateEntity(Shmingo::EntityType type, vec3 position, vec2 rotation, vec3 scale);
 
-		addEntity(type, e); //Creates entity and adds to world
+	/// <summary>
+	/// Queues an entity deletion, applied at the end of the entity update. Safe to call from entity update functions on any thread
+	/// </summary>
+	void deferDeleteEntity(Shmingo::EntityHandle handle);
+
+	/// <summary>
+	/// Capacity hint for an entity type, storage and instance buffers for amount entities are allocated now instead of growing while spawning.
+	/// The reserved capacity is kept even when the type is idle
+	/// </summary>
+	/// <param name="type">Entity type</param>
+	/// <param name="amount">Expected peak amount of entities of the type</param>
+	void reserveEntities(Shmingo::EntityType type, GLuint amount);
 
+	//Toggles updating entities over the job system, on by default. Both paths give the same results
+	inline void setParallelUpdate(bool parallel) { parallelUpdate = parallel; };
+
+	/// <summary>
+	/// Toggles simulating on the simulation thread, on by default. Off, every frame is simulated and drawn in the same update on the calling thread,
+	/// without the frame of latency. Takes effect with the next update
+	/// </summary>
+	inline void setThreadedSimulation(bool threaded) { threadedSimulation = threaded; };
+	inline bool isSimulationThreaded() { return threadedSimulation; };
+
+	//Blocks until the frame being simulated is recorded. Does nothing unless called by the thread that updates the world, entity updates never wait
+	void waitForSimulation();
+
+	inline bool isValid(Shmingo::EntityHandle handle) {
+		waitForSimulation(); //Deferred spawns on the simulation thread may be growing entitySlots
+		return isHandleCurrent(handle);
+	}
+
+	inline Shmingo::EntityHandle getHandleFromSlot(GLuint slot) {
+		return Shmingo::EntityHandle(slot, entitySlots[slot].generation);
 	}
 
-	void deleteEntity(Shmingo::EntityType type, GLuint localOffset);
+	/// <summary>
+	/// Returns the entity behind a handle, or nullptr if the handle is stale
+	/// </summary>
+	InstancedEntity* getEntity(Shmingo::EntityHandle handle);
+
+	/// <summary>
+	/// Returns the offset of an entity's instance data in the VAO of its type, or ENTITY_SLOT_NONE if the handle is stale
+	/// </summary>
+	GLuint getInstanceOffset(Shmingo::EntityHandle handle);
+
+	/// <summary>
+	/// Bounds of every live entity keyed by handle, for frustum, proximity and ray queries. Entities that moved are refitted once per frame after the entity update
+	/// </summary>
+	inline const DynamicAABBTree& getSpatialIndex() { return spatialIndex; };
+
+	/// <summary>
+	/// Meshes terrain chunks off the main thread. The world feeds it the camera position and uploads what it finished at the start of every update
+	/// </summary>
+	inline ChunkBuilder& getChunkBuilder() { return chunkBuilder; };
+
+	/// <summary>
+	/// Terrain is streamed in around this position, usually the player's. Takes effect with the next update
+	/// </summary>
+	inline void setTerrainCenter(vec3 position) { terrainCenter = position; };
+
+	inline ChunkStreamer& getChunkStreamer() { return chunkStreamer; };
+
+	/// <summary>
+	/// Uploads the dirty instance data of every entity type right away. The renderer flushes submitted vertex arrays on its own, this is for code that needs the GPU up to date before then
+	/// </summary>
+	Shmingo::InstanceFlushStats flushInstanceData();
 
 	void cleanUp();
 
@@ -67,19 +137,74 @@ public:
 private:
 
 	//-------------------------------Information about the world--------------------------------------------
-	//Contains entity transforms in contiguous memory to reduce cache misses when looping
-	std::vector<Shmingo::TransformComponent> entityTransformList;
+	//One archetype per entity type, each stores transforms, instance data and entity objects in contiguous chunks and owns the type's VAO
+	std::unordered_map<Shmingo::EntityType, std::unique_ptr<EntityArchetype>> archetypeMap;
+
+	GLuint entityCount = 0;
+
+	//Slot map, handles index into entitySlots, which track the current row of every live entity. Freed slots are reused
+	std::vector<Shmingo::EntitySlot> entitySlots;
+	std::vector<GLuint> freeEntitySlots;
+
+	SimulationThread simulation;
+	Shmingo::FramePacket immediatePacket; //Recorded and drawn in the same frame when the simulation is not threaded
+	bool immediatePacketCurrent = false; //immediatePacket was recorded last frame, the threaded path draws it while its first frame is in flight
+	bool threadedSimulation = true;
+	GLuint publishedEntityCount = 0;
+
+	DynamicAABBTree spatialIndex;
+	Shmingo::AtomicBitset movedEntitySlots; //Slots whose entity called markMoved since the last refit
 
-	std::vector<InstancedEntity*> entityList; //Represents entities as a uint index to reduce cache misses. When looping, index this to get desired entity
-	std::unordered_map<Shmingo::EntityType, bool> initializedInstancedVaoMap; //Map to keep track of which Entity types have a VAO in our list
-	Shmingo::OrderedMap<Shmingo::EntityType, Shmingo::EntityTypeInfo> entityTypeInfoMap; //Contains information about a certain entity type in memory - ordered map is a custom data structure which retains insertion order
+	ChunkBuilder chunkBuilder;
+	ChunkStreamer chunkStreamer;
+	vec3 terrainCenter = vec3(0.0f, 0.0f, 0.0f);
 
-	std::unordered_map<Shmingo::EntityType, std::shared_ptr<EntityVertexArray>> instancedVAOMap; //Contains all of the world's instanced VAOs, which typically includes entities.
 
+	//Deferred changes recorded during the entity update, and scratch space for applying them
+	EntityCommandBuffer commandBuffer;
+	std::vector<Shmingo::EntityCommand> deferredCommands;
+
+	bool parallelUpdate = true;
+
+
+	//Simulates and draws a frame on the calling thread through immediatePacket
+	void simulateImmediateFrame(const Shmingo::SimulationInput& input);
+
+	//Every entity type uploads all of its instances again with the next recorded frame, for when a packet is dropped without being replayed
+	void resendEntityInstances();
+
+	//Simulation thread, or the calling thread when not threaded. Updates entities and records what the frame draws
+	void simulateFrame(const Shmingo::SimulationInput& input, Shmingo::FramePacket& packet);
+
+	//Records a draw for every entity type with something to draw, culled against the input's matrices when culling is enabled
+	void recordVertexArrays(const Shmingo::SimulationInput& input, Shmingo::FramePacket& packet);
+
+	//Main thread. Streams chunks around the terrain center, uploads the meshes the builder finished within the frame's byte budget and submits the terrain
+	void updateTerrain();
+
+	//Main thread. Brings the GPU side of every recorded vertex array up to date and submits it to the renderer
+	void replayPacket(const Shmingo::FramePacket& packet);
 
 	void updateEntities(); //Updates all entities in the world
 
-	void addEntity(Shmingo::EntityType type, InstancedEntity* entity); //Is there any reason for this to be a pointer? TODO - check if this can be refactored to avoid dereferencing
+	//Sync point, applies deferred deletions, then spawns in entity order
+	void applyDeferredCommands();
+
+	//Moves the spatial index leaves of every entity marked as moved to its current bounds
+	void refitSpatialIndex();
+
+	//Sphere around the entity's model at its current transform, boxed
+	Shmingo::AABB computeEntityBounds(const Shmingo::EntitySlot& slot);
+
+	EntityArchetype& getArchetype(Shmingo::EntityType type); //Returns the archetype of a type, creating it the first time the type is used
+
+	//isValid without waiting, for callers that already waited or run on the simulation thread
+	inline bool isHandleCurrent(Shmingo::EntityHandle handle) {
+		return handle.index < entitySlots.size() && entitySlots[handle.index].generation == handle.generation;
+	}
+
+	GLuint allocateEntitySlot(Shmingo::EntityType type);
+	void freeEntitySlot(GLuint slot);
 
 
-};
+};
\ No newline at end of file
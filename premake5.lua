@@ -9,6 +9,17 @@ workspace "Shmingo"
 
 outputDirectory = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
+newoption {
+   trigger = "headless",
+   value = "BACKEND",
+   description = "Headless GL backend built in on Linux",
+   allowed = {
+      { "egl", "EGL surfaceless context (default)" },
+      { "osmesa", "OSMesa software context" }
+   },
+   default = "egl"
+}
+
 project "Shmingo"
    location "Shmungus"
    kind "ConsoleApp"
@@ -42,18 +53,26 @@ project "Shmingo"
       "Libraries/lib"
    }
 
-   links {
-      "glfw3",
-      "freetype",
-      "opengl32"
-   }
-
    filter "files:**.c"
       flags { "NoPCH" }
 
    filter "system:windows"
       cppdialect "C++20"
       systemversion "latest"
+      links { "glfw3", "freetype", "opengl32" }
+
+   -- Linux builds are meant for running headless on machines without a display, see --headless in main.cpp
+   filter "system:linux"
+      cppdialect "C++20"
+      links { "glfw", "freetype", "dl", "pthread" }
+
+   filter { "system:linux", "options:headless=egl" }
+      links { "EGL" }
+      defines { "se_HEADLESS_EGL" }
+
+   filter { "system:linux", "options:headless=osmesa" }
+      links { "OSMesa" }
+      defines { "se_HEADLESS_OSMESA" }
 
    filter "configurations:Debug"
       runtime "Debug"